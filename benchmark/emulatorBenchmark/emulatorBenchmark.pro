@@ -0,0 +1,15 @@
+# Regression test and benchmark of the Hantek 2xxx-5xxx driver against the USB emulator.
+# Run it after building the libraries, the exit code is 0 if all frames were correct.
+
+TARGET = emulatorBenchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+QMAKE_CXXFLAGS += -std=c++11
+
+SOURCES += main.cpp
+
+INCLUDEPATH += ../../libusbDSO ../../libOpenHantek2xxx-5xxx
+LIBS += -L../../libOpenHantek2xxx-5xxx -L../../libusbDSO \
+        -lOpenHantek2xxx-5xxx -lusbDSO -lusb-1.0 -lpthread
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  emulatorBenchmark/main.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// Regression test and benchmark of the Hantek 2xxx-5xxx driver: Every supported
+/// model is emulated by a USBEmulator, the driver acquires frames in several trigger
+/// modes and every frame is checked against the emulated signal.
+///
+/// Usage: emulatorBenchmark [seconds per run] [usb latency in us] [usb bytes per second]
+/// The exit code is 0 if all frames were correct.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "hantekDevice.h"
+#include "usbEmulator.h"
+#include "init.h"
+#include "frameBus.h"
+
+using namespace Hantek2xxx_5xxx;
+
+/// The gain of both channels (V/screen height)
+#define BENCHMARK_GAIN 0.16
+/// The pretrigger position (s), inside the shortest record of all models
+#define BENCHMARK_PRETRIGGER 40e-6
+/// The allowed deviation of the measured amplitude (part of the amplitude)
+#define BENCHMARK_AMPLITUDE_TOLERANCE 0.1
+
+/// One acquisition run
+struct Scenario {
+    uint16_t productID;
+    DSO::TriggerMode mode;
+    unsigned channel; ///< The used channel, it is also the trigger source
+    bool fastRate;    ///< Only the channel is used
+};
+
+/// The results of one run, filled by the subscriber
+struct Result {
+    std::mutex mutex;
+    unsigned long long frames = 0;
+    unsigned long long errors = 0;
+    unsigned long long samples = 0;
+    std::string firstError;
+
+    void fail(const std::string& message) {
+        if(!errors++)
+            firstError = message;
+    }
+};
+
+/// \brief Check one frame against the emulated sine wave.
+static void checkFrame(const DSO::dsoFrame& frame, const Scenario& scenario, const USBEmulator::Signal& signal,
+                       Result& result) {
+    std::lock_guard<std::mutex> lock(result.mutex);
+    ++result.frames;
+
+    if(scenario.channel >= frame.samples.size()) {
+        result.fail("channel missing");
+        return;
+    }
+    const DSO::SampleBuffer& samples = frame.samples[scenario.channel];
+    result.samples += samples.size();
+    if(samples.size() != frame.settings.recordLength) {
+        result.fail("record length " + std::to_string(samples.size()) + " instead of " +
+                    std::to_string(frame.settings.recordLength));
+        return;
+    }
+
+    const auto range = std::minmax_element(samples.begin(), samples.end());
+    const double amplitude = signal.amplitude * BENCHMARK_GAIN;
+    if(std::fabs(*range.second - amplitude) > amplitude * BENCHMARK_AMPLITUDE_TOLERANCE ||
+       std::fabs(*range.first + amplitude) > amplitude * BENCHMARK_AMPLITUDE_TOLERANCE) {
+        result.fail("amplitude " + std::to_string(*range.first) + " - " + std::to_string(*range.second));
+        return;
+    }
+
+    if(scenario.mode != DSO::TriggerMode::NORMAL)
+        return;
+
+    // The signal crosses the trigger level (0 V) on the rising slope at the pretrigger position
+    const unsigned samplesPerPeriod = (unsigned) (frame.settings.samplerate / signal.frequency);
+    const unsigned triggerIndex = (unsigned) lround(frame.settings.pretrigger_pos_in_s * frame.settings.samplerate);
+    const unsigned distance = std::max(samplesPerPeriod / 8, 1u);
+    if(triggerIndex < distance || triggerIndex + distance >= samples.size() ||
+       samples[triggerIndex - distance] >= 0.0 || samples[triggerIndex + distance] <= 0.0)
+        result.fail("no rising edge at the trigger position " + std::to_string(triggerIndex));
+}
+
+/// \return The upper bound in us of the latency histogram bucket that contains the given part of the transfers.
+static unsigned long long latencyPercentile(const DSO::TransferStatistics& statistics, double part) {
+    unsigned long long total = 0;
+    for(unsigned long long count: statistics.latency)
+        total += count;
+    unsigned long long count = 0;
+    for(unsigned bucket = 0; bucket < USB_COMM_LATENCY_BUCKETS; ++bucket) {
+        count += statistics.latency[bucket];
+        if(count && count >= part * total)
+            return 2ull << bucket;
+    }
+    return 0;
+}
+
+/// \brief Print the transfer statistics of every endpoint the driver used.
+static void printTransferStatistics(DSO::USBCommunication& device) {
+    for(const auto& endpoint: device.transferPolicy().getStatistics()) {
+        const DSO::TransferStatistics& statistics = endpoint.second;
+        std::cout << "    endpoint 0x" << std::hex << (int) endpoint.first << std::dec << ": "
+                  << statistics.transfers << " transfers, " << statistics.bytes << " bytes, "
+                  << statistics.timeouts << " timeouts, " << statistics.errors << " errors, latency median < "
+                  << latencyPercentile(statistics, 0.5) << " us, 99 % < " << latencyPercentile(statistics, 0.99)
+                  << " us" << std::endl;
+    }
+}
+
+/// \return True if the run passed.
+static bool run(const Scenario& scenario, double duration_in_s, std::chrono::microseconds latency, double bytesPerSecond) {
+    USBEmulator* emulator;
+    std::unique_ptr<DSO::DeviceBase> device(makeEmulatedHantekDevice(scenario.productID, 0, &emulator));
+    if(!device) {
+        std::cerr << "Model " << std::hex << scenario.productID << std::dec << " is not supported" << std::endl;
+        return false;
+    }
+    emulator->setTransferTiming(latency, bytesPerSecond);
+
+    USBEmulator::Signal signal;
+    signal.frequency = 20e3;
+    emulator->setSignal(scenario.channel, signal);
+
+    Result result;
+    DSO::FrameBus::SubscriptionHandle subscription = device->_frameBus.subscribe(
+                [&](const DSO::SharedFrame& frame) { checkFrame(*frame, scenario, signal, result); },
+                4, DSO::Backpressure::DROP_NEWEST);
+
+    device->connectDevice();
+    if(!device->isDeviceConnected()) {
+        std::cerr << "Connecting the emulated device failed" << std::endl;
+        return false;
+    }
+    for(unsigned channel = 0; channel < device->getChannelCount(); ++channel) {
+        device->setGain(channel, BENCHMARK_GAIN);
+        device->setOffset(channel, 0.5);
+        device->setChannelUsed(channel, scenario.fastRate ? channel == scenario.channel : true);
+    }
+    device->setTriggerSource(false, scenario.channel);
+    device->setTriggerLevel(scenario.channel, 0.0);
+    device->setTriggerMode(scenario.mode);
+    device->setPreTriggerPosition(BENCHMARK_PRETRIGGER);
+
+    const auto start = std::chrono::steady_clock::now();
+    device->startSampling();
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration_in_s));
+    device->stopSampling();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    device->disconnectDevice();
+
+    const DSO::FrameBus::Statistics bus = device->_frameBus.statistics(subscription);
+    device->_frameBus.unsubscribe(subscription);
+    const USBEmulator::Statistics usb = emulator->getStatistics();
+
+    std::lock_guard<std::mutex> lock(result.mutex);
+    const bool passed = result.frames && !result.errors && !usb.protocolErrors;
+    std::cout << (passed ? "PASS " : "FAIL ") << std::hex << scenario.productID << std::dec
+              << " mode " << (int) scenario.mode << " channel " << scenario.channel << (scenario.fastRate ? " fast" : "")
+              << ": " << result.frames / elapsed << " frames/s, " << result.samples / elapsed / 1e6 << " MS/s, "
+              << (double) (usb.controlTransfers + usb.bulkCommands + usb.bulkReads) / std::max(result.frames, 1ull)
+              << " transfers/frame, " << bus.dropped << " dropped, " << usb.protocolErrors << " protocol errors";
+    if(result.errors)
+        std::cout << ", " << result.errors << " bad frames (" << result.firstError << ")";
+    std::cout << std::endl;
+    printTransferStatistics(*emulator);
+    return passed;
+}
+
+int main(int argc, char *argv[]) {
+    const double duration_in_s = argc > 1 ? std::atof(argv[1]) : 1.0;
+    const std::chrono::microseconds latency(argc > 2 ? std::atoi(argv[2]) : 0);
+    const double bytesPerSecond = argc > 3 ? std::atof(argv[3]) : 0.0;
+
+    bool passed = true;
+    for(uint16_t productID: {0x2090, 0x2150, 0x2250, 0x5200, 0x520A}) {
+        passed &= run({productID, DSO::TriggerMode::AUTO, 0, false}, duration_in_s, latency, bytesPerSecond);
+        passed &= run({productID, DSO::TriggerMode::NORMAL, 0, false}, duration_in_s, latency, bytesPerSecond);
+        passed &= run({productID, DSO::TriggerMode::NORMAL, 1, true}, duration_in_s, latency, bytesPerSecond);
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  simulationBenchmark/main.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// Load test of the stages after the usb transfer: A SimulationDevice generates
+/// frames for a fast subscriber, that reads every sample, and a slow one, that
+/// stands for a renderer. Without a frame rate the device generates frames as fast
+/// as the fast subscriber accepts them and the slow one is left out, it would set
+/// the rate. The frame rate, throughput and the frames of each subscriber are printed.
+///
+/// Usage: simulationBenchmark [seconds] [frames per second, 0 for unlimited] [record type]
+/// The exit code is 0 if frames were delivered.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "simulationDevice.h"
+#include "frameBus.h"
+
+using namespace DemoDevices;
+
+/// The time the slow subscriber needs for a frame (ms)
+#define BENCHMARK_RENDER_MS 20
+
+static void printSubscriber(const char* name, const DSO::FrameBus::Statistics& statistics) {
+    std::cout << name << ": " << statistics.delivered << " delivered, " << statistics.dropped << " dropped" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    const double duration_in_s = argc > 1 ? std::atof(argv[1]) : 2.0;
+    const double framesPerSecond = argc > 2 ? std::atof(argv[2]) : 0.0;
+    const unsigned recordType = argc > 3 ? std::atoi(argv[3]) : 1;
+
+    SimulationDevice device(1);
+
+    // Keeps the result, so that the reading of the samples is not optimized out
+    std::atomic<double> peak{0.0};
+    DSO::FrameBus::SubscriptionHandle analyser = device._frameBus.subscribe([&peak](const DSO::SharedFrame& frame) {
+        double maximum = 0.0;
+        for(const DSO::SampleBuffer& samples: frame->samples)
+            for(double sample: samples)
+                maximum = std::max(maximum, sample);
+        peak = maximum;
+    }, 4, DSO::Backpressure::DROP_OLDEST);
+    DSO::FrameBus::SubscriptionHandle renderer;
+    if(framesPerSecond > 0.0)
+        renderer = device._frameBus.subscribe([](const DSO::SharedFrame&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(BENCHMARK_RENDER_MS));
+        }, 1, DSO::Backpressure::DROP_NEWEST, DSO::ThreadRole::RENDER);
+
+    device.connectDevice();
+    device.setChannelUsed(0, true);
+    device.setChannelUsed(1, true);
+    device.setRecordLengthByID(recordType);
+    device.setFrameRate(framesPerSecond);
+
+    device.startSampling();
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration_in_s));
+    device.stopSampling();
+    device.disconnectDevice();
+    const SimulationDevice::Statistics statistics = device.getStatistics();
+
+    const DSO::FrameBus::Statistics analyserStatistics = device._frameBus.statistics(analyser);
+    const DSO::FrameBus::Statistics rendererStatistics = device._frameBus.statistics(renderer);
+    device._frameBus.unsubscribe(analyser);
+    device._frameBus.unsubscribe(renderer);
+
+    std::cout << "Device: " << statistics.frames << " frames, " << statistics.frames / statistics.elapsed_in_s
+              << " frames/s, " << statistics.samples / statistics.elapsed_in_s / 1e6 << " MS/s" << std::endl;
+    printSubscriber("Analyser", analyserStatistics);
+    if(renderer)
+        printSubscriber("Renderer", rendererStatistics);
+    std::cout << "Peak: " << peak << std::endl;
+    return analyserStatistics.delivered ? EXIT_SUCCESS : EXIT_FAILURE;
+}
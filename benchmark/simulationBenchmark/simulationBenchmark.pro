@@ -0,0 +1,14 @@
+# Load test of the frame processing and distribution with a simulated device.
+
+TARGET = simulationBenchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+QMAKE_CXXFLAGS += -std=c++11
+
+SOURCES += main.cpp
+
+INCLUDEPATH += ../../libusbDSO ../../libDemoDevice
+LIBS += -L../../libDemoDevice -L../../libusbDSO \
+        -lDemoDevice -lusbDSO -lusb-1.0 -lpthread
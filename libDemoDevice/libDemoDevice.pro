@@ -21,9 +21,11 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-SOURCES += sineWaveDevice.cpp
+SOURCES += sineWaveDevice.cpp \
+           simulationDevice.cpp \
+           waveformGenerator.cpp
 
-HEADERS += deviceDemo.h sineWaveDevice.h
+HEADERS += deviceDemo.h sineWaveDevice.h simulationDevice.h waveformGenerator.h
 unix {
     target.path = /usr/lib
     INSTALLS += target
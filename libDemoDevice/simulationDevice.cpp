@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  simulationDevice.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include "simulationDevice.h"
+
+namespace DemoDevices {
+
+SimulationDevice::SimulationDevice(uint32_t seed)
+    : DeviceDummy(DSO::DSODeviceDescription()), _seed(seed) {
+}
+
+SimulationDevice::~SimulationDevice() {
+    disconnectDevice();
+}
+
+unsigned SimulationDevice::getUniqueID() const {
+    return 0;
+}
+
+bool SimulationDevice::needFirmware() const {
+    return false;
+}
+
+ErrorCode SimulationDevice::uploadFirmware() {
+    return ErrorCode::ERROR_NONE;
+}
+
+void SimulationDevice::disconnectDevice() {
+    if (!isDeviceTaskRunning()) return;
+    stopDeviceTask();
+    _statusMessage((int)ErrorCode::ERROR_NONE);
+}
+
+bool SimulationDevice::isDeviceConnected() const {
+    return isDeviceTaskRunning();
+}
+
+void SimulationDevice::connectDevice() {
+    _specification.channels         = 2;
+    _specification.channels_special = 0;
+
+    resetSettings();
+
+    // Record lengths up to multiple MB per channel, to stress the later stages
+    _specification.samplerate_single.base = 500e6;
+    _specification.samplerate_single.max = 500e6;
+    _specification.samplerate_single.maxDownsampler = 131072;
+    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(10240, 1));
+    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(131072, 1));
+    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(1048576, 1));
+    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(4194304, 1));
+    _specification.samplerate_multi.base = 1e9;
+    _specification.samplerate_multi.max = 1e9;
+    _specification.samplerate_multi.maxDownsampler = 131072;
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(20480, 1));
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(262144, 1));
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(2097152, 1));
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(8388608, 1));
+    _specification.sampleSize = 8;
+
+    for (double gainSteps: {0.08, 0.16, 0.40, 0.80, 1.60, 4.00, 8.0, 16.0, 40.0})
+        _specification.gainLevel.push_back(DSO::dsoGainLevel(_specification.gainLevel.size(), gainSteps, 255));
+    for (DSO::dsoGainLevel& gainLevel: _specification.gainLevel)
+        for (unsigned c=0; c < _specification.channels; ++c)
+            gainLevel.offset[c] = {0,255};
+
+    _generators.clear();
+    for (unsigned c=0; c < _specification.channels; ++c)
+        _generators.push_back(WaveformGenerator(_seed + c));
+
+    setSamplerate(getMaxSamplerate());
+
+    // _signals for initial _settings
+    notifySamplerateLimitsChanged();
+    _recordLengthChanged(_settings.recordTypeID);
+    _recordTimeChanged((double) getCurrentRecordType().length_per_channel / _settings.samplerate.current);
+    _samplerateChanged(_settings.samplerate.current);
+
+    _sampling = false;
+    _frames = 0;
+    _samples = 0;
+    _nextFrame = std::chrono::steady_clock::now();
+    _connected = _nextFrame.time_since_epoch().count();
+    // The control loop is running until the device is disconnected
+    startDeviceTask(std::bind(&SimulationDevice::step, this));
+
+    setOffset(0, 0.5);
+    setOffset(1, 0.5);
+
+    _deviceConnected();
+}
+
+ErrorCode SimulationDevice::setWaveform(unsigned channel, const WaveformSettings& settings) {
+    if (channel >= _specification.channels)
+        return ErrorCode::ERROR_PARAMETER;
+    dispatchSettings([this, channel, settings]() {
+        _generators[channel].setSettings(settings);
+    });
+    return ErrorCode::ERROR_NONE;
+}
+
+void SimulationDevice::setFrameRate(double framesPerSecond) {
+    dispatchSettings([this, framesPerSecond]() {
+        _frameRate = std::max(framesPerSecond, 0.0);
+        _nextFrame = std::chrono::steady_clock::now();
+    });
+}
+
+SimulationDevice::Statistics SimulationDevice::getStatistics() const {
+    Statistics statistics;
+    statistics.frames = _frames;
+    statistics.samples = _samples;
+    const std::chrono::steady_clock::time_point connected{std::chrono::steady_clock::duration(_connected)};
+    statistics.elapsed_in_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - connected).count();
+    return statistics;
+}
+
+std::chrono::steady_clock::time_point SimulationDevice::step() {
+    if (!_sampling)
+        return DSO::Executor::idle;
+
+    // As fast as the subscribers accept, wait instead of generating frames that would be dropped
+    if (_frameRate <= 0.0 && _frameBus.congested())
+        return std::chrono::steady_clock::now() + std::chrono::microseconds(SIMULATION_CONGESTION_RETRY_US);
+
+    const double samplerate = _settings.samplerate.current;
+    _data.resize(getExpectedRecordLength());
+
+    if (isFastRate()) {
+        // One channel uses all buffers
+        for (unsigned c=0; c < _specification.channels; ++c) {
+            if (!_settings.voltage[c].used)
+                continue;
+            _generators[c].generate(_data.data(), _data.size(), 1, samplerate);
+            break;
+        }
+    } else {
+        // Interleaved, the last channel comes first
+        const unsigned channels = _specification.channels;
+        for (unsigned c=0; c < channels; ++c)
+            _generators[c].generate(_data.data() + channels - 1 - c, _data.size() / channels, channels, samplerate);
+    }
+
+    // Frames of the calibration are not published and not counted
+    if (processSamples(_data)) {
+        _frameBus.publish(_frame);
+        ++_frames;
+        _samples += _data.size();
+    }
+
+    // As fast as the subscribers accept, the next step is due at once
+    if (_frameRate <= 0.0)
+        return std::chrono::steady_clock::time_point();
+
+    // Keep the average rate, but don't try to catch up after a stall
+    const auto now = std::chrono::steady_clock::now();
+    _nextFrame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / _frameRate));
+    if (_nextFrame < now)
+        _nextFrame = now;
+    return _nextFrame;
+}
+
+}
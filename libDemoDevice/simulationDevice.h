@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  simulationDevice.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "deviceBase.h"
+#include "devicedummy.h"
+#include "errorcodes.h"
+#include "waveformGenerator.h"
+
+/// The time until a congested frame bus is checked again, if frames are generated as fast as possible
+#define SIMULATION_CONGESTION_RETRY_US 100
+
+namespace DemoDevices {
+
+//////////////////////////////////////////////////////////////////////////////////
+///
+/// \brief A device for load tests, it generates frames of configurable signals
+/// at a fixed frame rate or as fast as the subscribers of _frameBus accept them.
+///
+/// The samples go through processSamples() like the samples of real devices, so
+/// every stage after the usb transfer is measured. With the same seed and settings
+/// the same frames are generated.
+class SimulationDevice : public DeviceDummy {
+    public:
+        /// \param seed The seed of the noise and glitches, channel n uses seed + n.
+        explicit SimulationDevice(uint32_t seed = 0);
+        ~SimulationDevice();
+
+        virtual unsigned getUniqueID() const override;
+
+        virtual bool needFirmware() const override;
+        virtual ErrorCode uploadFirmware() override;
+
+        virtual bool isDeviceConnected() const override;
+        virtual void connectDevice() override;
+        virtual void disconnectDevice() override;
+
+        /// \brief Change the signal of a channel, the phase continues.
+        ErrorCode setWaveform(unsigned channel, const WaveformSettings& settings);
+
+        /// \brief Set the number of frames per second.
+        /// \param framesPerSecond The frame rate, 0 to publish the next frame as soon as
+        ///        no subscriber queue is full.
+        void setFrameRate(double framesPerSecond);
+
+        //////////////////////////////////////////////////////////////////////////
+        /// \struct Statistics
+        /// \brief Counters of the generated data since the device was connected.
+        struct Statistics {
+            unsigned long long frames = 0;  ///< Frames published to _frameBus
+            unsigned long long samples = 0; ///< Samples of all channels of the published frames
+            double elapsed_in_s = 0.0;      ///< The time since the device was connected
+        };
+        Statistics getStatistics() const;
+
+    private:
+        const uint32_t _seed;
+        std::vector<WaveformGenerator> _generators; ///< One per channel, owned by the device task
+        std::vector<unsigned char> _data;           ///< The raw samples of one frame
+        double _frameRate = 50.0;                   ///< Owned by the device task
+        std::chrono::steady_clock::time_point _nextFrame;
+        std::atomic<std::chrono::steady_clock::rep> _connected{0}; ///< The time of the connection since the clock epoch
+        std::atomic<unsigned long long> _frames{0};
+        std::atomic<unsigned long long> _samples{0};
+
+        /// \brief Generates the samples of one frame.
+        /// \return The time of the next frame.
+        std::chrono::steady_clock::time_point step();
+};
+
+}
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <memory>
 #include <cstring>
+#include <random>
 
 #include "utils/containerStream.h"
 
@@ -41,7 +42,7 @@
 namespace DemoDevices {
 
 SineWaveDevice::SineWaveDevice()
-    : DeviceDummy(DSO::DSODeviceDescription()) {
+    : DeviceDummy(DSO::DSODeviceDescription()), _generator(std::random_device()()), _random(0.9, 1.0) {
 }
 
 SineWaveDevice::~SineWaveDevice() {
@@ -61,14 +62,13 @@ ErrorCode SineWaveDevice::uploadFirmware() {
 }
 
 void SineWaveDevice::disconnectDevice() {
-    if (!_thread.get()) return;
-    _keep_thread_running = false;
-    if (_thread->joinable()) _thread->join();
-    _thread.reset();
+    if (!isDeviceTaskRunning()) return;
+    stopDeviceTask();
+    _statusMessage((int)ErrorCode::ERROR_NONE);
 }
 
 bool SineWaveDevice::isDeviceConnected() const {
-    return _thread.get();
+    return isDeviceTaskRunning();
 }
 
 void SineWaveDevice::connectDevice(){
@@ -88,9 +88,9 @@ void SineWaveDevice::connectDevice(){
     _specification.samplerate_multi.base = 100e6;
     _specification.samplerate_multi.max = 100e6;
     _specification.samplerate_multi.maxDownsampler = 131072;
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(20480, 1));
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(65536, 1));
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(20480, 1));
+    _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(65536, 1));
     _specification.sampleSize = 8;
 
     _specification.gainLevel.push_back(DSO::dsoGainLevel(1,  1, 255));
@@ -110,8 +110,8 @@ void SineWaveDevice::connectDevice(){
 
     _sampling = false;
     // The control loop is running until the device is disconnected
-    _keep_thread_running = true;
-    _thread = std::unique_ptr<std::thread>(new std::thread(&SineWaveDevice::run,std::ref(*this)));
+    _x = 0;
+    startDeviceTask(std::bind(&SineWaveDevice::step, this));
 
     setOffset(0, 0.5);
     setOffset(1, 0.5);
@@ -119,42 +119,28 @@ void SineWaveDevice::connectDevice(){
     _deviceConnected();
 }
 
-#include <random>
-void SineWaveDevice::run() {
-    double x;
-
-    std::vector<unsigned char> data;
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.9,1.0);
-
-    while (_keep_thread_running) {
-        unsigned samples = getExpectedRecordLength();
-
-        if (isFastRate()) {
-            data.resize(samples);
-            for (unsigned i=0;i<data.size();++i) {
-                data[i] = sin(x)*dis(gen)*255;
-                x += 0.01;
-            }
-        } else {
-            data.resize(samples);
-            for (unsigned i=0;i<data.size();i+=2) {
-                data[i] = (sin(x)+1.0)*dis(gen)*(255/2);
-                data[i+1] = int(x*10) % 255; // sin(x+shift_factor)*dis(gen)*128;
-                x += 0.01;
-            }
-        }
-
-        processSamples(data);
+std::chrono::steady_clock::time_point SineWaveDevice::step() {
+    unsigned samples = getExpectedRecordLength();
 
-        _samplesAvailable(_samples);
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (isFastRate()) {
+        _data.resize(samples);
+        for (unsigned i=0;i<_data.size();++i) {
+            _data[i] = sin(_x)*_random(_generator)*255;
+            _x += 0.01;
+        }
+    } else {
+        _data.resize(samples);
+        for (unsigned i=0;i<_data.size();i+=2) {
+            _data[i] = (sin(_x)+1.0)*_random(_generator)*(255/2);
+            _data[i+1] = int(_x*10) % 255; // sin(x+shift_factor)*dis(gen)*128;
+            _x += 0.01;
+        }
     }
 
-    _statusMessage((int)ErrorCode::ERROR_NONE);
+    if(processSamples(_data))
+        _frameBus.publish(_frame);
+
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
 }
 
 }
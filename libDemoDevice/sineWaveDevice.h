@@ -29,6 +29,8 @@
 #include <functional>
 #include <chrono>
 #include <future>
+#include <random>
+#include <vector>
 
 #include "deviceBase.h"
 #include "devicedummy.h"
@@ -53,11 +55,14 @@ class SineWaveDevice : public DeviceDummy, DeviceDemo  {
         virtual void connectDevice() override;
         virtual void disconnectDevice() override;
     private:
-        std::unique_ptr<std::thread> _thread;
-        volatile bool _keep_thread_running;
+        double _x = 0;                       ///< The phase of the sine wave
+        std::vector<unsigned char> _data;    ///< The raw samples of one frame
+        std::mt19937 _generator;
+        std::uniform_real_distribution<> _random;
 
-        /// \brief Generates the sine wave samples
-        void run();
+        /// \brief Generates the sine wave samples of one frame
+        /// \return The time of the next frame.
+        std::chrono::steady_clock::time_point step();
 };
 
 }
@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  waveformGenerator.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include "waveformGenerator.h"
+
+namespace DemoDevices {
+
+/// \return A uniformly distributed value in (0, 1), the same on every platform.
+static double uniform(std::mt19937& generator) {
+    return (generator() + 0.5) / 4294967296.0;
+}
+
+WaveformGenerator::WaveformGenerator(uint32_t seed)
+    : _seed(seed), _sine(1u << WAVEFORM_TABLE_BITS), _noise(1u << WAVEFORM_NOISE_BITS) {
+    for(unsigned index = 0; index < _sine.size(); ++index)
+        _sine[index] = (float) std::sin(2 * M_PI * index / _sine.size());
+    reset();
+}
+
+void WaveformGenerator::setSettings(const WaveformSettings& settings) {
+    _settings = settings;
+    _glitchSamplerate = 0.0; // Reschedule the glitches with the new rate
+}
+
+void WaveformGenerator::reset() {
+    // Box-Muller instead of std::normal_distribution, whose values depend on the standard library
+    std::mt19937 generator(_seed);
+    for(unsigned index = 0; index < _noise.size(); index += 2) {
+        const double radius = std::sqrt(-2.0 * std::log(uniform(generator)));
+        const double angle = 2 * M_PI * uniform(generator);
+        _noise[index] = (float) (radius * std::cos(angle));
+        _noise[index + 1] = (float) (radius * std::sin(angle));
+    }
+
+    _phase = _modulationPhase = 0;
+    _noiseIndex = _seed;
+    _glitchGenerator.seed(_seed ^ 0x9e3779b9u);
+    _glitchCountdown = 0;
+    _glitchSamplerate = 0.0;
+    _glitches = 0;
+}
+
+uint32_t WaveformGenerator::increment(double frequency, double samplerate) {
+    double cycles = std::fabs(frequency) / samplerate;
+    cycles -= std::floor(cycles);
+    return (uint32_t) (cycles * 4294967296.0);
+}
+
+void WaveformGenerator::nextGlitch(double samplerate) {
+    if(_settings.glitchRate <= 0.0 || samplerate <= 0.0) {
+        _glitchCountdown = 0;
+        return;
+    }
+    const double gap = -std::log(uniform(_glitchGenerator)) * samplerate / _settings.glitchRate;
+    _glitchCountdown = 1 + (unsigned long long) std::min(gap, 1e18);
+}
+
+/// \brief Write the samples of a signal, scaled to ADC codes, with noise.
+/// \param signal Returns the next value (-1.0 - 1.0) of the signal.
+template<class Signal>
+static void fill(unsigned char* output, unsigned samples, unsigned stride, float center, float scale,
+                 float noise, const float* noiseTable, uint32_t& noiseIndex, Signal signal) {
+    uint32_t index = noiseIndex;
+    for(unsigned sample = 0; sample < samples; ++sample, output += stride) {
+        index = index * 1664525u + 1013904223u;
+        const float value = center + scale * signal() + noise * noiseTable[index >> (32 - WAVEFORM_NOISE_BITS)];
+        *output = (unsigned char) std::min(std::max(value, 0.0f), 255.0f);
+    }
+    noiseIndex = index;
+}
+
+void WaveformGenerator::generate(unsigned char* output, unsigned samples, unsigned stride, double samplerate) {
+    if(!samples || samplerate <= 0.0)
+        return;
+    if(samplerate != _glitchSamplerate) {
+        _glitchSamplerate = samplerate;
+        nextGlitch(samplerate);
+    }
+
+    // Codes are rounded by the truncation in fill()
+    const float center = (float) (255.0 * _settings.offset + 0.5);
+    const float scale = (float) (255.0 * _settings.amplitude);
+    const float noise = (float) (255.0 * (_settings.noise + (_settings.waveform == Waveform::NOISE ? _settings.amplitude : 0.0)));
+
+    const unsigned shift = 32 - WAVEFORM_TABLE_BITS;
+    const float* sine = _sine.data();
+    const uint32_t step = increment(_settings.frequency, samplerate);
+    const uint32_t modulationStep = increment(_settings.modulationFrequency, samplerate);
+    uint32_t phase = _phase;
+    uint32_t modulationPhase = _modulationPhase;
+
+    switch(_settings.waveform) {
+    case Waveform::SINE:
+        fill(output, samples, stride, center, scale, noise, _noise.data(), _noiseIndex, [&]() {
+            const float value = sine[phase >> shift];
+            phase += step;
+            return value;
+        });
+        break;
+    case Waveform::SQUARE:
+    case Waveform::PULSE: {
+        const double dutyCycle = _settings.waveform == Waveform::SQUARE ? 0.5 : std::min(std::max(_settings.dutyCycle, 0.0), 1.0);
+        const uint32_t threshold = (uint32_t) (dutyCycle * 4294967295.0);
+        fill(output, samples, stride, center, scale, noise, _noise.data(), _noiseIndex, [&]() {
+            const float value = phase < threshold ? 1.0f : -1.0f;
+            phase += step;
+            return value;
+        });
+        break;
+    }
+    case Waveform::CHIRP: {
+        // The frequency rises linearly with the sweep phase
+        const uint64_t span = increment(std::min(std::fabs(_settings.deviation), samplerate / 2), samplerate);
+        fill(output, samples, stride, center, scale, noise, _noise.data(), _noiseIndex, [&]() {
+            const float value = sine[phase >> shift];
+            phase += step + (uint32_t) ((span * modulationPhase) >> 32);
+            modulationPhase += modulationStep;
+            return value;
+        });
+        break;
+    }
+    case Waveform::AM: {
+        const float depth = (float) std::min(std::max(_settings.modulationDepth, 0.0), 1.0);
+        const float normalize = 1.0f / (1.0f + depth);
+        fill(output, samples, stride, center, scale, noise, _noise.data(), _noiseIndex, [&]() {
+            const float value = sine[phase >> shift] * (1.0f + depth * sine[modulationPhase >> shift]) * normalize;
+            phase += step;
+            modulationPhase += modulationStep;
+            return value;
+        });
+        break;
+    }
+    case Waveform::FM: {
+        // Less than half a period per sample, so the increment fits into an int32_t
+        const float deviation = (float) (std::min(std::fabs(_settings.deviation), samplerate * 0.45) / samplerate * 4294967296.0);
+        fill(output, samples, stride, center, scale, noise, _noise.data(), _noiseIndex, [&]() {
+            const float value = sine[phase >> shift];
+            phase += step + (uint32_t) (int32_t) (deviation * sine[modulationPhase >> shift]);
+            modulationPhase += modulationStep;
+            return value;
+        });
+        break;
+    }
+    case Waveform::NOISE:
+        fill(output, samples, stride, center, scale, noise, _noise.data(), _noiseIndex, []() { return 0.0f; });
+        break;
+    }
+    _phase = phase;
+    _modulationPhase = modulationPhase;
+
+    // Glitches replace single samples, they are rare enough to be placed afterwards
+    unsigned remaining = samples;
+    while(_glitchCountdown && _glitchCountdown <= remaining) {
+        unsigned char* sample = output + (samples - remaining + _glitchCountdown - 1) * stride;
+        const double sign = (_glitchGenerator() & 1) ? 1.0 : -1.0;
+        *sample = (unsigned char) std::min(std::max(255.0 * (_settings.offset + sign * _settings.glitchAmplitude) + 0.5, 0.0), 255.0);
+        remaining -= _glitchCountdown;
+        ++_glitches;
+        nextGlitch(samplerate);
+    }
+    if(_glitchCountdown)
+        _glitchCountdown -= remaining;
+}
+
+}
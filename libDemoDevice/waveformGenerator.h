@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  waveformGenerator.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+namespace DemoDevices {
+
+#define WAVEFORM_TABLE_BITS 12 ///< The sine table has 2^bits entries
+#define WAVEFORM_NOISE_BITS 16 ///< The noise table has 2^bits gaussian values
+
+//////////////////////////////////////////////////////////////////////////////
+/// \enum Waveform
+/// \brief The signals a WaveformGenerator can produce.
+enum class Waveform {
+    SINE,   ///< Sine wave
+    SQUARE, ///< Square wave with 50% duty cycle
+    PULSE,  ///< Pulse train with the given duty cycle
+    CHIRP,  ///< Linear frequency sweep, restarted modulationFrequency times per second
+    AM,     ///< Amplitude modulated sine
+    FM,     ///< Frequency modulated sine
+    NOISE   ///< Gaussian noise only
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// \struct WaveformSettings
+/// \brief The signal of one channel. Levels are relative to the ADC range.
+struct WaveformSettings {
+    Waveform waveform = Waveform::SINE;
+    double frequency = 1e3;          ///< The (carrier or start) frequency in Hz
+    double amplitude = 0.4;          ///< The peak amplitude, 0.5 is the full range
+    double offset = 0.5;             ///< The center level, 0.5 is the middle of the range
+    double dutyCycle = 0.1;          ///< The high time of a pulse relative to the period
+    double modulationFrequency = 50; ///< The frequency of the AM/FM modulation or chirp sweeps in Hz
+    double modulationDepth = 0.5;    ///< The AM depth (0.0 - 1.0)
+    double deviation = 500;          ///< The FM deviation and the chirp span in Hz
+    double noise = 0.0;              ///< The standard deviation of the noise added to every waveform
+    double glitchRate = 0.0;         ///< The mean number of single sample glitches per second
+    double glitchAmplitude = 0.4;    ///< The height of the glitches
+};
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief Generates 8 bit ADC codes of a periodic signal, fast enough to saturate
+/// the processing pipeline.
+///
+/// The phase is a 32 bit accumulator that indexes a precomputed sine table, noise
+/// is read from a precomputed table of gaussian values with a pseudo random index.
+/// Glitches appear after exponentially distributed gaps. Everything is derived
+/// from the seed, so a seed always gives the same samples.
+class WaveformGenerator {
+public:
+    /// \param seed The seed of the noise and the glitches.
+    explicit WaveformGenerator(uint32_t seed = 0);
+
+    /// \brief Change the signal, the phase continues.
+    void setSettings(const WaveformSettings& settings);
+    const WaveformSettings& settings() const { return _settings; }
+
+    /// \brief Restart the signal and the random sequences from the seed.
+    void reset();
+
+    /// \brief Generate the next samples of the signal.
+    /// \param output The first sample, the samples are written every stride bytes.
+    /// \param samples The number of samples.
+    /// \param stride The distance of two samples, the number of interleaved channels.
+    /// \param samplerate The samplerate in S/s.
+    void generate(unsigned char* output, unsigned samples, unsigned stride, double samplerate);
+
+    /// \return The number of glitches generated since the last reset.
+    unsigned long long glitches() const { return _glitches; }
+
+private:
+    /// \return The phase increment per sample for a frequency.
+    static uint32_t increment(double frequency, double samplerate);
+    /// \brief Schedule the next glitch.
+    void nextGlitch(double samplerate);
+
+    WaveformSettings _settings;
+    const uint32_t _seed;
+    std::vector<float> _sine;  ///< One period of a sine wave
+    std::vector<float> _noise; ///< Gaussian values with a standard deviation of 1
+
+    uint32_t _phase = 0;           ///< The phase of the signal, 2^32 is one period
+    uint32_t _modulationPhase = 0; ///< The phase of the modulation or the chirp sweep
+    uint32_t _noiseIndex = 0;      ///< The state of the noise index generator
+    std::mt19937 _glitchGenerator;
+    unsigned long long _glitchCountdown = 0; ///< Samples until the next glitch, 0 if there is none
+    double _glitchSamplerate = 0.0;          ///< The samplerate the countdown was computed for
+    unsigned long long _glitches = 0;
+};
+
+}
@@ -42,7 +42,7 @@ HantekDevice::HantekDevice(std::unique_ptr<DSO::USBCommunication> device)
 }
 
 HantekDevice::~HantekDevice() {
-    _device->disconnect();
+    disconnectDevice();
 }
 
 unsigned HantekDevice::getUniqueID() const {
@@ -59,13 +59,12 @@ ErrorCode HantekDevice::uploadFirmware() {
 }
 
 void HantekDevice::deviceDisconnected() {
-    if (!_thread.get()) return;
-    _keep_thread_running = false;
-    if (_thread->joinable()) _thread->join();
-    _thread.reset();
+    stopDeviceTask();
 }
 
 void HantekDevice::disconnectDevice() {
+    // The device task owns the usb transfers
+    stopDeviceTask();
     _device->disconnect();
 }
 
@@ -73,9 +72,7 @@ bool HantekDevice::isDeviceConnected() const {
     return _device->isConnected();
 }
 
-ErrorCode HantekDevice::setChannelUsed(unsigned int channel, bool used) {
-    DeviceBase::setChannelUsed(channel, used);
-
+void HantekDevice::updateChannelUsed(unsigned int, bool) {
     // Calculate the UsedChannels field for the command
     unsigned char usedChannels = USED_CH1;
 
@@ -111,20 +108,13 @@ ErrorCode HantekDevice::setChannelUsed(unsigned int channel, bool used) {
         default:
             break;
     }
-
-    return ErrorCode::ERROR_NONE;
 }
 
-ErrorCode HantekDevice::setCoupling(unsigned int channel, DSO::Coupling coupling) {
-    if(channel >= _specification.channels)
-        return ErrorCode::ERROR_PARAMETER;
-
+void HantekDevice::updateCoupling(unsigned int channel, DSO::Coupling coupling) {
     // SetRelays control command for coupling relays
     ControlSetRelays& cmd = get<ControlSetRelays>();
     cmd.setCoupling(channel, coupling != DSO::Coupling::AC);
     addPending(cmd);
-
-    return ErrorCode::ERROR_NONE;
 }
 
 void HantekDevice::updateGain(unsigned channel, unsigned char gainIndex, unsigned gainId)
@@ -214,8 +204,8 @@ ErrorCode HantekDevice::updateTriggerLevel(unsigned int channel, double level) {
     }
 
     // Never get out of the limits
-    unsigned short int tlevel = _settings.voltage[channel].offsetReal + level / getGainLevel(channel).gainSteps * (maximum - minimum) + 0.5  + minimum;
-    unsigned short int levelValue = std::max(std::min(minimum, tlevel), maximum);
+    double tlevel = (_settings.voltage[channel].offsetReal + level / getGainLevel(channel).gainSteps) * (maximum - minimum) + 0.5  + minimum;
+    unsigned short int levelValue = std::min(std::max((double)minimum, tlevel), (double)maximum);
 
     // SetOffset control command for trigger level
     addPending(get<ControlSetOffset>().setTrigger(levelValue));
@@ -371,7 +361,7 @@ void HantekDevice::updateSamplerate(DSO::ControlSamplerateLimits *limits, unsign
             // Store downsampling factor
             cmd.setDownsampler(downsamplerValue);
             // Set fast rate when used
-            cmd.setFastRate(false /*fastRate*/);
+            cmd.setFastRate(fastRate);
 
             addPending(cmd);
 
@@ -27,6 +27,7 @@
 
 #include <thread>
 #include <functional>
+#include <chrono>
 
 #include "protocol.h"
 #include "usbCommunication.h"
@@ -36,17 +37,22 @@
 
 namespace Hantek2xxx_5xxx {
 
+/// The transfer buffers of one device, for all supported models
+typedef DSO::CommunicationThreadBuffers<
+    BulkSetTriggerAndSamplerate, BulkForceTrigger, BulkCaptureStart, BulkTriggerEnabled,
+    BulkGetData, BulkGetCaptureState, BulkSetGain,
+    BulkSetChannels2250, BulkSetTrigger2250, BulkSetRecordLength2250, BulkSetSamplerate2250, BulkSetBuffer2250,
+    BulkSetSamplerate5200, BulkSetBuffer5200, BulkSetTrigger5200,
+    ControlBeginCommand, ControlSetOffset, ControlSetRelays> HantekBuffers;
+
 //////////////////////////////////////////////////////////////////////////////
 /// Implementation of a DSO DeviceBase for Hantek USB DSO DSO-20xx, DSO-21xx, DSO-22xx, DSO-52xx
-class HantekDevice : public DSO::DeviceBase, public DSO::CommunicationThreadQueues {
+class HantekDevice : public DSO::DeviceBase, public HantekBuffers {
     public:
         HantekDevice(std::unique_ptr<DSO::USBCommunication> device);
         ~HantekDevice();
 
         /// Implemented methods from base classes
-        virtual ErrorCode setChannelUsed(unsigned int channel, bool used) override;
-        virtual ErrorCode setCoupling(unsigned int channel, DSO::Coupling coupling) override;
-
         virtual unsigned getUniqueID() const override;
 
         virtual bool needFirmware() const override;
@@ -57,28 +63,68 @@ class HantekDevice : public DSO::DeviceBase, public DSO::CommunicationThreadQueu
         virtual void disconnectDevice() override;
     private:
         //////////////////////////////////////////////////////////////////////////////
-        /// \enum RollState
-        /// \brief The states of the roll cycle (Since capture state isn't valid).
-        enum class RollState {
-            STARTSAMPLING = 0, ///< Start sampling
-            ENABLETRIGGER = 1, ///< Enable triggering
-            FORCETRIGGER = 2, ///< Force triggering
-            GETDATA = 3, ///< Request sample data
-            COUNT
+        /// \struct CaptureTiming
+        /// \brief The schedule of the current capture in standard mode.
+        /// All points in time are predicted from the samplerate and record length
+        /// when the capture is started.
+        struct CaptureTiming {
+            typedef std::chrono::steady_clock::time_point time_point;
+            typedef std::chrono::steady_clock::duration duration;
+            time_point triggerEnable; ///< The pretrigger buffer is filled, enable the trigger
+            time_point predictedEnd;  ///< Earliest point in time the capture can be ready
+            time_point forceTrigger;  ///< Force the trigger in auto mode
+            time_point restart;       ///< Give up and restart the capture
+            duration poll = std::chrono::milliseconds(1);    ///< Current poll interval after a deadline has passed
+            duration maxPoll = std::chrono::milliseconds(1); ///< Maximal poll interval
+            bool triggerEnabled = false; ///< The trigger was enabled
         };
 
-
-        /// \brief Handles all USB communication and sampling until the device gets disconnected.
-        void run();
-        bool runRollmode(std::vector<unsigned char>& data, RollState& rollState, bool& samplingStarted, unsigned& previouslyReadSamples);
-        bool runStandardMode(std::vector<unsigned char>& data, CaptureState& captureState,
-                             int& cycleCounter, int& startCycle, int timerIntervall,
-                             bool& samplingStarted, DSO::TriggerMode& lastTriggerMode, unsigned& previouslyReadSamples);
+        //////////////////////////////////////////////////////////////////////////////
+        /// \struct AcquisitionState
+        /// \brief The state of the acquisition state machine between two steps.
+        struct AcquisitionState {
+            CaptureState captureState = CaptureState::WAITING;
+            bool samplingStarted = false;
+            DSO::TriggerMode lastTriggerMode = DSO::TriggerMode::UNDEFINED;
+            CaptureTiming timing;
+            CaptureTiming::time_point rollDataReady;
+            unsigned previouslyReadSamples = 0;
+            std::vector<unsigned char> data;
+        };
+        AcquisitionState _acquisition;
+
+        /// \brief One step of the USB communication and sampling, run by the shared executor
+        /// until the device gets disconnected.
+        /// \return The time of the next step.
+        CaptureTiming::time_point step();
+        bool runRollmode(std::vector<unsigned char>& data, bool& samplingStarted, unsigned& previouslyReadSamples,
+                         CaptureTiming::time_point& dataReady, CaptureTiming::time_point& wakeup);
+        bool runStandardMode(std::vector<unsigned char>& data, CaptureState& captureState, CaptureTiming& timing,
+                             bool& samplingStarted, DSO::TriggerMode& lastTriggerMode, unsigned& previouslyReadSamples,
+                             CaptureTiming::time_point& wakeup);
+
+        /// \brief Start a roll mode capture. The capture start, trigger enable and
+        /// force trigger commands are sent back-to-back.
+        /// \return libusb error code on error (<0).
+        int startRollCapture();
+
+        /// \brief Return the time the oscilloscope needs to fill one roll mode packet.
+        CaptureTiming::duration rollPacketTime() const;
+
+        /// \brief Predict the schedule of a capture that is started now.
+        void startCaptureTiming(CaptureTiming& timing, CaptureTiming::time_point now) const;
+
+        /// \brief Return when the capture state should be checked next. Sleeps until the
+        /// next deadline of the capture and polls with an increasing interval once it has
+        /// passed, so the result is always in the future.
+        CaptureTiming::time_point nextCapturePoll(CaptureTiming& timing, CaptureTiming::time_point now) const;
 
         /// Implemented methods from base classes
         virtual double getDownsamplerRate(double bestDownsampler, bool maximum) const override;
         virtual void updatePretriggerPosition(double pretrigger_pos_in_s) override;
         virtual void updateRecordLength(unsigned int index) override;
+        virtual void updateChannelUsed(unsigned int channel, bool used) override;
+        virtual void updateCoupling(unsigned int channel, DSO::Coupling coupling) override;
         virtual void updateSamplerate(DSO::ControlSamplerateLimits* limits, unsigned int downsampler, bool fastRate) override;
         virtual void updateGain(unsigned channel, unsigned char gain, unsigned gainId) override;
         virtual void updateOffset(unsigned int channel, unsigned short int offsetValue) override;
@@ -89,28 +135,29 @@ class HantekDevice : public DSO::DeviceBase, public DSO::CommunicationThreadQueu
         /**
          * @brief Sends a bulk command. _device->bulkWrite cannot be called
          * directly, because a usb control sequence has to be send before each bulk request.
-         * This can only be done in the sample thread (in run()).
+         * This can only be done in the device task (in step()).
          * @param command
          * @return Return an usb error code.
          */
-        int sampleThreadBulkCommand(USBTransferBuffer* command);
+        int sampleThreadBulkCommand(const USBTransferBuffer* command);
+
+        /// Pending bulk commands need the same control sequence, see sampleThreadBulkCommand().
+        virtual int sendBulkCommand(DSO::USBCommunication* device, const USBTransferBuffer* cmd) override;
 
         /// \brief Gets the current state.
-        /// This is done in the sample thread (in run())
+        /// This is done in the device task (in step())
         /// \return <libusb error code on error (<0) or the trigger position,
         ///          The current CaptureState of the oscilloscope>.
         std::pair<int, CaptureState> readCaptureState();
 
         /// \brief Gets sample data from the oscilloscope.
-        /// This is done in the sample thread (in run())
+        /// This is done in the device task (in step())
         /// \param data The data from the oscilloscope is store here.
         /// \return sample count on success, libusb error code on error.
         int readSamples(std::vector<unsigned char>& data, unsigned recordLength, unsigned& previouslyReadSamples);
 
         /// The USB device for the oscilloscope
         std::unique_ptr<DSO::USBCommunication> _device;
-        std::unique_ptr<std::thread> _thread;
-        volatile bool _keep_thread_running;
 
         /// USB device has been disconnected. This will be called if disconnectDevice() is issued before
         /// or if an usb error occured or the device has been plugged out.
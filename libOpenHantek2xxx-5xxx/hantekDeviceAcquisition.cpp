@@ -41,88 +41,137 @@
 
 namespace Hantek2xxx_5xxx {
 
-bool HantekDevice::runRollmode(std::vector<unsigned char>& data, RollState& rollState,
-                               bool& samplingStarted, unsigned& previouslyReadSamples) {
-    // Don't iterate through roll mode steps when stopped
-    if(!_sampling) {
-        return true;
+int HantekDevice::startRollCapture() {
+    // Roll mode doesn't wait for a trigger event, so the whole sequence is sent at once
+    const USBTransferBuffer* sequence[] = {&get<BulkCaptureStart>(), &get<BulkTriggerEnabled>(), &get<BulkForceTrigger>()};
+    for(const USBTransferBuffer* command: sequence) {
+        int errorCode = sampleThreadBulkCommand(command);
+        if(errorCode < 0)
+            return errorCode;
     }
+    timestampDebug("Starting to capture");
+    return 0;
+}
 
-    int errorCode = 0;
+HantekDevice::CaptureTiming::duration HantekDevice::rollPacketTime() const {
+    // Samples per channel in one packet
+    double samples = _device->getPacketSize();
+    if(_specification.sampleSize > 8)
+        samples /= 2;
+    if(!isFastRate())
+        samples /= _specification.channels;
 
-    switch(rollState) {
-    case RollState::STARTSAMPLING:
+    return std::chrono::duration_cast<CaptureTiming::duration>(
+                std::chrono::duration<double>(samples / _settings.samplerate.current));
+}
 
+bool HantekDevice::runRollmode(std::vector<unsigned char>& data, bool& samplingStarted, unsigned& previouslyReadSamples,
+                               CaptureTiming::time_point& dataReady, CaptureTiming::time_point& wakeup) {
+    int errorCode = 0;
+    CaptureTiming::time_point now = std::chrono::steady_clock::now();
+
+    if(!samplingStarted) {
         // Sampling hasn't started, update the expected sample count
         previouslyReadSamples = _device->getPacketSize();
 
-        errorCode = sampleThreadBulkCommand(&get<BulkCaptureStart>());
+        errorCode = startRollCapture();
         if(errorCode < 0) {
-            if(errorCode == LIBUSB_ERROR_NO_DEVICE)
-                return false;
-            break;
+            wakeup = now + std::chrono::milliseconds(10);
+            return errorCode != LIBUSB_ERROR_NO_DEVICE;
         }
 
-        timestampDebug("Starting to capture");
         samplingStarted = true;
-        break;
-    case RollState::ENABLETRIGGER:
-        errorCode = sampleThreadBulkCommand(&get<BulkTriggerEnabled>());
-        if(errorCode < 0) {
-            if(errorCode == LIBUSB_ERROR_NO_DEVICE)
-                return false;
-            break;
-        }
-        timestampDebug("Enabling trigger");
-        break;
-    case RollState::FORCETRIGGER:
-        errorCode = sampleThreadBulkCommand(&get<BulkForceTrigger>());
-        if(errorCode < 0) {
-            if(errorCode == LIBUSB_ERROR_NO_DEVICE)
-                return false;
-            break;
-        }
-        timestampDebug("Forcing trigger");
-        break;
+        dataReady = now + rollPacketTime();
+        wakeup = dataReady;
+        return true;
+    }
 
-    case RollState::GETDATA:
-        // Get data and process it, if we're still sampling
-        errorCode = readSamples(data, _device->getPacketSize(), previouslyReadSamples);
-        if(errorCode < 0)
-            std::cerr << "Getting sample data failed: " <<
-                         libusb_error_name((libusb_error)errorCode) << " " <<
-                         libusb_strerror((libusb_error)errorCode) << std::endl;
-        else {
-            timestampDebug("Received " << errorCode << " B of sampling data");
-        }
-        // Process the data only if we want it
-        if(samplingStarted) {
-            processSamples(data);
-            _samplesAvailable(_samples);
+    // The packet can't be complete earlier
+    if(now < dataReady) {
+        wakeup = dataReady;
+        return true;
+    }
 
-            // Check if we're in single trigger mode
-            if(_settings.trigger.mode == DSO::TriggerMode::SINGLE)
-                stopSampling();
+    // Get data
+    errorCode = readSamples(data, _device->getPacketSize(), previouslyReadSamples);
+    if(errorCode < 0)
+        std::cerr << "Getting sample data failed: " <<
+                     libusb_error_name((libusb_error)errorCode) << " " <<
+                     libusb_strerror((libusb_error)errorCode) << std::endl;
+    else {
+        timestampDebug("Received " << errorCode << " B of sampling data");
+    }
+    samplingStarted = false;
+    const bool received = errorCode >= 0;
+
+    // Start the next packet first, the oscilloscope fills it while this one is processed
+    const bool single = _settings.trigger.mode == DSO::TriggerMode::SINGLE;
+    if(_sampling && !single) {
+        previouslyReadSamples = _device->getPacketSize();
 
-            // Sampling completed, restart it when necessary
-            samplingStarted = false;
+        errorCode = startRollCapture();
+        if(errorCode == LIBUSB_ERROR_NO_DEVICE)
+            return false;
+        if(errorCode >= 0) {
+            samplingStarted = true;
+            dataReady = std::chrono::steady_clock::now() + rollPacketTime();
         }
+    }
 
-        break;
-    default:
-        timestampDebug("Roll mode state unknown");
-        break;
+    if(received) {
+        if(processSamples(data))
+            _frameBus.publish(_frame);
     }
 
-    // Go to next state, or restart if last state was reached
-    rollState = (RollState) (((int)rollState + 1) % (int)RollState::COUNT);
+    // Check if we're in single trigger mode
+    if(single)
+        stopSampling();
 
+    wakeup = samplingStarted ? dataReady : std::chrono::steady_clock::now();
     return true;
 }
 
-bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureState& captureState,
-                                   int& cycleCounter, int& startCycle, int timerIntervall,
-                                   bool& samplingStarted, DSO::TriggerMode& lastTriggerMode, unsigned& previouslyReadSamples) {
+void HantekDevice::startCaptureTiming(CaptureTiming& timing, CaptureTiming::time_point now) const {
+    using namespace std::chrono;
+    typedef duration<double> seconds_d;
+
+    // RecLen/Samplerate=Duration in s
+    const seconds_d recordTime(getCurrentRecordType().length_per_channel / _settings.samplerate.current);
+
+    // The longest poll interval is 25% of the time the buffer needs to be refilled,
+    // not more often than every 10 ms though but at least once every second
+    timing.maxPoll = duration_cast<CaptureTiming::duration>(
+                std::min(std::max(seconds_d(0.01), recordTime * 0.25), seconds_d(1.0)));
+    timing.poll = milliseconds(1);
+
+    timing.triggerEnable = now + duration_cast<CaptureTiming::duration>(seconds_d(_settings.trigger.pretrigger_pos_in_s));
+    timing.predictedEnd = now + duration_cast<CaptureTiming::duration>(recordTime);
+    timing.forceTrigger = timing.triggerEnable + 8 * timing.maxPoll;
+    timing.restart = now + std::max(CaptureTiming::duration(seconds(4)), 20 * timing.maxPoll);
+    timing.triggerEnabled = false;
+}
+
+HantekDevice::CaptureTiming::time_point HantekDevice::nextCapturePoll(CaptureTiming& timing, CaptureTiming::time_point now) const {
+    CaptureTiming::time_point next = timing.triggerEnabled ? timing.predictedEnd : timing.triggerEnable;
+
+    // Once it is due, the trigger is forced by every poll
+    if(_settings.trigger.mode == DSO::TriggerMode::AUTO && timing.triggerEnabled && now < timing.forceTrigger)
+        next = std::min(next, timing.forceTrigger);
+    if(now < timing.restart)
+        next = std::min(next, timing.restart);
+
+    // The deadline has passed but the oscilloscope is not there yet (still sampling, waiting
+    // for a trigger or for the restart), poll often first and back off
+    if(next <= now) {
+        next = now + timing.poll;
+        timing.poll = std::min(timing.poll * 2, timing.maxPoll);
+    }
+    return next;
+}
+
+bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureState& captureState, CaptureTiming& timing,
+                                   bool& samplingStarted, DSO::TriggerMode& lastTriggerMode, unsigned& previouslyReadSamples,
+                                   CaptureTiming::time_point& wakeup) {
     int errorCode;
     CaptureState lastCaptureState = captureState;
     std::tie(errorCode,captureState) = readCaptureState();
@@ -134,6 +183,9 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
         return false;
     }
 
+    const CaptureTiming::time_point now = std::chrono::steady_clock::now();
+    wakeup = nextCapturePoll(timing, now);
+
     // Errorcode is the trigger point if >= 0.
     _settings.trigger.point = errorCode;
 
@@ -160,8 +212,8 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
         }
         // Process the data only if we want it
         if(samplingStarted) {
-            processSamples(data);
-            _samplesAvailable(_samples);
+            if(processSamples(data))
+                _frameBus.publish(_frame);
         }
 
         // Check if we're in single trigger mode
@@ -180,9 +232,10 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
         previouslyReadSamples = getExpectedRecordLength();
 
         if(samplingStarted && lastTriggerMode == _settings.trigger.mode) {
-            ++cycleCounter;
+            if(!timing.triggerEnabled) {
+                if(now < timing.triggerEnable)
+                    break;
 
-            if(cycleCounter == startCycle) {
                 // Buffer refilled completely since start of sampling, enable the trigger now
                 errorCode = sampleThreadBulkCommand(&get<BulkTriggerEnabled>());
                 if(errorCode < 0) {
@@ -192,9 +245,11 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
                 }
 
                 timestampDebug("Enabling trigger");
-
+                timing.triggerEnabled = true;
+                timing.poll = std::chrono::milliseconds(1);
+                wakeup = nextCapturePoll(timing, now);
             }
-            else if(cycleCounter >= 8 + startCycle && _settings.trigger.mode == DSO::TriggerMode::AUTO) {
+            else if(now >= timing.forceTrigger && _settings.trigger.mode == DSO::TriggerMode::AUTO) {
                 // Force triggering
                 errorCode = sampleThreadBulkCommand(&get<BulkForceTrigger>());
                 if(errorCode < 0) {
@@ -203,9 +258,10 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
                     break;
                 }
                 timestampDebug("Forcing trigger");
+                wakeup = now + timing.maxPoll;
             }
 
-            if(cycleCounter < 20 || cycleCounter < 4000 / timerIntervall)
+            if(now < timing.restart)
                 break;
         }
 
@@ -220,9 +276,9 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
         timestampDebug("Starting to capture");
 
         samplingStarted = true;
-        cycleCounter = 0;
-        startCycle = _settings.trigger.pretrigger_pos_in_s * 1000 / timerIntervall + 1;
+        startCaptureTiming(timing, now);
         lastTriggerMode = _settings.trigger.mode;
+        wakeup = nextCapturePoll(timing, now);
         break;
 
     case CaptureState::SAMPLING:
@@ -233,49 +289,36 @@ bool HantekDevice::runStandardMode(std::vector<unsigned char>& data, CaptureStat
     return true;
 }
 
-void HantekDevice::run() {
-    // Initialize usb communication thread state
-    CaptureState captureState = CaptureState::WAITING;
-    RollState rollState       = RollState::STARTSAMPLING;
-    bool samplingStarted      = false;
-    DSO::TriggerMode lastTriggerMode = DSO::TriggerMode::UNDEFINED;
-    int cycleCounter          = 0;
-    int startCycle            = 0;
-    unsigned previouslyReadSamples = 0;
-    std::vector<unsigned char> data;
-
-    while (_keep_thread_running) {
-        if (!sendPendingCommands(_device.get())) break;
-
-        // Compute sleep time
-        int cycleTime;
-
-        if(isRollingMode())
-            cycleTime = _device->getPacketSize() / (!isFastRate() ? 1 : _specification.channels);
-        else
-            cycleTime = getCurrentRecordType().length_per_channel;
-
-        cycleTime /= _settings.samplerate.current; // RecLen/Samplerate=Duration in s
-        cycleTime *= 1000; // Duration in ms
-
-        // Check the current oscilloscope state, everytime 25% of the time
-        // the buffer should be refilled.
-        // Not more often than every 10 ms though but at least once every second
-        cycleTime = std::min(std::max(10, int(cycleTime * 0.25)), 1000);
-
-        // State machine for the device communication
-        if(isRollingMode()) {
-            if (!runRollmode(data, rollState, samplingStarted, previouslyReadSamples)) break;
-        } else {
-            if (!runStandardMode(data, captureState, cycleCounter,
-                                 startCycle, cycleTime, samplingStarted, lastTriggerMode, previouslyReadSamples)) break;
-        }
+HantekDevice::CaptureTiming::time_point HantekDevice::step() {
+    AcquisitionState& state = _acquisition;
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(cycleTime));
+    // Settings changes of other threads are already applied, they may add pending commands
+    if (!sendPendingCommands(_device.get())) {
+        _device->disconnect();
+        _statusMessage(LIBUSB_ERROR_NO_DEVICE);
+        return DSO::Executor::finished;
     }
 
-    _device->disconnect();
-    _statusMessage(LIBUSB_ERROR_NO_DEVICE);
+    // Nothing to do until sampling is started or the settings change
+    if(!_sampling)
+        return DSO::Executor::idle;
+
+    // State machine for the device communication
+    CaptureTiming::time_point wakeup;
+    bool deviceAvailable;
+    if(isRollingMode())
+        deviceAvailable = runRollmode(state.data, state.samplingStarted, state.previouslyReadSamples,
+                                      state.rollDataReady, wakeup);
+    else
+        deviceAvailable = runStandardMode(state.data, state.captureState, state.timing, state.samplingStarted,
+                                          state.lastTriggerMode, state.previouslyReadSamples, wakeup);
+
+    if (!deviceAvailable) {
+        _device->disconnect();
+        _statusMessage(LIBUSB_ERROR_NO_DEVICE);
+        return DSO::Executor::finished;
+    }
+    return wakeup;
 }
 
 std::pair<int, CaptureState> HantekDevice::readCaptureState() {
@@ -324,7 +367,7 @@ int HantekDevice::readSamples(std::vector<unsigned char>& data, unsigned recordL
 }
 
 
-int HantekDevice::sampleThreadBulkCommand(USBTransferBuffer* command) {
+int HantekDevice::sampleThreadBulkCommand(const USBTransferBuffer* command) {
     // Send BeginCommand control command
     ControlBeginCommand& cmd = get<ControlBeginCommand>();
     int errorCode = _device->controlWrite(CONTROL_BEGINCOMMAND, cmd.data(), cmd.size());
@@ -334,4 +377,8 @@ int HantekDevice::sampleThreadBulkCommand(USBTransferBuffer* command) {
     return _device->bulkWrite(command->data(), command->size());
 }
 
+int HantekDevice::sendBulkCommand(DSO::USBCommunication*, const USBTransferBuffer* cmd) {
+    return sampleThreadBulkCommand(cmd);
+}
+
 }
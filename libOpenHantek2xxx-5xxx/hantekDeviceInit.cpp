@@ -111,9 +111,9 @@ void HantekDevice::connectDevice() {
             _specification.samplerate_multi.base = 200e6;
             _specification.samplerate_multi.max = 250e6;
             _specification.samplerate_multi.maxDownsampler = 131072;
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(20480, 1));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(28672, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(20480, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(28672, 1));
             _specification.sampleSize = 10;
 
             _specification.gainLevel.push_back(DSO::dsoGainLevel(1,  0.16, 368));
@@ -138,9 +138,9 @@ void HantekDevice::connectDevice() {
             _specification.samplerate_multi.base = 200e6;
             _specification.samplerate_multi.max = 250e6;
             _specification.samplerate_multi.maxDownsampler = 65536;
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(20480, 1));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(1048576, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(20480, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(1048576, 1));
             _specification.sampleSize = 8;
 
             _specification.gainLevel.push_back(DSO::dsoGainLevel(0,  0.08, 255));
@@ -165,9 +165,9 @@ void HantekDevice::connectDevice() {
             _specification.samplerate_multi.base = 100e6;
             _specification.samplerate_multi.max = 150e6;
             _specification.samplerate_multi.maxDownsampler = 131072;
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(20480, 1));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(65536, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(20480, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(65536, 1));
             _specification.sampleSize = 8;
 
             _specification.gainLevel.push_back(DSO::dsoGainLevel(0,  0.08, 255));
@@ -191,9 +191,9 @@ void HantekDevice::connectDevice() {
             _specification.samplerate_multi.base = 100e6;
             _specification.samplerate_multi.max = 100e6;
             _specification.samplerate_multi.maxDownsampler = 131072;
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(20480, 1));
-            _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(65536, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(20480, 1));
+            _specification.samplerate_multi.recordTypes.push_back(DSO::dsoRecord(65536, 1));
             _specification.sampleSize = 8;
 
             _specification.gainLevel.push_back(DSO::dsoGainLevel(0,  0.08, 255));
@@ -233,6 +233,9 @@ void HantekDevice::connectDevice() {
     setCoupling(0,DSO::Coupling::DC);
     setCoupling(1,DSO::Coupling::DC);
 
+    // The oscilloscope starts in roll mode, send the record length of the settings
+    updateRecordLength(_settings.recordTypeID);
+
     // _signals for initial _settings
     notifySamplerateLimitsChanged();
     _recordLengthChanged(_settings.recordTypeID);
@@ -242,8 +245,11 @@ void HantekDevice::connectDevice() {
 
     _sampling = false;
     // The control loop is running until the device is disconnected
-    _keep_thread_running = true;
-    _thread = std::unique_ptr<std::thread>(new std::thread(&HantekDevice::run,std::ref(*this)));
+    _acquisition = AcquisitionState();
+    startCaptureTiming(_acquisition.timing, std::chrono::steady_clock::now());
+    startDeviceTask(std::bind(&HantekDevice::step, this));
+
+    _deviceConnected();
 }
 
 }
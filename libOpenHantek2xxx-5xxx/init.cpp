@@ -24,17 +24,35 @@
 #include "hantekDevice.h"
 #include "deviceDescriptionEntry.h"
 #include "usbCommunication.h"
+#include "usbEmulator.h"
 
 namespace Hantek2xxx_5xxx {
     DSO::DeviceBase* makeHantekDevice(libusb_device* device, const DSO::DSODeviceDescription& model) {
         return new HantekDevice(std::unique_ptr<DSO::USBCommunication>(new DSO::USBCommunication(device, model)));
     }
 
+    static const DSO::DSODeviceDescription models[] = {
+        {"DSO-2090", 0x2090, 0x04b5, 0x02, 0x86, false, makeHantekDevice},
+        {"DSO-2150", 0x2150, 0x04b5, 0x02, 0x86, false, makeHantekDevice},
+        {"DSO-2250", 0x2250, 0x04b5, 0x02, 0x86, false, makeHantekDevice},
+        {"DSO-5200", 0x5200, 0x04b5, 0x02, 0x86, false, makeHantekDevice},
+        {"DSO-5200A", 0x520A, 0x04b5, 0x02, 0x86, false, makeHantekDevice}
+    };
+
     void registerHantek2xxx_5xxxProducts(DSO::DeviceList& devicelist) {
-        devicelist.registerModel({"DSO-2090", 0x2090, 0x04b5, 0x02, 0x86, false, makeHantekDevice});
-        devicelist.registerModel({"DSO-2150", 0x2150, 0x04b5, 0x02, 0x86, false, makeHantekDevice});
-        devicelist.registerModel({"DSO-2250", 0x2250, 0x04b5, 0x02, 0x86, false, makeHantekDevice});
-        devicelist.registerModel({"DSO-5200", 0x5200, 0x04b5, 0x02, 0x86, false, makeHantekDevice});
-        devicelist.registerModel({"DSO-5200A", 0x520A, 0x04b5, 0x02, 0x86, false, makeHantekDevice});
+        for(const DSO::DSODeviceDescription& model: models)
+            devicelist.registerModel(model);
+    }
+
+    DSO::DeviceBase* makeEmulatedHantekDevice(uint16_t productID, uint8_t uniqueID, USBEmulator** emulator) {
+        for(const DSO::DSODeviceDescription& model: models) {
+            if(model.productID != productID)
+                continue;
+            USBEmulator* usbEmulator = new USBEmulator(model, uniqueID);
+            if(emulator)
+                *emulator = usbEmulator;
+            return new HantekDevice(std::unique_ptr<DSO::USBCommunication>(usbEmulator));
+        }
+        return nullptr;
     }
 }
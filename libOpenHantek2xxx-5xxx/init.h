@@ -24,5 +24,14 @@
 
 #include "deviceList.h"
 namespace Hantek2xxx_5xxx {
+    class USBEmulator;
+
     void registerHantek2xxx_5xxxProducts(DSO::DeviceList& devicelist);
+
+    /// Create a device that is connected to an emulated oscilloscope (see USBEmulator).
+    /// \param productID The usb product id of the emulated model.
+    /// \param uniqueID The unique id of the device.
+    /// \param emulator If not null, set to the emulator. It is owned by the device.
+    /// \return The new device or nullptr if the model is not supported.
+    DSO::DeviceBase* makeEmulatedHantekDevice(uint16_t productID, uint8_t uniqueID = 0, USBEmulator** emulator = nullptr);
 }
@@ -22,9 +22,9 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-SOURCES += hantekDeviceAcquisition.cpp  hantekDevice.cpp  hantekDeviceInit.cpp  init.cpp  protocol.cpp
+SOURCES += hantekDeviceAcquisition.cpp  hantekDevice.cpp  hantekDeviceInit.cpp  init.cpp  protocol.cpp  usbEmulator.cpp
 
-HEADERS += hantekDevice.h  init.h  protocolBulk.h  protocolControl.h  protocol.h
+HEADERS += hantekDevice.h  init.h  protocolBulk.h  protocolControl.h  protocol.h  usbEmulator.h
 unix {
     target.path = /usr/lib
     INSTALLS += target
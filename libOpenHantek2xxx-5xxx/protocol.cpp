@@ -22,14 +22,13 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <cstring>
 #include "protocol.h"
 
 namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetFilter
     /// \brief Sets the data array to the default values.
-    BulkSetFilter::BulkSetFilter() : USBTransferBuffer(8) {
+    BulkSetFilter::BulkSetFilter() {
         this->init();
     }
 
@@ -37,7 +36,7 @@ namespace Hantek2xxx_5xxx {
     /// \param channel1 true if channel 1 is filtered.
     /// \param channel2 true if channel 2 is filtered.
     /// \param trigger true if trigger is filtered.
-    BulkSetFilter::BulkSetFilter(bool channel1, bool channel2, bool trigger) : USBTransferBuffer(8) {
+    BulkSetFilter::BulkSetFilter(bool channel1, bool channel2, bool trigger) {
         this->init();
 
         this->setChannel(0, channel1);
@@ -49,49 +48,45 @@ namespace Hantek2xxx_5xxx {
     /// \param channel The channel whose filtering state should be returned.
     /// \return The filtering state of the channel.
     bool BulkSetFilter::getChannel(unsigned int channel) {
-        FilterBits *filterBits = (FilterBits *) &(this->array[2]);
         if(channel == 0)
-            return filterBits->channel1 == 1;
+            return this->bits<2, FilterBits::channel1>() == 1;
         else
-            return filterBits->channel2 == 1;
+            return this->bits<2, FilterBits::channel2>() == 1;
     }
     
     /// \brief Enables/disables filtering of one channel.
     /// \param channel The channel that should be set.
     /// \param filtered true if the channel should be filtered.
     void BulkSetFilter::setChannel(unsigned int channel, bool filtered) {
-        FilterBits *filterBits = (FilterBits *) &(this->array[2]);
         if(channel == 0)
-            filterBits->channel1 = filtered ? 1 : 0;
+            this->setBits<2, FilterBits::channel1>(filtered ? 1 : 0);
         else
-            filterBits->channel2 = filtered ? 1 : 0;
+            this->setBits<2, FilterBits::channel2>(filtered ? 1 : 0);
     }
 
     /// \brief Gets the filtering state for the trigger.
     /// \return The filtering state of the trigger.
     bool BulkSetFilter::getTrigger() {
-        return ((FilterBits *) &(this->array[2]))->trigger == 1;
+        return this->bits<2, FilterBits::trigger>() == 1;
     }
 
     /// \brief Enables/disables filtering for the trigger.
     /// \param filtered true if the trigger should be filtered.
     void BulkSetFilter::setTrigger(bool filtered) {
-        FilterBits *filterBits = (FilterBits *) &(this->array[2]);
-
-        filterBits->trigger = filtered ? 1 : 0;
+        this->setBits<2, FilterBits::trigger>(filtered ? 1 : 0);
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetFilter::init() {
-        this->array[0] = BULK_SETFILTER;
-        this->array[1] = 0x0f;
+        this->byte<0>() = BULK_SETFILTER;
+        this->byte<1>() = 0x0f;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetTriggerAndSamplerate
     /// \brief Sets the data array to the default values.
-    BulkSetTriggerAndSamplerate::BulkSetTriggerAndSamplerate() : USBTransferBuffer(12) {
+    BulkSetTriggerAndSamplerate::BulkSetTriggerAndSamplerate() {
         this->init();
     }
 
@@ -105,7 +100,7 @@ namespace Hantek2xxx_5xxx {
     /// \param usedChannels The enabled channels (Tsr2).
     /// \param fastRate The fastRate state (Tsr2).
     /// \param triggerSlope The triggerSlope value (Tsr2).
-    BulkSetTriggerAndSamplerate::BulkSetTriggerAndSamplerate(uint16_t downsampler, uint32_t triggerPosition, uint8_t triggerSource, uint8_t recordLength, uint8_t samplerateId, bool downsamplingMode, uint8_t usedChannels, bool fastRate, uint8_t triggerSlope) : USBTransferBuffer(12) {
+    BulkSetTriggerAndSamplerate::BulkSetTriggerAndSamplerate(uint16_t downsampler, uint32_t triggerPosition, uint8_t triggerSource, uint8_t recordLength, uint8_t samplerateId, bool downsamplingMode, uint8_t usedChannels, bool fastRate, uint8_t triggerSlope) {
         this->init();
 
         this->setTriggerSource(triggerSource);
@@ -122,199 +117,157 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the triggerSource value in Tsr1Bits.
     /// \return The triggerSource value.
     uint8_t BulkSetTriggerAndSamplerate::getTriggerSource() {
-        return ((Tsr1Bits *) &(this->array[2]))->triggerSource;
+        return this->bits<2, Tsr1Bits::triggerSource>();
     }
 
     /// \brief Set the triggerSource in Tsr1Bits to the given value.
     /// \param value The new triggerSource value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setTriggerSource(uint8_t value) {
-        ((Tsr1Bits *) &(this->array[2]))->triggerSource = value;
+        this->setBits<2, Tsr1Bits::triggerSource>(value);
         return *this;
     }
 
     /// \brief Get the recordLength value in Tsr1Bits.
     /// \return The ::RecordLengthId value.
     uint8_t BulkSetTriggerAndSamplerate::getRecordLength() {
-        return ((Tsr1Bits *) &(this->array[2]))->recordLength;
+        return this->bits<2, Tsr1Bits::recordLength>();
     }
 
     /// \brief Set the recordLength in Tsr1Bits to the given value.
     /// \param value The new ::RecordLengthId value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setRecordLength(uint8_t value) {
-        ((Tsr1Bits *) &(this->array[2]))->recordLength = value;
+        this->setBits<2, Tsr1Bits::recordLength>(value);
         return *this;
     }
 
     /// \brief Get the samplerateId value in Tsr1Bits.
     /// \return The samplerateId value.
     uint8_t BulkSetTriggerAndSamplerate::getSamplerateId() {
-        return ((Tsr1Bits *) &(this->array[2]))->samplerateId;
+        return this->bits<2, Tsr1Bits::samplerateId>();
     }
 
     /// \brief Set the samplerateId in Tsr1Bits to the given value.
     /// \param value The new samplerateId value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setSamplerateId(uint8_t value) {
-        ((Tsr1Bits *) &(this->array[2]))->samplerateId = value;
+        this->setBits<2, Tsr1Bits::samplerateId>(value);
         return *this;
     }
 
     /// \brief Get the downsamplerMode value in Tsr1Bits.
     /// \return The downsamplerMode value.
     bool BulkSetTriggerAndSamplerate::getDownsamplingMode() {
-        return ((Tsr1Bits *) &(this->array[2]))->downsamplingMode == 1;
+        return this->bits<2, Tsr1Bits::downsamplingMode>() == 1;
     }
 
     /// \brief Set the downsamplerMode in Tsr1Bits to the given value.
     /// \param downsampling The new downsamplerMode value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setDownsamplingMode(bool downsampling) {
-        ((Tsr1Bits *) &(this->array[2]))->downsamplingMode = downsampling ? 1 : 0;
+        this->setBits<2, Tsr1Bits::downsamplingMode>(downsampling ? 1 : 0);
         return *this;
     }
 
     /// \brief Get the usedChannels value in Tsr2Bits.
     /// \return The usedChannels value.
     uint8_t BulkSetTriggerAndSamplerate::getUsedChannels() {
-        return ((Tsr2Bits *) &(this->array[3]))->usedChannels;
+        return this->bits<3, Tsr2Bits::usedChannels>();
     }
 
     /// \brief Set the usedChannels in Tsr2Bits to the given value.
     /// \param value The new usedChannels value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setUsedChannels(uint8_t value) {
-        ((Tsr2Bits *) &(this->array[3]))->usedChannels = value;
+        this->setBits<3, Tsr2Bits::usedChannels>(value);
         return *this;
     }
 
     /// \brief Get the fastRate state in Tsr2Bits.
     /// \return The fastRate state.
     bool BulkSetTriggerAndSamplerate::getFastRate() {
-        return ((Tsr2Bits *) &(this->array[3]))->fastRate == 1;
+        return this->bits<3, Tsr2Bits::fastRate>() == 1;
     }
 
     /// \brief Set the fastRate in Tsr2Bits to the given state.
     /// \param fastRate The new fastRate state.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setFastRate(bool fastRate) {
-        ((Tsr2Bits *) &(this->array[3]))->fastRate = fastRate ? 1 : 0;
+        this->setBits<3, Tsr2Bits::fastRate>(fastRate ? 1 : 0);
         return *this;
     }
 
     /// \brief Get the triggerSlope value in Tsr2Bits.
     /// \return The triggerSlope value.
     uint8_t BulkSetTriggerAndSamplerate::getTriggerSlope() {
-        return ((Tsr2Bits *) &(this->array[3]))->triggerSlope;
+        return this->bits<3, Tsr2Bits::triggerSlope>();
     }
 
     /// \brief Set the triggerSlope in Tsr2Bits to the given value.
     /// \param slope The new triggerSlope value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setTriggerSlope(uint8_t slope) {
-        ((Tsr2Bits *) &(this->array[3]))->triggerSlope = slope;
+        this->setBits<3, Tsr2Bits::triggerSlope>(slope);
         return *this;
     }
 
     /// \brief Get the Downsampler value.
     /// \return The Downsampler value.
     uint16_t BulkSetTriggerAndSamplerate::getDownsampler() {
-        return (uint16_t) this->array[4] | ((uint16_t) this->array[5] << 8);
+        return this->littleEndian<4, 2>();
     }
 
     /// \brief Set the Downsampler to the given value.
     /// \param downsampler The new Downsampler value.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setDownsampler(uint16_t downsampler) {
-        this->array[4] = (uint8_t) downsampler;
-        this->array[5] = (uint8_t) (downsampler >> 8);
+        this->setLittleEndian<4, 2>(downsampler);
         return *this;
     }
 
     /// \brief Get the TriggerPosition value.
     /// \return The horizontal trigger position.
     uint32_t BulkSetTriggerAndSamplerate::getTriggerPosition() {
-        return (uint32_t) this->array[6] | ((uint32_t) this->array[7] << 8) | ((uint32_t) this->array[10] << 16);
+        return this->littleEndian<6, 2>() | ((uint32_t) this->byte<10>() << 16);
     }
 
     /// \brief Set the TriggerPosition to the given value.
     /// \param position The new horizontal trigger position.
     BulkSetTriggerAndSamplerate& BulkSetTriggerAndSamplerate::setTriggerPosition(uint32_t position) {
-        this->array[6] = (uint8_t) position;
-        this->array[7] = (uint8_t) (position >> 8);
-        this->array[10] = (uint8_t) (position >> 16);
+        this->setLittleEndian<6, 2>(position);
+        this->byte<10>() = (uint8_t) (position >> 16);
         return *this;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetTriggerAndSamplerate::init() {
-        this->array[0] = BULK_SETTRIGGERANDSAMPLERATE;
-    }
-
-
-    //////////////////////////////////////////////////////////////////////////////
-    // class BulkForceTrigger
-    /// \brief Sets the data array to needed values.
-    BulkForceTrigger::BulkForceTrigger() : USBTransferBuffer(2) {
-        this->array[0] = BULK_FORCETRIGGER;
-    }
-
-
-    //////////////////////////////////////////////////////////////////////////////
-    // class BulkCaptureStart
-    /// \brief Sets the data array to needed values.
-    BulkCaptureStart::BulkCaptureStart() : USBTransferBuffer(2) {
-        this->array[0] = BULK_STARTSAMPLING;
-    }
-
-
-    //////////////////////////////////////////////////////////////////////////////
-    // class BulkTriggerEnabled
-    /// \brief Sets the data array to needed values.
-    BulkTriggerEnabled::BulkTriggerEnabled() : USBTransferBuffer(2) {
-        this->array[0] = BULK_ENABLETRIGGER;
-    }
-
-
-    //////////////////////////////////////////////////////////////////////////////
-    // class BulkGetData
-    /// \brief Sets the data array to needed values.
-    BulkGetData::BulkGetData() : USBTransferBuffer(2) {
-        this->array[0] = BULK_GETDATA;
-    }
-
-
-    //////////////////////////////////////////////////////////////////////////////
-    // class BulkGetCaptureState
-    /// \brief Sets the data array to needed values.
-    BulkGetCaptureState::BulkGetCaptureState() : USBTransferBuffer(2) {
-        this->array[0] = BULK_GETCAPTURESTATE;
+        this->byte<0>() = BULK_SETTRIGGERANDSAMPLERATE;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkResponseGetCaptureState
     /// \brief Initializes the array.
-    BulkResponseGetCaptureState::BulkResponseGetCaptureState() : USBTransferBuffer(512) {
+    BulkResponseGetCaptureState::BulkResponseGetCaptureState() {
     }
 
     /// \brief Gets the capture state.
     /// \return The CaptureState of the oscilloscope.
     CaptureState BulkResponseGetCaptureState::getCaptureState() {
-        return (CaptureState) this->array[0];
+        return (CaptureState) this->byte<0>();
     }
 
     /// \brief Gets the trigger point.
     /// \return The trigger point for the captured samples.
     unsigned BulkResponseGetCaptureState::getTriggerPoint() {
-        return this->array[2] | (this->array[3] << 8) | (this->array[1] << 16);
+        return this->littleEndian<2, 2>() | ((unsigned) this->byte<1>() << 16);
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetGain
     /// \brief Sets the data array to needed values.
-    BulkSetGain::BulkSetGain() : USBTransferBuffer(8) {
+    BulkSetGain::BulkSetGain() {
         this->init();
     }
 
     /// \brief Sets the gain to the given values.
     /// \param channel1 The gain value for channel 1.
     /// \param channel2 The gain value for channel 2.
-    BulkSetGain::BulkSetGain(uint8_t channel1, uint8_t channel2) : USBTransferBuffer(8) {
+    BulkSetGain::BulkSetGain(uint8_t channel1, uint8_t channel2) {
         this->init();
 
         this->setGain(0, channel1);
@@ -325,41 +278,39 @@ namespace Hantek2xxx_5xxx {
     /// \param channel The channel whose gain should be returned.
     /// \returns The gain value.
     uint8_t BulkSetGain::getGain(unsigned int channel) {
-        GainBits *gainBits = (GainBits *) &(this->array[2]);
         if(channel == 0)
-            return gainBits->channel1;
+            return this->bits<2, GainBits::channel1>();
         else
-            return gainBits->channel2;
+            return this->bits<2, GainBits::channel2>();
     }
 
     /// \brief Set the gain for the given channel.
     /// \param channel The channel that should be set.
     /// \param value The new gain value for the channel.
     BulkSetGain& BulkSetGain::setGain(unsigned int channel, uint8_t value) {
-        GainBits *gainBits = (GainBits *) &(this->array[2]);
         if(channel == 0)
-            gainBits->channel1 = value;
+            this->setBits<2, GainBits::channel1>(value);
         else
-            gainBits->channel2 = value;
+            this->setBits<2, GainBits::channel2>(value);
         return *this;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetGain::init() {
-        this->array[0] = BULK_SETGAIN;
+        this->byte<0>() = BULK_SETGAIN;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetLogicalData
     /// \brief Sets the data array to needed values.
-    BulkSetLogicalData::BulkSetLogicalData() : USBTransferBuffer(8) {
+    BulkSetLogicalData::BulkSetLogicalData() {
         this->init();
     }
 
     /// \brief Sets the data to the given value.
     /// \param data The data byte.
-    BulkSetLogicalData::BulkSetLogicalData(uint8_t data) : USBTransferBuffer(8) {
+    BulkSetLogicalData::BulkSetLogicalData(uint8_t data) {
         this->init();
 
         this->setData(data);
@@ -368,39 +319,31 @@ namespace Hantek2xxx_5xxx {
     /// \brief Gets the data.
     /// \returns The data byte.
     uint8_t BulkSetLogicalData::getData() {
-        return this->array[2];
+        return this->byte<2>();
     }
 
     /// \brief Sets the data to the given value.
     /// \param data The new data byte.
     void BulkSetLogicalData::setData(uint8_t data) {
-        this->array[2] = data;
+        this->byte<2>() = data;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetLogicalData::init() {
-        this->array[0] = BULK_SETLOGICALDATA;
-    }
-
-
-    //////////////////////////////////////////////////////////////////////////////
-    // class BulkGetLogicalData
-    /// \brief Sets the data array to needed values.
-    BulkGetLogicalData::BulkGetLogicalData() : USBTransferBuffer(2) {
-        this->array[0] = BULK_GETLOGICALDATA;
+        this->byte<0>() = BULK_SETLOGICALDATA;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetFilter2250
     /// \brief Sets the data array to needed values.
-    BulkSetChannels2250::BulkSetChannels2250() : USBTransferBuffer(4) {
+    BulkSetChannels2250::BulkSetChannels2250() {
         this->init();
     }
 
     /// \brief Sets the used channels.
     /// \param usedChannels The UsedChannels value.
-    BulkSetChannels2250::BulkSetChannels2250(uint8_t usedChannels) : USBTransferBuffer(4) {
+    BulkSetChannels2250::BulkSetChannels2250(uint8_t usedChannels) {
         this->init();
 
         this->setUsedChannels(usedChannels);
@@ -409,33 +352,33 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the UsedChannels value
     /// \return The UsedChannels value.
     uint8_t BulkSetChannels2250::getUsedChannels() {
-        return this->array[2];
+        return this->byte<2>();
     }
 
     /// \brief Set the UsedChannels to the given value.
     /// \param value The new UsedChannels value.
     BulkSetChannels2250& BulkSetChannels2250::setUsedChannels(uint8_t value) {
-        this->array[2] = value;
+        this->byte<2>() = value;
         return *this;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetChannels2250::init() {
-        this->array[0] = BULK_BSETCHANNELS;
+        this->byte<0>() = BULK_BSETCHANNELS;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetTrigger2250
     /// \brief Sets the data array to needed values.
-    BulkSetTrigger2250::BulkSetTrigger2250() : USBTransferBuffer(8) {
+    BulkSetTrigger2250::BulkSetTrigger2250() {
         this->init();
     }
 
     /// \brief Sets the used channels.
     /// \param triggerSource The trigger source id (CTriggerBits).
     /// \param triggerSlope The triggerSlope value (CTriggerBits).
-    BulkSetTrigger2250::BulkSetTrigger2250(uint8_t triggerSource, uint8_t triggerSlope) : USBTransferBuffer(8) {
+    BulkSetTrigger2250::BulkSetTrigger2250(uint8_t triggerSource, uint8_t triggerSlope) {
         this->init();
 
         this->setTriggerSource(triggerSource);
@@ -445,46 +388,46 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the triggerSource value in CTriggerBits.
     /// \return The triggerSource value.
     uint8_t BulkSetTrigger2250::getTriggerSource() {
-        return ((CTriggerBits *) &(this->array[2]))->triggerSource;
+        return this->bits<2, CTriggerBits::triggerSource>();
     }
 
     /// \brief Set the triggerSource in CTriggerBits to the given value.
     /// \param value The new triggerSource value.
     BulkSetTrigger2250& BulkSetTrigger2250::setTriggerSource(uint8_t value) {
-        ((CTriggerBits *) &(this->array[2]))->triggerSource = value;
+        this->setBits<2, CTriggerBits::triggerSource>(value);
         return *this;
     }
 
     /// \brief Get the triggerSlope value in CTriggerBits.
     /// \return The triggerSlope value.
     uint8_t BulkSetTrigger2250::getTriggerSlope() {
-        return ((CTriggerBits *) &(this->array[2]))->triggerSlope;
+        return this->bits<2, CTriggerBits::triggerSlope>();
     }
 
     /// \brief Set the triggerSlope in CTriggerBits to the given value.
     /// \param slope The new triggerSlope value.
     BulkSetTrigger2250& BulkSetTrigger2250::setTriggerSlope(uint8_t slope) {
-        ((CTriggerBits *) &(this->array[2]))->triggerSlope = slope;
+        this->setBits<2, CTriggerBits::triggerSlope>(slope);
         return *this;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetTrigger2250::init() {
-        this->array[0] = BULK_CSETTRIGGERORSAMPLERATE;
+        this->byte<0>() = BULK_CSETTRIGGERORSAMPLERATE;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetSamplerate5200
     /// \brief Sets the data array to the default values.
-    BulkSetSamplerate5200::BulkSetSamplerate5200() : USBTransferBuffer(6) {
+    BulkSetSamplerate5200::BulkSetSamplerate5200() {
         this->init();
     }
 
     /// \brief Sets the data bytes to the specified values.
     /// \param samplerateSlow The SamplerateSlow value.
     /// \param samplerateFast The SamplerateFast value.
-    BulkSetSamplerate5200::BulkSetSamplerate5200(uint16_t samplerateSlow, uint8_t samplerateFast) : USBTransferBuffer(6) {
+    BulkSetSamplerate5200::BulkSetSamplerate5200(uint16_t samplerateSlow, uint8_t samplerateFast) {
         this->init();
 
         this->setSamplerateFast(samplerateFast);
@@ -494,44 +437,43 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the SamplerateFast value.
     /// \return The SamplerateFast value.
     uint8_t BulkSetSamplerate5200::getSamplerateFast() {
-        return this->array[4];
+        return this->byte<4>();
     }
 
     /// \brief Set the SamplerateFast to the given value.
     /// \param value The new SamplerateFast value.
     void BulkSetSamplerate5200::setSamplerateFast(uint8_t value) {
-        this->array[4] = value;
+        this->byte<4>() = value;
     }
 
     /// \brief Get the SamplerateSlow value.
     /// \return The SamplerateSlow value.
     uint16_t BulkSetSamplerate5200::getSamplerateSlow() {
-        return (uint16_t) this->array[2] | ((uint16_t) this->array[3] << 8);
+        return this->littleEndian<2, 2>();
     }
 
     /// \brief Set the SamplerateSlow to the given value.
     /// \param samplerate The new SamplerateSlow value.
     void BulkSetSamplerate5200::setSamplerateSlow(uint16_t samplerate) {
-        this->array[2] = (uint8_t) samplerate;
-        this->array[3] = (uint8_t) (samplerate >> 8);
+        this->setLittleEndian<2, 2>(samplerate);
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetSamplerate5200::init() {
-        this->array[0] = BULK_CSETTRIGGERORSAMPLERATE;
+        this->byte<0>() = BULK_CSETTRIGGERORSAMPLERATE;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetBuffer2250
     /// \brief Sets the data array to the default values.
-    BulkSetRecordLength2250::BulkSetRecordLength2250() : USBTransferBuffer(4) {
+    BulkSetRecordLength2250::BulkSetRecordLength2250() {
         this->init();
     }
 
     /// \brief Sets the data bytes to the specified values.
     /// \param recordLength The ::RecordLengthId value.
-    BulkSetRecordLength2250::BulkSetRecordLength2250(uint8_t recordLength) : USBTransferBuffer(4) {
+    BulkSetRecordLength2250::BulkSetRecordLength2250(uint8_t recordLength) {
         this->init();
 
         this->setRecordLength(recordLength);
@@ -540,25 +482,25 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the ::RecordLengthId value.
     /// \return The ::RecordLengthId value.
     uint8_t BulkSetRecordLength2250::getRecordLength() {
-        return this->array[2];
+        return this->byte<2>();
     }
 
     /// \brief Set the ::RecordLengthId to the given value.
     /// \param value The new ::RecordLengthId value.
     void BulkSetRecordLength2250::setRecordLength(uint8_t value) {
-        this->array[2] = value;
+        this->byte<2>() = value;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetRecordLength2250::init() {
-        this->array[0] = BULK_DSETBUFFER;
+        this->byte<0>() = BULK_DSETBUFFER;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetBuffer5200
     /// \brief Sets the data array to the default values.
-    BulkSetBuffer5200::BulkSetBuffer5200() : USBTransferBuffer(10) {
+    BulkSetBuffer5200::BulkSetBuffer5200() {
         this->init();
     }
 
@@ -568,7 +510,7 @@ namespace Hantek2xxx_5xxx {
     /// \param usedPre The TriggerPositionUsedPre value.
     /// \param usedPost The TriggerPositionUsedPost value.
     /// \param recordLength The ::RecordLengthId value.
-    BulkSetBuffer5200::BulkSetBuffer5200(uint16_t triggerPositionPre, uint16_t triggerPositionPost, uint8_t usedPre, uint8_t usedPost, uint8_t recordLength) : USBTransferBuffer(10) {
+    BulkSetBuffer5200::BulkSetBuffer5200(uint16_t triggerPositionPre, uint16_t triggerPositionPost, uint8_t usedPre, uint8_t usedPost, uint8_t recordLength) {
         this->init();
 
         this->setTriggerPositionPre(triggerPositionPre);
@@ -581,77 +523,75 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the TriggerPositionPre value.
     /// \return The TriggerPositionPre value.
     uint16_t BulkSetBuffer5200::getTriggerPositionPre() {
-        return (uint16_t) this->array[2] | ((uint16_t) this->array[3] << 8);
+        return this->littleEndian<2, 2>();
     }
 
     /// \brief Set the TriggerPositionPre to the given value.
     /// \param position The new TriggerPositionPre value.
     void BulkSetBuffer5200::setTriggerPositionPre(uint16_t position) {
-        this->array[2] = (uint8_t) position;
-        this->array[3] = (uint8_t) (position >> 8);
+        this->setLittleEndian<2, 2>(position);
     }
 
     /// \brief Get the TriggerPositionPost value.
     /// \return The TriggerPositionPost value.
     uint16_t BulkSetBuffer5200::getTriggerPositionPost() {
-        return (uint16_t) this->array[6] | ((uint16_t) this->array[7] << 8);
+        return this->littleEndian<6, 2>();
     }
 
     /// \brief Set the TriggerPositionPost to the given value.
     /// \param position The new TriggerPositionPost value.
     void BulkSetBuffer5200::setTriggerPositionPost(uint16_t position) {
-        this->array[6] = (uint8_t) position;
-        this->array[7] = (uint8_t) (position >> 8);
+        this->setLittleEndian<6, 2>(position);
     }
 
     /// \brief Get the TriggerPositionUsedPre value.
     /// \return The ::DTriggerPositionUsed value for the pre position.
     uint8_t BulkSetBuffer5200::getUsedPre() {
-        return this->array[4];
+        return this->byte<4>();
     }
 
     /// \brief Set the TriggerPositionUsedPre to the given value.
     /// \param value The new ::DTriggerPositionUsed value for the pre position.
     void BulkSetBuffer5200::setUsedPre(uint8_t value) {
-        this->array[4] = value;
+        this->byte<4>() = value;
     }
 
     /// \brief Get the TriggerPositionUsedPost value.
     /// \return The ::DTriggerPositionUsed value for the post position.
     uint8_t BulkSetBuffer5200::getUsedPost() {
-        return ((DBufferBits *) &(this->array[8]))->triggerPositionUsed;
+        return this->bits<8, DBufferBits::triggerPositionUsed>();
     }
 
     /// \brief Set the TriggerPositionUsedPost to the given value.
     /// \param value The new ::DTriggerPositionUsed value for the post position.
     void BulkSetBuffer5200::setUsedPost(uint8_t value) {
-        ((DBufferBits *) &(this->array[8]))->triggerPositionUsed = value;
+        this->setBits<8, DBufferBits::triggerPositionUsed>(value);
     }
 
     /// \brief Get the recordLength value in DBufferBits.
     /// \return The ::RecordLengthId value.
     uint8_t BulkSetBuffer5200::getRecordLength() {
-        return ((DBufferBits *) &(this->array[8]))->recordLength;
+        return this->bits<8, DBufferBits::recordLength>();
     }
 
     /// \brief Set the recordLength in DBufferBits to the given value.
     /// \param value The new ::RecordLengthId value.
     void BulkSetBuffer5200::setRecordLength(uint8_t value) {
-        ((DBufferBits *) &(this->array[8]))->recordLength = value;
+        this->setBits<8, DBufferBits::recordLength>(value);
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetBuffer5200::init() {
-        this->array[0] = BULK_DSETBUFFER;
-        this->array[5] = 0xff;
-        this->array[9] = 0xff;
+        this->byte<0>() = BULK_DSETBUFFER;
+        this->byte<5>() = 0xff;
+        this->byte<9>() = 0xff;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetSamplerate2250
     /// \brief Sets the data array to the default values.
-    BulkSetSamplerate2250::BulkSetSamplerate2250() : USBTransferBuffer(8) {
+    BulkSetSamplerate2250::BulkSetSamplerate2250() {
         this->init();
     }
 
@@ -659,7 +599,7 @@ namespace Hantek2xxx_5xxx {
     /// \param fastRate The fastRate state (ESamplerateBits).
     /// \param downsampling The downsampling state (ESamplerateBits).
     /// \param samplerate The Samplerate value.
-    BulkSetSamplerate2250::BulkSetSamplerate2250(bool fastRate, bool downsampling, uint16_t samplerate) : USBTransferBuffer(8) {
+    BulkSetSamplerate2250::BulkSetSamplerate2250(bool fastRate, bool downsampling, uint16_t samplerate) {
         this->init();
 
         this->setFastRate(fastRate);
@@ -670,50 +610,49 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the fastRate state in ESamplerateBits.
     /// \return The fastRate state.
     bool BulkSetSamplerate2250::getFastRate() {
-        return ((ESamplerateBits *) &(this->array[2]))->fastRate == 1;
+        return this->bits<2, ESamplerateBits::fastRate>() == 1;
     }
 
     /// \brief Set the fastRate in ESamplerateBits to the given state.
     /// \param fastRate The new fastRate state.
     void BulkSetSamplerate2250::setFastRate(bool fastRate) {
-        ((ESamplerateBits *) &(this->array[2]))->fastRate = fastRate ? 1 : 0;
+        this->setBits<2, ESamplerateBits::fastRate>(fastRate ? 1 : 0);
     }
 
     /// \brief Get the downsampling state in ESamplerateBits.
     /// \return The downsampling state.
     bool BulkSetSamplerate2250::getDownsampling() {
-        return ((ESamplerateBits *) &(this->array[2]))->downsampling == 1;
+        return this->bits<2, ESamplerateBits::downsampling>() == 1;
     }
 
     /// \brief Set the downsampling in ESamplerateBits to the given state.
     /// \param downsampling The new downsampling state.
     void BulkSetSamplerate2250::setDownsampling(bool downsampling) {
-        ((ESamplerateBits *) &(this->array[2]))->downsampling = downsampling ? 1 : 0;
+        this->setBits<2, ESamplerateBits::downsampling>(downsampling ? 1 : 0);
     }
 
     /// \brief Get the Samplerate value.
     /// \return The Samplerate value.
     uint16_t BulkSetSamplerate2250::getSamplerate() {
-        return (uint16_t) this->array[4] | ((uint16_t) this->array[5] << 8);
+        return this->littleEndian<4, 2>();
     }
 
     /// \brief Set the Samplerate to the given value.
     /// \param samplerate The new Samplerate value.
     void BulkSetSamplerate2250::setSamplerate(uint16_t samplerate) {
-        this->array[4] = (uint8_t) samplerate;
-        this->array[5] = (uint8_t) (samplerate >> 8);
+        this->setLittleEndian<4, 2>(samplerate);
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetSamplerate2250::init() {
-        this->array[0] = BULK_ESETTRIGGERORSAMPLERATE;
+        this->byte<0>() = BULK_ESETTRIGGERORSAMPLERATE;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class BulkSetTrigger5200
     /// \brief Sets the data array to the default values.
-    BulkSetTrigger5200::BulkSetTrigger5200() : USBTransferBuffer(8) {
+    BulkSetTrigger5200::BulkSetTrigger5200() {
         this->init();
     }
 
@@ -723,7 +662,7 @@ namespace Hantek2xxx_5xxx {
     /// \param fastRate The fastRate state.
     /// \param triggerSlope The triggerSlope value.
     /// \param triggerPulse The triggerPulse value.
-    BulkSetTrigger5200::BulkSetTrigger5200(uint8_t triggerSource, uint8_t usedChannels, bool fastRate, uint8_t triggerSlope, uint8_t triggerPulse) : USBTransferBuffer(8) {
+    BulkSetTrigger5200::BulkSetTrigger5200(uint8_t triggerSource, uint8_t usedChannels, bool fastRate, uint8_t triggerSlope, uint8_t triggerPulse) {
         this->init();
 
         this->setTriggerSource(triggerSource);
@@ -736,72 +675,72 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the triggerSource value in ETsrBits.
     /// \return The ::TriggerSource value.
     uint8_t BulkSetTrigger5200::getTriggerSource() {
-        return ((ETsrBits *) &(this->array[2]))->triggerSource;
+        return this->bits<2, ETsrBits::triggerSource>();
     }
 
     /// \brief Set the triggerSource in ETsrBits to the given value.
     /// \param value The new ::TriggerSource value.
     BulkSetTrigger5200& BulkSetTrigger5200::setTriggerSource(uint8_t value) {
-        ((ETsrBits *) &(this->array[2]))->triggerSource = value;
+        this->setBits<2, ETsrBits::triggerSource>(value);
         return *this;
     }
 
     /// \brief Get the usedChannels value in ETsrBits.
     /// \return The ::UsedChannels value.
     uint8_t BulkSetTrigger5200::getUsedChannels() {
-        return ((ETsrBits *) &(this->array[2]))->usedChannels;
+        return this->bits<2, ETsrBits::usedChannels>();
     }
 
     /// \brief Set the usedChannels in ETsrBits to the given value.
     /// \param value The new ::UsedChannels value.
     BulkSetTrigger5200& BulkSetTrigger5200::setUsedChannels(uint8_t value) {
-        ((ETsrBits *) &(this->array[2]))->usedChannels = value;
+        this->setBits<2, ETsrBits::usedChannels>(value);
         return *this;
     }
 
     /// \brief Get the fastRate state in ETsrBits.
     /// \return The fastRate state (Already inverted).
     bool BulkSetTrigger5200::getFastRate() {
-        return ((ETsrBits *) &(this->array[2]))->fastRate == 0;
+        return this->bits<2, ETsrBits::fastRate>() == 0;
     }
 
     /// \brief Set the fastRate in ETsrBits to the given state.
     /// \param fastRate The new fastRate state (Automatically inverted).
     BulkSetTrigger5200& BulkSetTrigger5200::setFastRate(bool fastRate) {
-        ((ETsrBits *) &(this->array[2]))->fastRate = fastRate ? 0 : 1;
+        this->setBits<2, ETsrBits::fastRate>(fastRate ? 0 : 1);
         return *this;
     }
 
     /// \brief Get the triggerSlope value in ETsrBits.
     /// \return The triggerSlope value.
     uint8_t BulkSetTrigger5200::getTriggerSlope() {
-        return ((ETsrBits *) &(this->array[2]))->triggerSlope;
+        return this->bits<2, ETsrBits::triggerSlope>();
     }
 
     /// \brief Set the triggerSlope in ETsrBits to the given value.
     /// \param slope The new triggerSlope value.
     BulkSetTrigger5200& BulkSetTrigger5200::setTriggerSlope(uint8_t slope) {
-        ((ETsrBits *) &(this->array[2]))->triggerSlope = slope;
+        this->setBits<2, ETsrBits::triggerSlope>(slope);
         return *this;
     }
 
     /// \brief Get the triggerPulse state in ETsrBits.
     /// \return The triggerPulse state.
     bool BulkSetTrigger5200::getTriggerPulse() {
-        return ((ETsrBits *) &(this->array[2]))->triggerPulse == 1;
+        return this->bits<2, ETsrBits::triggerPulse>() == 1;
     }
 
     /// \brief Set the triggerPulse in ETsrBits to the given state.
     /// \param pulse The new triggerPulse state.
     BulkSetTrigger5200& BulkSetTrigger5200::setTriggerPulse(bool pulse) {
-        ((ETsrBits *) &(this->array[2]))->triggerPulse = pulse ? 1 : 0;
+        this->setBits<2, ETsrBits::triggerPulse>(pulse ? 1 : 0);
         return *this;
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetTrigger5200::init() {
-        this->array[0] = BULK_ESETTRIGGERORSAMPLERATE;
-        this->array[4] = 0x02;
+        this->byte<0>() = BULK_ESETTRIGGERORSAMPLERATE;
+        this->byte<4>() = 0x02;
     }
 
 
@@ -809,14 +748,14 @@ namespace Hantek2xxx_5xxx {
     ///
     /// \brief The DSO-2250 BULK_FSETBUFFER builder.
     /// \brief Sets the data array to the default values.
-    BulkSetBuffer2250::BulkSetBuffer2250() : USBTransferBuffer(10) {
+    BulkSetBuffer2250::BulkSetBuffer2250() {
         this->init();
     }
 
     /// \brief Sets the data bytes to the specified values.
     /// \param triggerPositionPre The TriggerPositionPre value.
     /// \param triggerPositionPost The TriggerPositionPost value.
-    BulkSetBuffer2250::BulkSetBuffer2250(uint32_t triggerPositionPre, uint32_t triggerPositionPost) : USBTransferBuffer(12) {
+    BulkSetBuffer2250::BulkSetBuffer2250(uint32_t triggerPositionPre, uint32_t triggerPositionPost) {
         this->init();
 
         this->setTriggerPositionPre(triggerPositionPre);
@@ -826,41 +765,37 @@ namespace Hantek2xxx_5xxx {
     /// \brief Get the TriggerPositionPost value.
     /// \return The TriggerPositionPost value.
     uint32_t BulkSetBuffer2250::getTriggerPositionPost() {
-        return (uint32_t) this->array[2] | ((uint32_t) this->array[3] << 8) | ((uint32_t) this->array[4] << 16);
+        return this->littleEndian<2, 3>();
     }
 
     /// \brief Set the TriggerPositionPost to the given value.
     /// \param position The new TriggerPositionPost value.
     void BulkSetBuffer2250::setTriggerPositionPost(uint32_t position) {
-        this->array[2] = (uint8_t) position;
-        this->array[3] = (uint8_t) (position >> 8);
-        this->array[4] = (uint8_t) (position >> 16);
+        this->setLittleEndian<2, 3>(position);
     }
 
     /// \brief Get the TriggerPositionPre value.
     /// \return The TriggerPositionPre value.
     uint32_t BulkSetBuffer2250::getTriggerPositionPre() {
-        return (uint32_t) this->array[6] | ((uint16_t) this->array[7] << 8) | ((uint16_t) this->array[8] << 16);
+        return this->littleEndian<6, 3>();
     }
 
     /// \brief Set the TriggerPositionPre to the given value.
     /// \param position The new TriggerPositionPre value.
     void BulkSetBuffer2250::setTriggerPositionPre(uint32_t position) {
-        this->array[6] = (uint8_t) position;
-        this->array[7] = (uint8_t) (position >> 8);
-        this->array[8] = (uint8_t) (position >> 16);
+        this->setLittleEndian<6, 3>(position);
     }
 
     /// \brief Initialize the array to the needed values.
     void BulkSetBuffer2250::init() {
-        this->array[0] = BULK_FSETBUFFER;
+        this->byte<0>() = BULK_FSETBUFFER;
     }
 
     //////////////////////////////////////////////////////////////////////////////
     // class ControlBeginCommand
     /// \brief Sets the command index to the given value.
     /// \param index The CommandIndex for the command.
-    ControlBeginCommand::ControlBeginCommand(ControlBeginCommand::BulkIndex index) : USBTransferBuffer(10, CONTROL_BEGINCOMMAND) {
+    ControlBeginCommand::ControlBeginCommand(ControlBeginCommand::BulkIndex index) : FixedTransferBuffer(CONTROL_BEGINCOMMAND) {
         this->init();
 
         this->setIndex(index);
@@ -869,33 +804,32 @@ namespace Hantek2xxx_5xxx {
     /// \brief Gets the command index.
     /// \return The CommandIndex for the command.
     ControlBeginCommand::BulkIndex ControlBeginCommand::getIndex() {
-        return (BulkIndex) this->array[1];
+        return (BulkIndex) this->byte<1>();
     }
 
     /// \brief Sets the command index to the given value.
     /// \param index The new CommandIndex for the command.
     void ControlBeginCommand::setIndex(BulkIndex index) {
-        memset(&(this->array[1]), (uint8_t) index, 3);
+        this->byte<1>() = this->byte<2>() = this->byte<3>() = (uint8_t) index;
     }
 
     /// \brief Initialize the array to the needed values.
     void ControlBeginCommand::init() {
-        this->array[0] = 0x0f;
+        this->byte<0>() = 0x0f;
     }
 
 
     //////////////////////////////////////////////////////////////////////////////
     // class ControlSetOffset
     /// \brief Sets the data array to the default values.
-    ControlSetOffset::ControlSetOffset() : USBTransferBuffer(17, CONTROL_SETOFFSET) {
+    ControlSetOffset::ControlSetOffset() : FixedTransferBuffer(CONTROL_SETOFFSET) {
     }
 
     /// \brief Sets the offsets to the given values.
     /// \param channel1 The offset for channel 1.
     /// \param channel2 The offset for channel 2.
     /// \param trigger The offset for ext. trigger.
-    ControlSetOffset::ControlSetOffset(uint16_t channel1, uint16_t channel2, uint16_t trigger) :
-        USBTransferBuffer(17, CONTROL_SETOFFSET) {
+    ControlSetOffset::ControlSetOffset(uint16_t channel1, uint16_t channel2, uint16_t trigger) : FixedTransferBuffer(CONTROL_SETOFFSET) {
         this->setChannel(0, channel1);
         this->setChannel(1, channel2);
         this->setTrigger(trigger);
@@ -906,37 +840,32 @@ namespace Hantek2xxx_5xxx {
     /// \return The channel offset value.
     uint16_t ControlSetOffset::getChannel(unsigned int channel) {
         if(channel == 0)
-            return ((this->array[0] & 0x0f) << 8) | this->array[1];
+            return this->bigEndian<0, 2>() & 0x0fff;
         else
-            return ((this->array[2] & 0x0f) << 8) | this->array[3];
+            return this->bigEndian<2, 2>() & 0x0fff;
     }
 
     /// \brief Set the offset for the given channel.
     /// \param channel The channel that should be set.
     /// \param offset The new channel offset value.
     ControlSetOffset& ControlSetOffset::setChannel(unsigned int channel, uint16_t offset) {
-        if(channel == 0) {
-            this->array[0] = (uint8_t) (offset >> 8);
-            this->array[1] = (uint8_t) offset;
-        }
-        else {
-            this->array[2] = (uint8_t) (offset >> 8);
-            this->array[3] = (uint8_t) offset;
-        }
+        if(channel == 0)
+            this->setBigEndian<0, 2>(offset);
+        else
+            this->setBigEndian<2, 2>(offset);
         return *this;
     }
 
     /// \brief Get the trigger level.
     /// \return The trigger level value.
     uint16_t ControlSetOffset::getTrigger() {
-        return ((this->array[4] & 0x0f) << 8) | this->array[5];
+        return this->bigEndian<4, 2>() & 0x0fff;
     }
 
     /// \brief Set the trigger level.
     /// \param level The new trigger level value.
     ControlSetOffset& ControlSetOffset::setTrigger(uint16_t level) {
-        this->array[4] = (uint8_t) (level >> 8);
-        this->array[5] = (uint8_t) level;
+        this->setBigEndian<4, 2>(level);
         return *this;
     }
 
@@ -953,7 +882,7 @@ namespace Hantek2xxx_5xxx {
     /// \param triggerExt Sets the state of the external trigger relay.
     ControlSetRelays::ControlSetRelays(bool ch1Below1V, bool ch1Below100mV, bool ch1CouplingDC,
                                        bool ch2Below1V, bool ch2Below100mV, bool ch2CouplingDC,
-                                       bool triggerExt) : USBTransferBuffer(17, CONTROL_BEGINCOMMAND) {
+                                       bool triggerExt) : FixedTransferBuffer(CONTROL_SETRELAYS) {
         this->setBelow1V(0, ch1Below1V);
         this->setBelow100mV(0, ch1Below100mV);
         this->setCoupling(0, ch1CouplingDC);
@@ -968,9 +897,9 @@ namespace Hantek2xxx_5xxx {
     /// \return true, if the gain of the channel is below 1 V.
     bool ControlSetRelays::getBelow1V(unsigned int channel) {
         if(channel == 0)
-            return (this->array[1] & 0x04) == 0x00;
+            return (this->byte<1>() & 0x04) == 0x00;
         else
-            return (this->array[4] & 0x20) == 0x00;
+            return (this->byte<4>() & 0x20) == 0x00;
     }
 
     /// \brief Set the below 1 V relay for the given channel.
@@ -978,9 +907,9 @@ namespace Hantek2xxx_5xxx {
     /// \param below true, if the gain of the channel should be below 1 V.
     ControlSetRelays& ControlSetRelays::setBelow1V(unsigned int channel, bool below) {
         if(channel == 0)
-            this->array[1] = below ? 0xfb : 0x04;
+            this->byte<1>() = below ? 0xfb : 0x04;
         else
-            this->array[4] = below ? 0xdf : 0x20;
+            this->byte<4>() = below ? 0xdf : 0x20;
         return *this;
     }
 
@@ -989,9 +918,9 @@ namespace Hantek2xxx_5xxx {
     /// \return true, if the gain of the channel is below 1 V.
     bool ControlSetRelays::getBelow100mV(unsigned int channel) {
         if(channel == 0)
-            return (this->array[2] & 0x08) == 0x00;
+            return (this->byte<2>() & 0x08) == 0x00;
         else
-            return (this->array[5] & 0x40) == 0x00;
+            return (this->byte<5>() & 0x40) == 0x00;
     }
 
     /// \brief Set the below 100 mV relay for the given channel.
@@ -999,9 +928,9 @@ namespace Hantek2xxx_5xxx {
     /// \param below true, if the gain of the channel should be below 100 mV.
     ControlSetRelays& ControlSetRelays::setBelow100mV(unsigned int channel, bool below) {
         if(channel == 0)
-            this->array[2] = below ? 0xf7 : 0x08;
+            this->byte<2>() = below ? 0xf7 : 0x08;
         else
-            this->array[5] = below ? 0xbf : 0x40;
+            this->byte<5>() = below ? 0xbf : 0x40;
         return *this;
     }
 
@@ -1010,9 +939,9 @@ namespace Hantek2xxx_5xxx {
     /// \return true, if the coupling of the channel is DC.
     bool ControlSetRelays::getCoupling(unsigned int channel) {
         if(channel == 0)
-            return (this->array[3] & 0x02) == 0x00;
+            return (this->byte<3>() & 0x02) == 0x00;
         else
-            return (this->array[6] & 0x10) == 0x00;
+            return (this->byte<6>() & 0x10) == 0x00;
     }
 
     /// \brief Set the coupling relay for the given channel.
@@ -1020,22 +949,22 @@ namespace Hantek2xxx_5xxx {
     /// \param dc true, if the coupling of the channel should be DC.
     ControlSetRelays& ControlSetRelays::setCoupling(unsigned int channel, bool dc) {
         if(channel == 0)
-            this->array[3] = dc ? 0xfd : 0x02;
+            this->byte<3>() = dc ? 0xfd : 0x02;
         else
-            this->array[6] = dc ? 0xef : 0x10;
+            this->byte<6>() = dc ? 0xef : 0x10;
         return *this;
     }
 
     /// \brief Get the external trigger relay state.
     /// \return true, if the trigger is external (EXT-Connector).
     bool ControlSetRelays::getTrigger() {
-        return (this->array[7] & 0x01) == 0x00;
+        return (this->byte<7>() & 0x01) == 0x00;
     }
 
     /// \brief Set the external trigger relay.
     /// \param ext true, if the trigger should be external (EXT-Connector).
     ControlSetRelays& ControlSetRelays::setTrigger(bool ext) {
-        this->array[7] = ext ? 0xfe : 0x01;
+        this->byte<7>() = ext ? 0xfe : 0x01;
         return *this;
     }
 }
@@ -83,76 +83,70 @@ namespace Hantek2xxx_5xxx {
     /// \struct FilterBits
     /// \brief The bits for BULK_SETFILTER.
     struct FilterBits {
-        uint8_t channel1:1; ///< Set to true when channel 1 isn't used
-        uint8_t channel2:1; ///< Set to true when channel 2 isn't used
-        uint8_t trigger:1; ///< Set to true when trigger isn't used
-        uint8_t reserved:5; ///< Unused bits
+        typedef BitField<0, 1> channel1; ///< Set to true when channel 1 isn't used
+        typedef BitField<1, 1> channel2; ///< Set to true when channel 2 isn't used
+        typedef BitField<2, 1> trigger; ///< Set to true when trigger isn't used
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct GainBits
     /// \brief The gain bits for BULK_SETGAIN.
     struct GainBits {
-        uint8_t channel1:2; ///< Gain for CH1, 0 = 1e* V, 1 = 2e*, 2 = 5e*
-        uint8_t channel2:2; ///< Gain for CH1, 0 = 1e* V, 1 = 2e*, 2 = 5e*
-        uint8_t reserved:4; ///< Unused bits
+        typedef BitField<0, 2> channel1; ///< Gain for CH1, 0 = 1e* V, 1 = 2e*, 2 = 5e*
+        typedef BitField<2, 2> channel2; ///< Gain for CH1, 0 = 1e* V, 1 = 2e*, 2 = 5e*
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct Tsr1Bits
     /// \brief Trigger and samplerate bits (Byte 1).
     struct Tsr1Bits {
-        uint8_t triggerSource:2; ///< The trigger source, see Hantek::TriggerSource
-        uint8_t recordLength:3; ///< See ::RecordLengthId
-        uint8_t samplerateId:2; ///< Samplerate ID when downsampler is disabled
-        uint8_t downsamplingMode:1; ///< true, if Downsampler is used
+        typedef BitField<0, 2> triggerSource; ///< The trigger source, see Hantek::TriggerSource
+        typedef BitField<2, 3> recordLength; ///< See ::RecordLengthId
+        typedef BitField<5, 2> samplerateId; ///< Samplerate ID when downsampler is disabled
+        typedef BitField<7, 1> downsamplingMode; ///< true, if Downsampler is used
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct Tsr2Bits
     /// \brief Trigger and samplerate bits (Byte 2).
     struct Tsr2Bits {
-        uint8_t usedChannels:2; ///< Used channels, see Hantek::UsedChannels
-        uint8_t fastRate:1; ///< true, if one channels uses all buffers
-        uint8_t triggerSlope:1; ///< The trigger slope, see Dso::Slope, inverted when Tsr1Bits.samplerateFast is uneven
-        uint8_t reserved:4; ///< Unused bits
+        typedef BitField<0, 2> usedChannels; ///< Used channels, see Hantek::UsedChannels
+        typedef BitField<2, 1> fastRate; ///< true, if one channels uses all buffers
+        typedef BitField<3, 1> triggerSlope; ///< The trigger slope, see Dso::Slope, inverted when Tsr1Bits.samplerateFast is uneven
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct CTriggerBits
     /// \brief Trigger bits for 0x0c command.
     struct CTriggerBits {
-        uint8_t triggerSource:2; ///< The trigger source, see Hantek::TriggerSource
-        uint8_t triggerSlope:1; ///< The trigger slope, see Dso::Slope
-        uint8_t reserved:5; ///< Unused bits
+        typedef BitField<0, 2> triggerSource; ///< The trigger source, see Hantek::TriggerSource
+        typedef BitField<2, 1> triggerSlope; ///< The trigger slope, see Dso::Slope
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct DBufferBits
     /// \brief Buffer mode bits for 0x0d command.
     struct DBufferBits {
-        uint8_t triggerPositionUsed:3; ///< See ::DTriggerPositionUsed
-        uint8_t recordLength:3; ///< See ::RecordLengthId
-        uint8_t reserved:2; ///< Unused bits
+        typedef BitField<0, 3> triggerPositionUsed; ///< See ::DTriggerPositionUsed
+        typedef BitField<3, 3> recordLength; ///< See ::RecordLengthId
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct ESamplerateBits
     /// \brief Samplerate bits for DSO-2250 0x0e command.
     struct ESamplerateBits {
-        uint8_t fastRate:1; ///< false, if one channels uses all buffers
-        uint8_t downsampling:1; ///< true, if the downsampler is activated
-        uint8_t reserved:4; ///< Unused bits
+        typedef BitField<0, 1> fastRate; ///< false, if one channels uses all buffers
+        typedef BitField<1, 1> downsampling; ///< true, if the downsampler is activated
     };
 
     //////////////////////////////////////////////////////////////////////////////
     /// \struct ETsrBits
     /// \brief Trigger and samplerate bits for DSO-5200/DSO-5200A 0x0e command.
     struct ETsrBits {
-        uint8_t fastRate:1; ///< false, if one channels uses all buffers
-        uint8_t usedChannels:2; ///< Used channels, see Hantek::UsedChannels
-        uint8_t triggerSource:2; ///< The trigger source, see Hantek::TriggerSource
-        uint8_t triggerSlope:2; ///< The trigger slope, see Dso::Slope
-        uint8_t triggerPulse:1; ///< Pulses are causing trigger events
+        typedef BitField<0, 1> fastRate; ///< false, if one channels uses all buffers
+        typedef BitField<1, 2> usedChannels; ///< Used channels, see Hantek::UsedChannels
+        typedef BitField<3, 2> triggerSource; ///< The trigger source, see Hantek::TriggerSource
+        typedef BitField<5, 2> triggerSlope; ///< The trigger slope, see Dso::Slope
+        typedef BitField<7, 1> triggerPulse; ///< Pulses are causing trigger events
     };
 }
@@ -433,10 +433,27 @@ namespace Hantek2xxx_5xxx {
         BULK_COUNT
     };
 
+    //////////////////////////////////////////////////////////////////////////////
+    ///
+    /// \brief The builder of the commands without parameters, only the BulkCode is sent.
+    template<BulkCode Code>
+    class BulkCommand : public FixedTransferBuffer<2>, public BulkUSB {
+        public:
+            BulkCommand() {
+                byte<0>() = Code;
+            }
+    };
+    typedef BulkCommand<BULK_FORCETRIGGER> BulkForceTrigger;
+    typedef BulkCommand<BULK_STARTSAMPLING> BulkCaptureStart;
+    typedef BulkCommand<BULK_ENABLETRIGGER> BulkTriggerEnabled;
+    typedef BulkCommand<BULK_GETDATA> BulkGetData;
+    typedef BulkCommand<BULK_GETCAPTURESTATE> BulkGetCaptureState;
+    typedef BulkCommand<BULK_GETLOGICALDATA> BulkGetLogicalData;
+
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The BULK_SETFILTER builder.
-    class BulkSetFilter : public USBTransferBuffer, public BulkUSB {
+    class BulkSetFilter : public FixedTransferBuffer<8>, public BulkUSB {
         public:
             BulkSetFilter();
             BulkSetFilter(bool channel1, bool channel2, bool trigger);
@@ -453,7 +470,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The BULK_SETTRIGGERANDSAMPLERATE builder.
-    class BulkSetTriggerAndSamplerate : public USBTransferBuffer, public BulkUSB {
+    class BulkSetTriggerAndSamplerate : public FixedTransferBuffer<12>, public BulkUSB {
         public:
             BulkSetTriggerAndSamplerate();
             BulkSetTriggerAndSamplerate(uint16_t downsampler, uint32_t triggerPosition, uint8_t triggerSource = 0, uint8_t recordLength = 0, uint8_t samplerateId = 0, bool downsamplingMode = true, uint8_t usedChannels = 0, bool fastRate = false, uint8_t triggerSlope = 0);
@@ -481,46 +498,6 @@ namespace Hantek2xxx_5xxx {
             void init();
     };
 
-    //////////////////////////////////////////////////////////////////////////////
-    ///
-    /// \brief The BULK_FORCETRIGGER builder.
-    class BulkForceTrigger : public USBTransferBuffer, public BulkUSB {
-        public:
-            BulkForceTrigger();
-    };
-
-    //////////////////////////////////////////////////////////////////////////////
-    ///
-    /// \brief The BULK_CAPTURESTART builder.
-    class BulkCaptureStart : public USBTransferBuffer, public BulkUSB {
-        public:
-            BulkCaptureStart();
-    };
-
-    //////////////////////////////////////////////////////////////////////////////
-    ///
-    /// \brief The BULK_TRIGGERENABLED builder.
-    class BulkTriggerEnabled : public USBTransferBuffer, public BulkUSB {
-        public:
-            BulkTriggerEnabled();
-    };
-
-    //////////////////////////////////////////////////////////////////////////////
-    ///
-    /// \brief The BULK_GETDATA builder.
-    class BulkGetData : public USBTransferBuffer, public BulkUSB {
-        public:
-            BulkGetData();
-    };
-
-    //////////////////////////////////////////////////////////////////////////////
-    ///
-    /// \brief The BULK_GETCAPTURESTATE builder.
-    class BulkGetCaptureState : public USBTransferBuffer, public BulkUSB {
-        public:
-            BulkGetCaptureState();
-    };
-
     //////////////////////////////////////////////////////////////////////////////
     /// \enum CaptureState
     /// \brief The different capture states which the oscilloscope returns.
@@ -536,7 +513,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The parser for the BULK_GETCAPTURESTATE response.
-    class BulkResponseGetCaptureState : public USBTransferBuffer, public BulkUSB {
+    class BulkResponseGetCaptureState : public FixedTransferBuffer<512>, public BulkUSB {
         public:
             BulkResponseGetCaptureState();
 
@@ -547,7 +524,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The BULK_SETGAIN builder.
-    class BulkSetGain : public USBTransferBuffer, public BulkUSB {
+    class BulkSetGain : public FixedTransferBuffer<8>, public BulkUSB {
         public:
             BulkSetGain();
             BulkSetGain(uint8_t channel1, uint8_t channel2);
@@ -562,7 +539,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The BULK_SETLOGICALDATA builder.
-    class BulkSetLogicalData : public USBTransferBuffer, public BulkUSB {
+    class BulkSetLogicalData : public FixedTransferBuffer<8>, public BulkUSB {
         public:
             BulkSetLogicalData();
             BulkSetLogicalData(uint8_t data);
@@ -574,18 +551,10 @@ namespace Hantek2xxx_5xxx {
             void init();
     };
 
-    //////////////////////////////////////////////////////////////////////////////
-    ///
-    /// \brief The BULK_GETLOGICALDATA builder.
-    class BulkGetLogicalData : public USBTransferBuffer, public BulkUSB {
-        public:
-            BulkGetLogicalData();
-    };
-
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-2250 BULK_BSETFILTER builder.
-    class BulkSetChannels2250 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetChannels2250 : public FixedTransferBuffer<4>, public BulkUSB {
         public:
             BulkSetChannels2250();
             BulkSetChannels2250(uint8_t usedChannels);
@@ -600,7 +569,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-2250 BULK_CSETTRIGGERORSAMPLERATE builder.
-    class BulkSetTrigger2250 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetTrigger2250 : public FixedTransferBuffer<8>, public BulkUSB {
         public:
             BulkSetTrigger2250();
             BulkSetTrigger2250(uint8_t triggerSource, uint8_t triggerSlope);
@@ -617,7 +586,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-5200/DSO-5200A BULK_CSETTRIGGERORSAMPLERATE builder.
-    class BulkSetSamplerate5200 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetSamplerate5200 : public FixedTransferBuffer<6>, public BulkUSB {
         public:
             BulkSetSamplerate5200();
             BulkSetSamplerate5200(uint16_t samplerateSlow, uint8_t samplerateFast);
@@ -634,7 +603,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-2250 BULK_DSETBUFFER builder.
-    class BulkSetRecordLength2250 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetRecordLength2250 : public FixedTransferBuffer<4>, public BulkUSB {
         public:
             BulkSetRecordLength2250();
             BulkSetRecordLength2250(uint8_t recordLength);
@@ -649,7 +618,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-5200/DSO-5200A BULK_DSETBUFFER builder.
-    class BulkSetBuffer5200 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetBuffer5200 : public FixedTransferBuffer<10>, public BulkUSB {
         public:
             BulkSetBuffer5200();
             BulkSetBuffer5200(uint16_t triggerPositionPre, uint16_t triggerPositionPost, uint8_t usedPre = 0, uint8_t usedPost = 0, uint8_t recordLength = 0);
@@ -672,7 +641,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-2250 BULK_ESETTRIGGERORSAMPLERATE builder.
-    class BulkSetSamplerate2250 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetSamplerate2250 : public FixedTransferBuffer<8>, public BulkUSB {
         public:
             BulkSetSamplerate2250();
             BulkSetSamplerate2250(bool fastRate, bool downsampling = false, uint16_t samplerate = 0);
@@ -691,7 +660,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-5200/DSO-5200A BULK_ESETTRIGGERORSAMPLERATE builder.
-    class BulkSetTrigger5200 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetTrigger5200 : public FixedTransferBuffer<8>, public BulkUSB {
         public:
             BulkSetTrigger5200();
             BulkSetTrigger5200(uint8_t triggerSource, uint8_t usedChannels, bool fastRate = false, uint8_t triggerSlope = 0, uint8_t triggerPulse = 0);
@@ -714,7 +683,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The DSO-2250 BULK_FSETBUFFER builder.
-    class BulkSetBuffer2250 : public USBTransferBuffer, public BulkUSB {
+    class BulkSetBuffer2250 : public FixedTransferBuffer<12>, public BulkUSB {
         public:
             BulkSetBuffer2250();
             BulkSetBuffer2250(uint32_t triggerPositionPre, uint32_t triggerPositionPost);
@@ -168,7 +168,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The CONTROL_BEGINCOMMAND builder.
-    class ControlBeginCommand : public USBTransferBuffer, public ControlUSB {
+    class ControlBeginCommand : public FixedTransferBuffer<10>, public ControlUSB {
         public:
             //////////////////////////////////////////////////////////////////////////////
             /// \enum BulkIndex
@@ -193,7 +193,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The CONTROL_SETOFFSET builder.
-    class ControlSetOffset : public USBTransferBuffer, public ControlUSB {
+    class ControlSetOffset : public FixedTransferBuffer<17>, public ControlUSB {
         public:
             ControlSetOffset();
             ControlSetOffset(uint16_t channel1, uint16_t channel2, uint16_t trigger);
@@ -210,7 +210,7 @@ namespace Hantek2xxx_5xxx {
     //////////////////////////////////////////////////////////////////////////////
     ///
     /// \brief The CONTROL_SETRELAYS builder.
-    class ControlSetRelays : public USBTransferBuffer, public ControlUSB {
+    class ControlSetRelays : public FixedTransferBuffer<17>, public ControlUSB {
         public:
             ControlSetRelays(bool ch1Below1V = false, bool ch1Below100mV = false, bool ch1CouplingDC = false, bool ch2Below1V = false, bool ch2Below100mV = false, bool ch2CouplingDC = false, bool triggerExt = false);
 
@@ -0,0 +1,548 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  usbEmulator.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include <libusb-1.0/libusb.h>
+
+#include "usbEmulator.h"
+#include "dsoSettings.h"
+
+namespace Hantek2xxx_5xxx {
+
+/// The number of gain levels of all models
+#define EMULATOR_GAIN_LEVELS 9
+/// The offset range reported as calibration data, the same for all channels and gain levels
+#define EMULATOR_OFFSET_MIN 0x0100
+#define EMULATOR_OFFSET_MAX 0x0f00
+/// The packet size of a high speed connection
+#define EMULATOR_PACKET_SIZE 512
+
+USBEmulator::USBEmulator(const DSO::DSODeviceDescription& model, uint8_t uniqueID)
+    : USBCommunication(nullptr, model), _uniqueID(uniqueID), _epoch(std::chrono::steady_clock::now()) {
+    _signals[1].frequency = 2e3;
+    _signals[1].amplitude = 0.2;
+}
+
+int USBEmulator::connect() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _connected = true;
+    _commandExpected = false;
+    _captureStarted = false;
+    _dataReady = false;
+    _response.clear();
+    _responseOffset = 0;
+
+    outPacketLength = EMULATOR_PACKET_SIZE;
+    inPacketLength = EMULATOR_PACKET_SIZE;
+    _packetsizeCached = EMULATOR_PACKET_SIZE;
+    return LIBUSB_SUCCESS;
+}
+
+void USBEmulator::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!_connected)
+            return;
+        _connected = false;
+    }
+    // The device may wait for a transfer that needs the lock
+    _disconnected_signal();
+}
+
+bool USBEmulator::isConnected() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _connected;
+}
+
+uint8_t USBEmulator::getUniqueID() {
+    return _uniqueID;
+}
+
+void USBEmulator::setSignal(unsigned channel, const Signal& signal) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(channel < _signals.size())
+        _signals[channel] = signal;
+}
+
+void USBEmulator::setTransferTiming(std::chrono::microseconds latency, double bytesPerSecond) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _latency = latency;
+    _bytesPerSecond = bytesPerSecond;
+}
+
+USBEmulator::Statistics USBEmulator::getStatistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+void USBEmulator::transferDelay(unsigned int length) const {
+    std::chrono::duration<double> delay;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        delay = _latency;
+        if(_bytesPerSecond > 0)
+            delay += std::chrono::duration<double>(length / _bytesPerSecond);
+    }
+    if(delay.count() > 0)
+        std::this_thread::sleep_for(delay);
+}
+
+// The transfers are accounted by the transfer policy like real ones, for its statistics
+int USBEmulator::bulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length, int, unsigned int) {
+    const auto start = std::chrono::steady_clock::now();
+    transferDelay(length);
+    const int result = emulateBulkTransfer(endpoint, data, length);
+    _transferPolicy.record(endpoint, result, 0, std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+int USBEmulator::controlTransfer(unsigned char type, unsigned char request, unsigned char *data, unsigned int length, int value, int) {
+    const auto start = std::chrono::steady_clock::now();
+    transferDelay(length);
+    const int result = emulateControlTransfer(type, request, data, length, value);
+    _transferPolicy.record(type & LIBUSB_ENDPOINT_DIR_MASK, result, 0, std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+int USBEmulator::emulateBulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(!_connected)
+        return LIBUSB_ERROR_NO_DEVICE;
+
+    if(endpoint == _model.bulk_endpoint_out)
+        return bulkCommand(data, length);
+    if(endpoint == _model.bulk_endpoint_in)
+        return bulkResponse(data, length);
+
+    ++_statistics.protocolErrors;
+    return LIBUSB_ERROR_PIPE;
+}
+
+int USBEmulator::emulateControlTransfer(unsigned char type, unsigned char request, unsigned char *data,
+                                        unsigned int length, int value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(!_connected)
+        return LIBUSB_ERROR_NO_DEVICE;
+    ++_statistics.controlTransfers;
+
+    if(type & LIBUSB_ENDPOINT_IN) {
+        memset(data, 0, length);
+        if(request == CONTROL_VALUE && value == VALUE_OFFSETLIMITS) {
+            // channelLevels[channel][GainId][::LevelOffset], big endian
+            const unsigned char limits[4] = {EMULATOR_OFFSET_MIN >> 8, EMULATOR_OFFSET_MIN & 0xff,
+                                             EMULATOR_OFFSET_MAX >> 8, EMULATOR_OFFSET_MAX & 0xff};
+            for(unsigned position = 0; position + sizeof(limits) <= length &&
+                position < 2 * EMULATOR_GAIN_LEVELS * sizeof(limits); position += sizeof(limits))
+                memcpy(data + position, limits, sizeof(limits));
+        }
+        else if(request == CONTROL_VALUE && value == VALUE_DEVICEADDRESS && length)
+            data[0] = _uniqueID;
+        return length;
+    }
+
+    switch(request) {
+        case CONTROL_BEGINCOMMAND:
+            _commandExpected = true;
+            break;
+        case CONTROL_SETOFFSET: {
+            ControlSetOffset command;
+            decode(command, data, length);
+            _offset[0] = command.getChannel(0);
+            _offset[1] = command.getChannel(1);
+            _triggerLevel = command.getTrigger();
+            break;
+        }
+        case CONTROL_SETRELAYS:
+            // The attenuators are not emulated
+            break;
+        default:
+            ++_statistics.protocolErrors;
+            break;
+    }
+    return length;
+}
+
+template<class T>
+void USBEmulator::decode(T& command, const unsigned char *data, unsigned int length) {
+    memcpy(command.data(), data, std::min(length, command.size()));
+}
+
+int USBEmulator::bulkCommand(const unsigned char *data, unsigned int length) {
+    // Every bulk command has to be announced by CONTROL_BEGINCOMMAND
+    if(!_commandExpected || length < 2) {
+        ++_statistics.protocolErrors;
+        return LIBUSB_ERROR_PIPE;
+    }
+    _commandExpected = false;
+    ++_statistics.bulkCommands;
+
+    const time_point now = std::chrono::steady_clock::now();
+    const uint16_t productID = _model.productID;
+    const bool is2090 = productID == 0x2090 || productID == 0x2150;
+    const bool is5200 = productID == 0x5200 || productID == 0x520A;
+
+    switch(data[0]) {
+        case BULK_SETTRIGGERANDSAMPLERATE: {
+            if(!is2090)
+                break;
+            BulkSetTriggerAndSamplerate command;
+            decode(command, data, length);
+            const unsigned ids[] = {0, 1, 2, 5};
+            _downsampler = command.getDownsamplingMode() ? 2 * (0x10001 - command.getDownsampler())
+                                                          : ids[command.getSamplerateId() & 0x03];
+            _recordLengthId = command.getRecordLength();
+            _fastRate = command.getFastRate();
+            _used[0] = command.getUsedChannels() != USED_CH2;
+            _used[1] = command.getUsedChannels() != USED_CH1;
+            _triggerSpecial = command.getTriggerSource() >= TRIGGER_EXT;
+            _triggerChannel = command.getTriggerSource() == TRIGGER_CH2 ? 1 : 0;
+            _triggerFalling = command.getTriggerSlope() == (uint8_t)DSO::Slope::NEGATIVE;
+            _triggerPosition = command.getTriggerPosition();
+            return length;
+        }
+        case BULK_FORCETRIGGER:
+            if(_captureStarted && _triggerTime == time_point::max())
+                _triggerTime = std::max(now, _captureStart + std::chrono::duration_cast<time_point::duration>(
+                                            std::chrono::duration<double>(pretriggerSamples() / samplerate())));
+            return length;
+        case BULK_STARTSAMPLING:
+            ++_statistics.captures;
+            _captureStarted = true;
+            _dataReady = false;
+            _captureStart = now;
+            _triggerEnabled = time_point::max();
+            _triggerTime = time_point::max();
+            return length;
+        case BULK_ENABLETRIGGER:
+            if(_captureStarted && _triggerEnabled == time_point::max())
+                _triggerEnabled = now;
+            return length;
+        case BULK_GETDATA:
+            readSampleData();
+            return length;
+        case BULK_GETCAPTURESTATE: {
+            const CaptureState state = captureState(now);
+            // The start of the data in the ring buffer, each set bit inverts all bits with a lower value
+            const unsigned point = _ringPosition ^ (_ringPosition >> 1);
+            _response.assign(EMULATOR_PACKET_SIZE, 0);
+            _response[0] = (unsigned char)state;
+            _response[1] = (unsigned char)(point >> 16);
+            _response[2] = (unsigned char)point;
+            _response[3] = (unsigned char)(point >> 8);
+            _responseOffset = 0;
+            return length;
+        }
+        case BULK_SETGAIN: {
+            BulkSetGain command;
+            decode(command, data, length);
+            _gainBits[0] = command.getGain(0);
+            _gainBits[1] = command.getGain(1);
+            return length;
+        }
+        case BULK_BSETCHANNELS: {
+            if(productID != 0x2250)
+                break;
+            BulkSetChannels2250 command;
+            decode(command, data, length);
+            _used[0] = command.getUsedChannels() != BUSED_CH2 && command.getUsedChannels() != BUSED_NONE;
+            _used[1] = command.getUsedChannels() == BUSED_CH2 || command.getUsedChannels() == BUSED_CH1CH2;
+            return length;
+        }
+        case BULK_CSETTRIGGERORSAMPLERATE:
+            if(productID == 0x2250) {
+                BulkSetTrigger2250 command;
+                decode(command, data, length);
+                _triggerSpecial = command.getTriggerSource() < 2;
+                _triggerChannel = command.getTriggerSource() == 3 ? 1 : 0;
+                _triggerFalling = command.getTriggerSlope() == (uint8_t)DSO::Slope::NEGATIVE;
+                return length;
+            }
+            if(is5200) {
+                BulkSetSamplerate5200 command;
+                decode(command, data, length);
+                const unsigned slow = command.getSamplerateSlow() ? 0xffff - command.getSamplerateSlow() : 0;
+                _downsampler = slow * 2 + 4 - command.getSamplerateFast();
+                return length;
+            }
+            break;
+        case BULK_DSETBUFFER:
+            if(productID == 0x2250) {
+                BulkSetRecordLength2250 command;
+                decode(command, data, length);
+                _recordLengthId = command.getRecordLength();
+                return length;
+            }
+            if(is5200) {
+                BulkSetBuffer5200 command;
+                decode(command, data, length);
+                _recordLengthId = command.getRecordLength();
+                _triggerPosition = command.getTriggerPositionPre();
+                return length;
+            }
+            break;
+        case BULK_ESETTRIGGERORSAMPLERATE:
+            if(productID == 0x2250) {
+                BulkSetSamplerate2250 command;
+                decode(command, data, length);
+                _fastRate = command.getFastRate();
+                _downsampler = !command.getDownsampling() ? 0 :
+                               command.getSamplerate() ? 0x10001 - command.getSamplerate() : 1;
+                return length;
+            }
+            if(is5200) {
+                BulkSetTrigger5200 command;
+                decode(command, data, length);
+                _fastRate = command.getFastRate();
+                _used[0] = command.getUsedChannels() != USED_CH2;
+                _used[1] = command.getUsedChannels() != USED_CH1;
+                _triggerSpecial = command.getTriggerSource() >= TRIGGER_EXT;
+                _triggerChannel = command.getTriggerSource() == TRIGGER_CH2 ? 1 : 0;
+                _triggerFalling = command.getTriggerSlope() == (uint8_t)DSO::Slope::NEGATIVE;
+                return length;
+            }
+            break;
+        case BULK_FSETBUFFER: {
+            if(productID != 0x2250)
+                break;
+            BulkSetBuffer2250 command;
+            decode(command, data, length);
+            _triggerPosition = command.getTriggerPositionPre();
+            return length;
+        }
+        default:
+            // Accepted, but without effect on the emulation (BULK_SETFILTER, logical data)
+            return length;
+    }
+
+    // A command of another model
+    ++_statistics.protocolErrors;
+    return length;
+}
+
+int USBEmulator::bulkResponse(unsigned char *data, unsigned int length) {
+    if(_responseOffset >= _response.size())
+        return LIBUSB_ERROR_TIMEOUT;
+
+    const unsigned count = std::min(length, (unsigned)_response.size() - _responseOffset);
+    memcpy(data, &_response[_responseOffset], count);
+    _responseOffset += count;
+
+    ++_statistics.bulkReads;
+    _statistics.bytesRead += count;
+    return count;
+}
+
+CaptureState USBEmulator::captureState(time_point now) {
+    const CaptureState ready = _model.productID == 0x2250 ? CaptureState::READY2250 :
+                               (_model.productID == 0x5200 || _model.productID == 0x520A) ? CaptureState::READY5200 :
+                               CaptureState::READY;
+    if(!_captureStarted)
+        return _dataReady ? ready : CaptureState::WAITING;
+
+    // The trigger is armed after it has been enabled and the pretrigger buffer is filled
+    const double rate = samplerate();
+    if(_triggerTime == time_point::max() && _triggerEnabled != time_point::max()) {
+        const time_point armed = std::max(_triggerEnabled, _captureStart + std::chrono::duration_cast<time_point::duration>(
+                                              std::chrono::duration<double>(pretriggerSamples() / rate)));
+        const time_point event = nextTriggerEvent(armed);
+        if(event <= now)
+            _triggerTime = event;
+    }
+    if(_triggerTime == time_point::max())
+        return CaptureState::WAITING;
+
+    const time_point end = _triggerTime + std::chrono::duration_cast<time_point::duration>(
+                std::chrono::duration<double>(((_fastRate ? 2 * recordLength() : recordLength()) - pretriggerSamples()) / rate));
+    if(now < end)
+        return CaptureState::SAMPLING;
+
+    // The hardware keeps writing into its ring buffer, the capture ends anywhere in it
+    _captureStarted = false;
+    _dataReady = true;
+    _ringPosition = (unsigned long long)(signalTime(end) * rate) % recordLength();
+    return ready;
+}
+
+USBEmulator::time_point USBEmulator::nextTriggerEvent(time_point after) const {
+    const Signal& signal = _signals[_triggerSpecial ? 0 : _triggerChannel];
+    if(signal.frequency <= 0)
+        return time_point::max();
+
+    // The phase of the signal at the trigger event
+    double eventPhase;
+    if(_triggerSpecial) {
+        // The external trigger input is driven by a pulse in phase with the signal of channel 1
+        eventPhase = _triggerFalling ? M_PI : 0.0;
+    } else {
+        double level;
+        if(_model.productID == 0x5200 || _model.productID == 0x520A)
+            level = ((double)_triggerLevel - EMULATOR_OFFSET_MIN) / (EMULATOR_OFFSET_MAX - EMULATOR_OFFSET_MIN);
+        else
+            level = _triggerLevel / (double)0xfd;
+        const double offset = ((double)_offset[_triggerChannel] - EMULATOR_OFFSET_MIN) / (EMULATOR_OFFSET_MAX - EMULATOR_OFFSET_MIN);
+        const double ratio = (level - offset) / signal.amplitude;
+        if(signal.amplitude <= 0 || std::abs(ratio) >= 1.0)
+            return time_point::max();
+        eventPhase = _triggerFalling ? M_PI - std::asin(ratio) : std::asin(ratio);
+    }
+
+    const double phase = 2 * M_PI * signal.frequency * signalTime(after) + signal.phase;
+    double difference = std::fmod(eventPhase - phase, 2 * M_PI);
+    if(difference < 0)
+        difference += 2 * M_PI;
+    return after + std::chrono::duration_cast<time_point::duration>(
+                std::chrono::duration<double>(difference / (2 * M_PI * signal.frequency)));
+}
+
+void USBEmulator::readSampleData() {
+    const double rate = samplerate();
+    const bool tenBit = _model.productID == 0x5200 || _model.productID == 0x520A;
+
+    if(_recordLengthId == RECORDLENGTHID_ROLL) {
+        // One packet of a continuous stream, the driver doesn't wait longer than a second
+        const double now = signalTime(std::chrono::steady_clock::now());
+        if(_rollTime < now - 1.0)
+            _rollTime = now;
+        const unsigned values = tenBit ? EMULATOR_PACKET_SIZE / 2 : EMULATOR_PACKET_SIZE;
+        const unsigned samples = _fastRate ? values : values / 2;
+        encodeSamples(samples, _rollTime, 0);
+        _rollTime += samples / rate;
+        return;
+    }
+
+    // The samples of the last capture, data of a capture that is not complete yet is garbage on the real device
+    const time_point trigger = _triggerTime != time_point::max() ? _triggerTime : std::chrono::steady_clock::now();
+    const unsigned samples = _fastRate ? 2 * recordLength() : recordLength();
+    encodeSamples(samples, signalTime(trigger) - pretriggerSamples() / rate, _ringPosition);
+}
+
+void USBEmulator::encodeSamples(unsigned samples, double startTime, unsigned start) {
+    const bool tenBit = _model.productID == 0x5200 || _model.productID == 0x520A;
+    const unsigned values = _fastRate ? samples : 2 * samples;
+    const double rate = samplerate();
+    // In fast rate mode the used channel fills the buffers of both channels
+    const unsigned fastChannel = _used[0] ? 0 : 1;
+
+    _response.assign(tenBit ? 2 * values : values, 0);
+    _responseOffset = 0;
+
+    for(unsigned sample = 0; sample < samples; ++sample) {
+        const double time = startTime + sample / rate;
+        if(_fastRate) {
+            const unsigned position = (2 * start + sample) % values;
+            const unsigned value = sampleValue(fastChannel, time);
+            _response[position] = (unsigned char)value;
+            // Extra bits of two samples share one byte, the first one in the upper bits
+            if(tenBit)
+                _response[values + position - position % 2] |= (value >> 8) << (position % 2 ? 0 : 2);
+        } else {
+            const unsigned position = 2 * ((start + sample) % samples);
+            for(unsigned channel = 0; channel < 2; ++channel) {
+                const unsigned value = sampleValue(channel, time);
+                // Channel 2 comes first
+                _response[position + 1 - channel] = (unsigned char)value;
+                if(tenBit)
+                    _response[values + position] |= (value >> 8) << (2 * channel);
+            }
+        }
+    }
+}
+
+unsigned USBEmulator::sampleValue(unsigned channel, double time) const {
+    const Signal& signal = _signals[channel];
+    const bool tenBit = _model.productID == 0x5200 || _model.productID == 0x520A;
+
+    // The ADC values of one screen height, see the gain levels of the driver
+    const double screen = tenBit ? (_gainBits[channel] == 1 ? 368 : 454) : 255;
+    const double maximum = tenBit ? 1023 : 255;
+
+    const double offset = ((double)_offset[channel] - EMULATOR_OFFSET_MIN) / (EMULATOR_OFFSET_MAX - EMULATOR_OFFSET_MIN);
+    const double value = (offset + signal.amplitude * std::sin(2 * M_PI * signal.frequency * time + signal.phase)) * screen;
+    return (unsigned)std::round(std::max(0.0, std::min(value, maximum)));
+}
+
+double USBEmulator::samplerate() const {
+    double base, maximum;
+    switch(_model.productID) {
+        case 0x2250:
+            base = 100e6;
+            maximum = _fastRate ? 125e6 : 100e6;
+            break;
+        case 0x5200:
+        case 0x520A:
+            base = 100e6;
+            maximum = 125e6;
+            break;
+        case 0x2150:
+            base = 50e6;
+            maximum = 75e6;
+            break;
+        default:
+            base = 50e6;
+            maximum = 50e6;
+            break;
+    }
+    // Fast rate mode uses the ADCs of both channels
+    if(_fastRate) {
+        base *= 2;
+        maximum *= 2;
+    }
+
+    double rate = _downsampler ? base / _downsampler : maximum;
+    if(_recordLengthId == RECORDLENGTHID_ROLL)
+        rate /= 1000;
+    return rate;
+}
+
+unsigned USBEmulator::recordLength() const {
+    if(_recordLengthId == RECORDLENGTHID_SMALL)
+        return 10240;
+    switch(_model.productID) {
+        case 0x2250:
+            return 524288;
+        case 0x5200:
+        case 0x520A:
+            return 14336;
+        default:
+            return 32768;
+    }
+}
+
+unsigned USBEmulator::pretriggerSamples() const {
+    // The left side (0 %) is the maximum position minus the record length
+    const unsigned maximum = (_model.productID == 0x5200 || _model.productID == 0x520A) ? 0xffff : 0x7ffff;
+    const unsigned samples = _fastRate ? 2 * recordLength() : recordLength();
+    const unsigned left = maximum - samples;
+    // In fast rate mode the position counts the samples of one ADC
+    const unsigned position = _triggerPosition > left ? _triggerPosition - left : 0;
+    return std::min(_fastRate ? 2 * position : position, samples);
+}
+
+double USBEmulator::signalTime(time_point time) const {
+    return std::chrono::duration<double>(time - _epoch).count();
+}
+
+}
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  usbEmulator.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "usbCommunication.h"
+#include "protocol.h"
+
+namespace Hantek2xxx_5xxx {
+
+//////////////////////////////////////////////////////////////////////////////
+/// \brief Emulates a DSO-2090, DSO-2150, DSO-2250 or DSO-5200(A) in software.
+/// It can be handed to a HantekDevice instead of a real usb connection, so the
+/// driver can be run, benchmarked and tested without hardware.
+///
+/// The emulator decodes the bulk and control commands the driver sends and models
+/// the capture state machine of the oscilloscope in real time: The pretrigger
+/// buffer is filled after the capture start, the trigger fires on the first
+/// crossing of the trigger level after it has been enabled (or when it is forced)
+/// and the post trigger samples are recorded afterwards. The sample data is read
+/// from a ring buffer whose start is reported in the Hantek trigger point encoding.
+///
+/// The input attenuators are not modelled: Signals are given relative to the
+/// screen height, so the samples do not depend on the gain setting.
+class USBEmulator : public DSO::USBCommunication {
+    public:
+        //////////////////////////////////////////////////////////////////////////
+        /// \struct Signal
+        /// \brief The sine wave applied to one input.
+        struct Signal {
+            double frequency = 1e3; ///< The frequency in Hz
+            double amplitude = 0.3; ///< The amplitude in screen heights
+            double phase = 0.0;     ///< The phase at the start of the emulation in rad
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        /// \struct Statistics
+        /// \brief Counters of the emulated usb traffic.
+        struct Statistics {
+            unsigned long long controlTransfers = 0; ///< Control transfers in both directions
+            unsigned long long bulkCommands = 0;     ///< Bulk commands written
+            unsigned long long bulkReads = 0;        ///< Bulk read transfers
+            unsigned long long bytesRead = 0;        ///< Bytes of all bulk read transfers
+            unsigned long long captures = 0;         ///< Captures that were started
+            unsigned long long protocolErrors = 0;   ///< Transfers the oscilloscope would not accept
+        };
+
+        /// \param model The emulated model, selected by the product id.
+        /// \param uniqueID The id that replaces the usb port number.
+        USBEmulator(const DSO::DSODeviceDescription& model, uint8_t uniqueID = 0);
+
+        virtual int connect() override;
+        virtual void disconnect() override;
+        virtual bool isConnected() const override;
+
+        virtual int bulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length,
+                                 int attempts, unsigned int timeout) override;
+        virtual int controlTransfer(unsigned char type, unsigned char request, unsigned char *data,
+                                    unsigned int length, int value, int index) override;
+
+        virtual uint8_t getUniqueID() override;
+
+        /// \brief Set the signal of an input. Can be called by any thread.
+        void setSignal(unsigned channel, const Signal& signal);
+
+        /// \brief Delay every transfer like a real usb connection.
+        /// \param latency The time each transfer takes without its data.
+        /// \param bytesPerSecond The bulk throughput, 0 for no limit.
+        void setTransferTiming(std::chrono::microseconds latency, double bytesPerSecond);
+
+        /// \return The counters of the usb traffic so far.
+        Statistics getStatistics() const;
+
+    private:
+        typedef std::chrono::steady_clock::time_point time_point;
+
+        /// \brief Emulate a bulk transfer, without the transfer time and its accounting.
+        int emulateBulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length);
+
+        /// \brief Emulate a control transfer, without the transfer time and its accounting.
+        int emulateControlTransfer(unsigned char type, unsigned char request, unsigned char *data,
+                                   unsigned int length, int value);
+
+        /// \brief Handle a bulk command written to the OUT endpoint.
+        int bulkCommand(const unsigned char *data, unsigned int length);
+
+        /// \brief Handle a read from the IN endpoint.
+        int bulkResponse(unsigned char *data, unsigned int length);
+
+        /// \brief Copy a received command into its builder to decode it.
+        template<class T> void decode(T& command, const unsigned char *data, unsigned int length);
+
+        /// \brief Check the capture progress at the given time.
+        CaptureState captureState(time_point now);
+
+        /// \brief The first trigger event at or after the given time, time_point::max() if
+        /// the signal does not reach the trigger level.
+        time_point nextTriggerEvent(time_point after) const;
+
+        /// \brief Fill the response with the current sample data.
+        void readSampleData();
+
+        /// \brief Write the samples of the used channels, starting at the given time,
+        /// into the response in the device data format.
+        /// \param samples The number of samples per channel (of the used channel in fast rate mode).
+        /// \param start The ring buffer position of the first sample pair.
+        void encodeSamples(unsigned samples, double startTime, unsigned start);
+
+        /// \return The ADC value of a channel at the given time.
+        unsigned sampleValue(unsigned channel, double time) const;
+
+        /// \return The current samplerate in S/s.
+        double samplerate() const;
+        /// \return The record length per channel in samples.
+        unsigned recordLength() const;
+        /// \return The number of pretrigger samples (of the used channel in fast rate mode).
+        unsigned pretriggerSamples() const;
+        /// \return The seconds since the start of the emulation.
+        double signalTime(time_point time) const;
+
+        /// \brief Sleep for the configured transfer time.
+        void transferDelay(unsigned int length) const;
+
+        mutable std::mutex _mutex;
+        const uint8_t _uniqueID;
+        const time_point _epoch;
+        bool _connected = false;
+        Statistics _statistics;
+        std::array<Signal, 2> _signals;
+        std::chrono::microseconds _latency {0};
+        double _bytesPerSecond = 0;
+
+        /// Decoded device settings, with the defaults of the oscilloscope
+        unsigned _recordLengthId = RECORDLENGTHID_SMALL;
+        unsigned _downsampler = 0;     ///< 0 for the maximum samplerate
+        bool _fastRate = false;
+        bool _used[2] = {true, true};
+        bool _triggerSpecial = false;
+        unsigned _triggerChannel = 0;
+        bool _triggerFalling = false;
+        unsigned _triggerPosition = 0; ///< Pretrigger position, raw value of the model
+        unsigned _triggerLevel = 0x7f; ///< Raw value of the model
+        unsigned _offset[2] = {0, 0};  ///< Raw values between EMULATOR_OFFSET_MIN and EMULATOR_OFFSET_MAX
+        unsigned char _gainBits[2] = {0, 0};
+
+        /// Capture state machine
+        bool _commandExpected = false; ///< CONTROL_BEGINCOMMAND was received
+        bool _captureStarted = false;
+        bool _dataReady = false;
+        time_point _captureStart;
+        time_point _triggerEnabled;    ///< time_point::max() until the trigger is enabled
+        time_point _triggerTime;       ///< time_point::max() until the trigger fired
+        double _rollTime = 0;          ///< Signal time of the next roll mode sample
+        unsigned _ringPosition = 0;    ///< Start of the data in the ring buffer
+
+        /// The response to the last bulk command that is read from the IN endpoint
+        std::vector<unsigned char> _response;
+        unsigned _responseOffset = 0;
+};
+
+}
@@ -30,6 +30,7 @@
 #include <memory>
 #include <climits>
 #include <cstring>
+#include <algorithm>
 
 #include "utils/containerStream.h"
 
@@ -50,7 +51,7 @@ HantekDevice::HantekDevice(std::unique_ptr<DSO::USBCommunication> device)
 }
 
 HantekDevice::~HantekDevice() {
-    _device->disconnect();
+    disconnectDevice();
 }
 
 unsigned HantekDevice::getUniqueID() const {
@@ -58,18 +59,16 @@ unsigned HantekDevice::getUniqueID() const {
 }
 
 bool HantekDevice::needFirmware() const {
+    // A loaded firmware enumerates with another vendor id and matches another model,
+    // its version is not checked
     return _model.need_firmware;
 }
 
 ErrorCode HantekDevice::uploadFirmware() {
-    int error_code = _device->connect();
-    if (error_code != LIBUSB_SUCCESS) {
-        libusb_error_name(error_code);
-        std::cerr << "Firmware upload: " << " " <<
-        libusb_error_name((libusb_error)error_code) << " " <<
-            libusb_strerror((libusb_error)error_code) << std::endl;
-        return (ErrorCode)error_code;
-    }
+    if(!needFirmware())
+        return ErrorCode::ERROR_NONE;
+    if(isDeviceConnected() || isDeviceTaskRunning())
+        return ErrorCode::ERROR_UNSUPPORTED;
 
     int fwsize = 0;
     unsigned char* firmware = nullptr;
@@ -86,37 +85,101 @@ ErrorCode HantekDevice::uploadFirmware() {
             return ErrorCode::ERROR_PARAMETER;
     }
 
-    unsigned int Size, Value;
-    while (fwsize) {
-        Size  = *firmware + ((*(firmware + 1))<<0x08);
-        firmware = firmware + 2;
-        Value = *firmware + ((*(firmware + 1))<<0x08);
-        firmware = firmware + 2;
-        int error_code = _device->controlWrite(HT6022_FIRMWARE_REQUEST,firmware,Size,Value,HT6022_FIRMWARE_INDEX);
+    int error_code = _device->connect();
+    if (error_code != LIBUSB_SUCCESS) {
+        std::cerr << "Firmware upload: " << " " <<
+        libusb_error_name((libusb_error)error_code) << " " <<
+            libusb_strerror((libusb_error)error_code) << std::endl;
+        return (ErrorCode)error_code;
+    }
+
+    _firmware = firmwareChunks(firmware, fwsize);
+    _firmwareChunk = 0;
+    _firmwareSent = 0;
+    _firmwareSize = 0;
+    for(const FirmwareChunk& chunk: _firmware)
+        _firmwareSize += chunk.data.size();
+    _uploadPercent = 0;
+
+    // The chunks are written by the device task, the progress is reported by _uploadProgress
+    startDeviceTask(std::bind(&HantekDevice::uploadStep, this));
+    return ErrorCode::ERROR_NONE;
+}
+
+std::vector<HantekDevice::FirmwareChunk> HantekDevice::firmwareChunks(const unsigned char* firmware, int records) {
+    std::vector<FirmwareChunk> chunks;
+    for(; records > 0; --records) {
+        const unsigned size = firmware[0] + (firmware[1] << 8);
+        const unsigned address = firmware[2] + (firmware[3] << 8);
+        firmware += 4;
+
+        // Append to the previous chunk if the record continues it in the code memory
+        const bool code = address + size <= HT6022_FIRMWARE_CODE_END;
+        if(code && !chunks.empty()) {
+            FirmwareChunk& last = chunks.back();
+            if(last.address + last.data.size() == address &&
+                    last.address + last.data.size() <= HT6022_FIRMWARE_CODE_END &&
+                    last.data.size() + size <= HT6022_FIRMWARE_CHUNK) {
+                last.data.insert(last.data.end(), firmware, firmware + size);
+                firmware += size;
+                continue;
+            }
+        }
+
+        chunks.push_back({address, std::vector<unsigned char>(firmware, firmware + size)});
+        firmware += size;
+    }
+    return chunks;
+}
+
+std::chrono::steady_clock::time_point HantekDevice::uploadStep() {
+    for(unsigned count = 0; count < HT6022_FIRMWARE_STEP_CHUNKS && _firmwareChunk < _firmware.size(); ++count) {
+        FirmwareChunk& chunk = _firmware[_firmwareChunk];
+        int error_code = _device->controlWrite(HT6022_FIRMWARE_REQUEST, chunk.data.data(), chunk.data.size(),
+                                               chunk.address, HT6022_FIRMWARE_INDEX);
         if (error_code < 0) {
+            std::cerr << "Firmware upload: " << libusb_error_name((libusb_error)error_code) << std::endl;
+            _firmware.clear();
             _device->disconnect();
-            return ErrorCode::ERROR_CONNECTION;
+            _uploadProgress((int)ErrorCode::ERROR_CONNECTION);
+            return DSO::Executor::finished;
         }
-        firmware = firmware + Size;
-        fwsize--;
+        _firmwareSent += chunk.data.size();
+        ++_firmwareChunk;
     }
 
-    _uploadProgress(100);
-    _device->disconnect();
+    // The last chunks start the firmware, the device reenumerates with another vendor id
+    if(_firmwareChunk == _firmware.size()) {
+        _firmware.clear();
+        _device->disconnect();
+        _uploadProgress(100);
+        return DSO::Executor::finished;
+    }
 
-    return ErrorCode::ERROR_NONE;
+    const int percent = 100 * _firmwareSent / _firmwareSize;
+    if(percent != _uploadPercent) {
+        _uploadPercent = percent;
+        if(!_uploadProgress(percent)) {
+            _firmware.clear();
+            _device->disconnect();
+            return DSO::Executor::finished;
+        }
+    }
+
+    // Give the other tasks a chance between the steps
+    return std::chrono::steady_clock::time_point();
 }
 
 void HantekDevice::deviceDisconnected() {
-    if (!_thread.get()) return;
-    _keep_thread_running = false;
-    if (_thread->joinable()) _thread->join();
-    _thread.reset();
+    stopDeviceTask();
 }
 
 void HantekDevice::disconnectDevice() {
+    // Stop the device task first, it owns the stream
+    stopDeviceTask();
+    stopStream();
+    // Waits until the cancelled transfers have completed
     _device->disconnect();
-    _keep_thread_running = false;
 }
 
 bool HantekDevice::isDeviceConnected() const {
@@ -126,40 +189,47 @@ bool HantekDevice::isDeviceConnected() const {
 void HantekDevice::connectDevice(){
     if (_model.need_firmware) return;
 
-    if (_model.need_firmware) return;
-
     _statusMessage(_device->connect());
     if(!_device->isConnected())
             return;
 
     _specification.channels_special = 0;
-    _specification.channels         = 2;
+    _specification.channels         = HT6022_CHANNELS;
+    _lost = false;
 
     resetPending();
     resetSettings();
 
-    _specification.samplerate_single.base = 50e6;
-    _specification.samplerate_single.max = 50e6;
-    _specification.samplerate_single.maxDownsampler = 131072;
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(10240, 1));
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(32768, 1));
-    _specification.samplerate_multi.base = 100e6;
-    _specification.samplerate_multi.max = 100e6;
-    _specification.samplerate_multi.maxDownsampler = 131072;
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(rollModeValue, 1000));
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(20480, 1));
-    _specification.samplerate_single.recordTypes.push_back(DSO::dsoRecord(65536, 1));
+    // Both channels are always sampled with the same rate. All rates of the
+    // HT6022_SampleRate table are integer fractions of 48 MHz, rates below
+    // 100 kS/s are decimated in software (see HT6022_DECIMATION_BASE).
+    for(DSO::ControlSamplerateLimits* limits: {&_specification.samplerate_single, &_specification.samplerate_multi}) {
+        limits->base = 48e6;
+        limits->max = 24e6;
+        limits->maxDownsampler = HT6022_DECIMATION_BASE * HT6022_DECIMATION_MAX;
+        limits->recordTypes.push_back(DSO::dsoRecord(10240, 1));
+        limits->recordTypes.push_back(DSO::dsoRecord(32768, 1));
+        limits->recordTypes.push_back(DSO::dsoRecord(65536, 1));
+        limits->recordTypes.push_back(DSO::dsoRecord(131072, 1));
+        limits->recordTypes.push_back(DSO::dsoRecord(524288, 1));
+    }
     _specification.sampleSize = 8;
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(0,  0.08, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(1,  0.16, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(2,  0.40, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(0,  0.80, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(1,  1.60, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(2,  4.00, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(0,  8.00, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(1, 16.00, 255));
-    _specification.gainLevel.push_back(DSO::dsoGainLevel(2, 40.00, 255));
+
+    // The gain index is the HT6022_InputRange code, the gain steps are the full input range
+    _specification.gainLevel.push_back(DSO::dsoGainLevel((unsigned char) HT6022_InputRange::IR_1V,   1.0, 255));
+    _specification.gainLevel.push_back(DSO::dsoGainLevel((unsigned char) HT6022_InputRange::IR_2V,   2.0, 255));
+    _specification.gainLevel.push_back(DSO::dsoGainLevel((unsigned char) HT6022_InputRange::IR_5V,   5.0, 255));
+    _specification.gainLevel.push_back(DSO::dsoGainLevel((unsigned char) HT6022_InputRange::IR_10V, 10.0, 255));
+    for(DSO::dsoGainLevel& gainLevel: _specification.gainLevel)
+        for (unsigned c=0; c < _specification.channels; ++c)
+            gainLevel.offset[c] = {0,255};
+
+    setSamplerate(1e6);
+    for (unsigned c=0; c < _specification.channels; ++c) {
+        setChannelUsed(c, true);
+        setGain(c, 10.0);
+        setOffset(c, 0.5);
+    }
 
     // _signals for initial _settings
     notifySamplerateLimitsChanged();
@@ -170,83 +240,363 @@ void HantekDevice::connectDevice(){
 
     _sampling = false;
     // The control loop is running until the device is disconnected
-    _keep_thread_running = true;
-    _thread = std::unique_ptr<std::thread>(new std::thread(&HantekDevice::run,std::ref(*this)));
+    startDeviceTask(std::bind(&HantekDevice::step, this));
 
+    _deviceConnected();
+}
+
+std::pair<double, unsigned int> HantekDevice::computeBestSamplerate(double samplerate, const DSO::ControlSamplerateLimits* limits,
+                                                                     bool maximum) const {
+    if(samplerate == 0.0)
+        throw std::runtime_error("computeBestSamplerate with 0 not allowed");
+
+    // Downsamplers of 48 MHz for the HT6022_SampleRate table, highest rate first
+    static const unsigned downsamplers[] = {2, 3, 6, 12, 48, 96, 240, HT6022_DECIMATION_BASE};
+
+    // maximum: Highest rate that is not higher, otherwise lowest rate that is at least as high
+    const double decimationRate = limits->base / HT6022_DECIMATION_BASE;
+    if(samplerate < decimationRate) {
+        // Lower rates are decimated in software from 100 kS/s by an even factor
+        const double factor = decimationRate / samplerate / 2;
+        unsigned decimation = 2 * (unsigned) (maximum ? std::ceil(factor - 1e-9) : std::floor(factor + 1e-9));
+        if(maximum || decimation >= 2) {
+            decimation = std::min(std::max(decimation, 2u), (unsigned) HT6022_DECIMATION_MAX);
+            return std::make_pair(decimationRate / decimation, HT6022_DECIMATION_BASE * decimation);
+        }
+    }
+
+    unsigned best = maximum ? downsamplers[7] : downsamplers[0];
+    for(unsigned downsampler: downsamplers) {
+        const double rate = limits->base / downsampler;
+        if(maximum && rate <= samplerate) {
+            best = downsampler;
+            break;
+        }
+        if(!maximum && rate >= samplerate)
+            best = downsampler;
+    }
+    return std::make_pair(limits->base / best, best);
 }
 
 void HantekDevice::updatePretriggerPosition(double pretrigger_pos_in_s) {}
 
 void HantekDevice::updateRecordLength(unsigned int index) {}
 
-void HantekDevice::updateSamplerate(DSO::ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) {}
+void HantekDevice::updateChannelUsed(unsigned int channel, bool used) {}
+
+void HantekDevice::updateCoupling(unsigned int channel, DSO::Coupling coupling) {}
+
+void HantekDevice::updateSamplerate(DSO::ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) {
+    // The stream is decimated from 100 kS/s for lower rates, the stream gets restarted
+    _decimation = downsampler > HT6022_DECIMATION_BASE ? downsampler / HT6022_DECIMATION_BASE : 1;
+
+    HT6022_SampleRate samplerate;
+    switch(downsampler) {
+        case 0:
+        case 2:   samplerate = HT6022_SampleRate::SR_24MSa;  break;
+        case 3:   samplerate = HT6022_SampleRate::SR_16MSa;  break;
+        case 6:   samplerate = HT6022_SampleRate::SR_8MSa;   break;
+        case 12:  samplerate = HT6022_SampleRate::SR_4MSa;   break;
+        case 48:  samplerate = HT6022_SampleRate::SR_1MSa;   break;
+        case 96:  samplerate = HT6022_SampleRate::SR_500KSa; break;
+        case 240: samplerate = HT6022_SampleRate::SR_200KSa; break;
+        default:  samplerate = HT6022_SampleRate::SR_100KSa; break;
+    }
+    ControlSetSamplerate& cmd = get<ControlSetSamplerate>();
+    cmd.setSamplerate(samplerate);
+    addPending(cmd);
+}
 
 void HantekDevice::updateGain(unsigned channel, unsigned char gainIndex, unsigned gainId)
 {
-
+    if(channel == 0) {
+        ControlSetInputRangeCH1& cmd = get<ControlSetInputRangeCH1>();
+        cmd.setInputRange((HT6022_InputRange) gainIndex);
+        addPending(cmd);
+    } else {
+        ControlSetInputRangeCH2& cmd = get<ControlSetInputRangeCH2>();
+        cmd.setInputRange((HT6022_InputRange) gainIndex);
+        addPending(cmd);
+    }
 }
 
 void HantekDevice::updateOffset(unsigned int channel, unsigned short offsetValue)
 {
-
+    // No hardware offset, the offset is only applied on screen
 }
 
 ErrorCode HantekDevice::updateTriggerSource(bool special, unsigned int channel)
 {
-return ErrorCode::ERROR_NONE;
+    // Software trigger, see findTrigger()
+    if(special || channel >= _specification.channels)
+        return ErrorCode::ERROR_PARAMETER;
+    return ErrorCode::ERROR_NONE;
 }
 
 ErrorCode HantekDevice::updateTriggerLevel(unsigned int channel, double level)
 {
-return ErrorCode::ERROR_NONE;
+    return ErrorCode::ERROR_NONE;
 }
 
 ErrorCode HantekDevice::updateTriggerSlope(DSO::Slope slope)
 {
-return ErrorCode::ERROR_NONE;
+    return ErrorCode::ERROR_NONE;
 }
 
-int HantekDevice::readSamples() {
-    *_data = HT6022_READ_CONTROL_DATA;
-    int errorCode = _device->controlWrite(HT6022_READ_CONTROL_REQUEST,
-                                          _data,
-                                          HT6022_READ_CONTROL_SIZE,
-                                          HT6022_READ_CONTROL_VALUE,
-                                          HT6022_READ_CONTROL_INDEX);
+int HantekDevice::startStream() {
+    _streamRecordLength = getCurrentRecordType().length_per_channel;
+    _streamSamplerate = _settings.samplerate.current;
+
+    for(StreamBlock& block: _blocks) {
+        block.data.resize(_streamRecordLength * HT6022_CHANNELS);
+        block.filled = false;
+    }
+    _history.clear();
+    _decimator.configure(HT6022_CHANNELS, _decimation);
+    _decimated.clear();
+    _decimatedHistory.clear();
+    _nextBlock = 0;
+    _lastTrigger = std::chrono::steady_clock::now();
+
+    // The blocks can't arrive faster than they are sampled, the timeouts adapt to it
+    _device->transferPolicy().setDataRate(_model.bulk_endpoint_in, _streamSamplerate * _decimation * HT6022_CHANNELS);
+
+    // The oscilloscope streams continuously after the start command
+    ControlStartSampling& start = get<ControlStartSampling>();
+    int errorCode = _device->controlWrite(start.extra, start.data(), start.size(),
+                                          HT6022_READ_CONTROL_VALUE, HT6022_READ_CONTROL_INDEX);
     if(errorCode < 0)
         return errorCode;
 
-    return _device->bulkReadMulti(_data, (int)_dataSize*2);
+    _streaming = true;
+    for(StreamBlock& block: _blocks) {
+        errorCode = submitBlock(block);
+        if(errorCode < 0) {
+            stopStream();
+            return errorCode;
+        }
+    }
+    return LIBUSB_SUCCESS;
 }
 
-void HantekDevice::run() {
-    while (_keep_thread_running) {
-        if (!sendPendingCommands(_device.get())) break;
+void HantekDevice::stopStream() {
+    if(!_streaming)
+        return;
+    _streaming = false;
+    _device->cancelTransfers(false);
+}
 
-        // Compute sleep time
-        int cycleTime;
+int HantekDevice::submitBlock(StreamBlock& block) {
+    block.filled = false;
+    {
+        std::lock_guard<std::mutex> lock(_streamMutex);
+        ++_submitted;
+    }
+    // Called by the libusb event thread
+    const int errorCode = _device->submitBulkTransfer(_model.bulk_endpoint_in, block.data.data(), block.data.size(),
+                                                      [this, &block](int result) {
+        {
+            std::lock_guard<std::mutex> lock(_streamMutex);
+            block.received = result;
+            block.filled = true;
+            --_submitted;
+        }
+        wakeDeviceTask();
+    });
+    if(errorCode != LIBUSB_SUCCESS) {
+        std::lock_guard<std::mutex> lock(_streamMutex);
+        --_submitted;
+    }
+    return errorCode;
+}
 
-        // Check the current oscilloscope state everytime 25% of the time the buffer should be refilled
-        if(isRollingMode())
-            cycleTime = _device->getPacketSize() / (!isFastRate() ? 1 : _specification.channels);
-        else
-            cycleTime = getCurrentRecordType().length_per_channel;
+unsigned HantekDevice::submittedTransfers() {
+    std::lock_guard<std::mutex> lock(_streamMutex);
+    return _submitted;
+}
 
-        cycleTime = cycleTime / _settings.samplerate.current * 250;
+/// \return The voltage of an ADC code, decimated samples are between two codes.
+static inline double sampleVoltage(const double* voltage, unsigned char code) {
+    return voltage[code];
+}
+static inline double sampleVoltage(const double* voltage, float code) {
+    const int below = std::min(std::max((int) code, 0), 254);
+    return voltage[below] + (code - below) * (voltage[below + 1] - voltage[below]);
+}
 
-        // Not more often than every 10 ms though but at least once every second
-        cycleTime = std::max(std::min(10, cycleTime), 1000);
+/// \return The trigger level in ADC codes, rounded for the codes of the ADC.
+static inline double triggerLevel(double level, unsigned char) {
+    return lround(level);
+}
+static inline double triggerLevel(double level, float) {
+    return level;
+}
 
-        if (readSamples() < 0)
-            break;
+template<class Sample>
+int HantekDevice::findTrigger(const Sample* data, unsigned first, unsigned last) const {
+    const unsigned channel = _settings.trigger.source;
+    if(_settings.trigger.special || channel >= HT6022_CHANNELS)
+        return -1;
+
+    // Trigger level in ADC values, like in convertSample() 0x80 is 0 V
+    const double gain = _specification.gainLevel[_settings.voltage[channel].gainID].gainSteps;
+    const double level = triggerLevel(_settings.trigger.level[channel] / gain * 256 + 0x80, Sample());
+
+    const Sample* sample = data + channel;
+    first = std::max(first, 1u);
+    if(_settings.trigger.slope == DSO::Slope::POSITIVE) {
+        for(unsigned position = first; position < last; ++position)
+            if(sample[(position - 1) * HT6022_CHANNELS] < level && sample[position * HT6022_CHANNELS] >= level)
+                return position;
+    } else {
+        for(unsigned position = first; position < last; ++position)
+            if(sample[(position - 1) * HT6022_CHANNELS] > level && sample[position * HT6022_CHANNELS] <= level)
+                return position;
+    }
+    return -1;
+}
 
-        //processSamples(_data, _dataSize);
+void HantekDevice::processBlock(const std::vector<unsigned char>& block) {
+    if(_decimator.factor() == 1) {
+        processFrames(block, _history);
+        return;
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(cycleTime));
+    // The frames are searched in blocks of decimated samples with the same length
+    _decimator.process(block.data(), block.size() / HT6022_CHANNELS, _decimated);
+    const unsigned blockSize = _streamRecordLength * HT6022_CHANNELS;
+    unsigned used = 0;
+    for(; _decimated.size() - used >= blockSize && _sampling; used += blockSize) {
+        _decimatedBlock.assign(_decimated.begin() + used, _decimated.begin() + used + blockSize);
+        processFrames(_decimatedBlock, _decimatedHistory);
     }
+    _decimated.erase(_decimated.begin(), _decimated.begin() + used);
+}
+
+template<class Sample>
+void HantekDevice::processFrames(const std::vector<Sample>& block, std::vector<Sample>& history) {
+    const unsigned length = block.size() / HT6022_CHANNELS;
+
+    // The new block follows the history, frames may start in the history
+    const bool haveHistory = history.size() == block.size();
+    history.insert(history.end(), block.begin(), block.end());
+    const unsigned historyLength = haveHistory ? length : 0;
+
+    // Samples before the trigger point
+    const unsigned pretrigger = std::min((unsigned) (_settings.trigger.pretrigger_pos_in_s * _streamSamplerate), length);
+
+    // The whole frame has to fit into history and block. Every trigger position
+    // is searched once, the positions up to pretrigger were searched with the previous block.
+    const unsigned first = haveHistory ? pretrigger + 1 : pretrigger;
+    const unsigned last = historyLength + pretrigger + 1;
+
+    const int trigger = _settings.trigger.mode == DSO::TriggerMode::UNDEFINED ? -1
+                      : findTrigger(history.data(), first, std::min(last, historyLength + length));
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if(trigger >= 0) {
+        _settings.trigger.point = pretrigger;
+        sendFrame(history.data() + (trigger - pretrigger) * HT6022_CHANNELS, length);
+        _lastTrigger = now;
+
+        if(_settings.trigger.mode == DSO::TriggerMode::SINGLE)
+            stopSampling();
+    } else if(_settings.trigger.mode == DSO::TriggerMode::AUTO &&
+              now - _lastTrigger > std::chrono::milliseconds(100)) {
+        // No trigger event, show the untriggered signal
+        _settings.trigger.point = 0;
+        sendFrame(history.data() + historyLength * HT6022_CHANNELS, length);
+    }
+
+    // Keep only the new block
+    history.erase(history.begin(), history.begin() + historyLength * HT6022_CHANNELS);
+}
+
+template<class Sample>
+void HantekDevice::sendFrame(const Sample* data, unsigned length) {
+    for(unsigned channel = 0; channel < HT6022_CHANNELS; ++channel) {
+        DSO::SampleBuffer& samples = _frame.samples[channel];
+        if(!_settings.voltage[channel].used) {
+            // Clear unused channels
+            samples.clear();
+            continue;
+        }
+
+        const double* voltage = conversionTable(channel);
+        samples.resize(length);
+        const Sample* sample = data + channel;
+        for(unsigned position = 0; position < length; ++position, sample += HT6022_CHANNELS)
+            samples[position] = sampleVoltage(voltage, *sample);
+    }
+
+    snapshotSettings(_frame.settings);
+    if(!calibrationFrame())
+        _frameBus.publish(_frame);
+}
+
+double HantekDevice::convertSample(unsigned gainID, double, double code) const {
+    return (code - 0x80) * _specification.gainLevel[gainID].gainSteps / 256;
+}
+
+std::chrono::steady_clock::time_point HantekDevice::step() {
+    if (_lost || !sendPendingCommands(_device.get()))
+        return deviceLost();
+
+    // The stream is restarted if the block size or samplerate changed
+    const bool streamValid = _streamRecordLength == getCurrentRecordType().length_per_channel &&
+                             _streamSamplerate == _settings.samplerate.current;
+    if (!_sampling || !streamValid)
+        stopStream();
+    if (!_sampling)
+        return DSO::Executor::idle;
+    if (!_streaming) {
+        // The cancelled transfers of the previous stream still own the blocks, they wake the task
+        if (submittedTransfers())
+            return DSO::Executor::idle;
+        const int errorCode = startStream();
+        if (errorCode == LIBUSB_ERROR_NO_DEVICE)
+            return deviceLost();
+        else if (errorCode < 0)
+            return std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    }
+
+    // Convert the completed blocks in the order they were submitted and queue them again
+    for (unsigned count = 0; count < HT6022_STREAM_BLOCKS && _streaming; ++count) {
+        StreamBlock& block = _blocks[_nextBlock];
+        {
+            std::lock_guard<std::mutex> lock(_streamMutex);
+            if (!block.filled)
+                break;
+        }
+
+        if (block.received == LIBUSB_ERROR_NO_DEVICE)
+            return deviceLost();
+        else if (block.received == (int) block.data.size())
+            processBlock(block.data);
+
+        _nextBlock = (_nextBlock + 1) % HT6022_STREAM_BLOCKS;
+        if (!_sampling)
+            break;
+        const int errorCode = submitBlock(block);
+        if (errorCode == LIBUSB_ERROR_NO_DEVICE)
+            return deviceLost();
+        else if (errorCode < 0)
+            stopStream(); // Restarted by the next step
+    }
+
+    // Woken up by the completed transfers or settings changes
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+}
 
+std::chrono::steady_clock::time_point HantekDevice::deviceLost() {
+    stopStream();
+    _lost = true;
+    // The blocks may only be released after all transfers have completed, they wake the task
+    if (submittedTransfers())
+        return DSO::Executor::idle;
     _device->disconnect();
     _statusMessage(LIBUSB_ERROR_NO_DEVICE);
+    return DSO::Executor::finished;
 }
 
 }
@@ -29,20 +29,29 @@
 #include <functional>
 #include <chrono>
 #include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
 
 #include "usbCommunication.h"
 #include "usbCommunicationQueues.h"
 #include "deviceBase.h"
 #include "errorcodes.h"
 #include "protocol.h"
+#include "utils/decimator.h"
 
 class libusb_device;
 
 namespace Hantek60xx {
 
+/// The transfer buffers of one device
+typedef DSO::CommunicationThreadBuffers<
+    ControlSetSamplerate, ControlSetInputRangeCH1, ControlSetInputRangeCH2, ControlStartSampling> HantekBuffers;
+
 //////////////////////////////////////////////////////////////////////////////
 /// Implementation of a DSO DeviceBase for Hantek USB DSO DSO-60xx
-class HantekDevice : public DSO::DeviceBase, public DSO::CommunicationThreadQueues  {
+class HantekDevice : public DSO::DeviceBase, public HantekBuffers {
     public:
         HantekDevice(std::unique_ptr<DSO::USBCommunication> device);
         ~HantekDevice();
@@ -57,13 +66,48 @@ class HantekDevice : public DSO::DeviceBase, public DSO::CommunicationThreadQueu
         virtual void disconnectDevice() override;
     private:
         std::unique_ptr<DSO::USBCommunication> _device;
-        std::unique_ptr<std::thread> _thread;
-        volatile bool _keep_thread_running;
 
-        /// The DSO samples passes multiple buffers before it appears
-        /// on screen. _data is the first one after the usb communication.
-        HT6022_DataSize _dataSize = HT6022_DataSize::DS_128KB;
-        unsigned char _data[(int)HT6022_DataSize::DS_1MB*2];
+        //////////////////////////////////////////////////////////////////////////////
+        /// \struct StreamBlock
+        /// \brief One buffer of the sample stream.
+        struct StreamBlock {
+            std::vector<unsigned char> data; ///< Interleaved samples of both channels
+            int received = 0;                ///< Received bytes or libusb error code
+            bool filled = false;             ///< The transfer completed, owned by the device task if true
+        };
+
+        /// The blocks are submitted in turn, the device task converts one while the others are filled
+        StreamBlock _blocks[HT6022_STREAM_BLOCKS];
+        unsigned _nextBlock = 0;  ///< The block the device task converts next
+        /// The samples of the last complete block, the pretrigger part of a frame can be in there
+        std::vector<unsigned char> _history;
+        std::mutex _streamMutex;  ///< Protects the filled blocks and _submitted
+        unsigned _submitted = 0;  ///< Transfers that have not completed yet, they own their blocks
+        bool _streaming = false;  ///< The blocks are submitted again after they were converted
+        bool _lost = false;       ///< The device is gone, it is closed when all transfers completed
+        unsigned _streamRecordLength = 0;  ///< Samples per channel and block of the running stream
+        double _streamSamplerate = 0;      ///< Samplerate of the running stream
+        std::chrono::steady_clock::time_point _lastTrigger; ///< Last frame in auto trigger mode
+
+        unsigned _decimation = 1;          ///< Software decimation of the stream, set by updateSamplerate()
+        DSO::Decimator _decimator;         ///< The filter state of the running stream
+        std::vector<float> _decimated;     ///< Decimated samples that don't fill a block yet
+        std::vector<float> _decimatedBlock;
+        std::vector<float> _decimatedHistory; ///< Like _history, for decimated blocks
+
+        //////////////////////////////////////////////////////////////////////////////
+        /// \struct FirmwareChunk
+        /// \brief Firmware records that are written with one control transfer.
+        struct FirmwareChunk {
+            unsigned address;                ///< The address of the first byte
+            std::vector<unsigned char> data;
+        };
+
+        std::vector<FirmwareChunk> _firmware; ///< The chunks of the running upload
+        unsigned _firmwareChunk = 0;          ///< The chunk that is written next
+        unsigned _firmwareSent = 0;           ///< The bytes written so far
+        unsigned _firmwareSize = 0;           ///< The bytes of all chunks
+        int _uploadPercent = 0;               ///< The progress that was reported last
 
         //////////////////////////////////////////////////////////////////////////////
         /// \enum ControlIndex
@@ -78,26 +122,79 @@ class HantekDevice : public DSO::DeviceBase, public DSO::CommunicationThreadQueu
         /// or if an usb error occured or the device has been plugged out.
         void deviceDisconnected();
 
-        /**
-         * @brief Sends a bulk command. _device->bulkWrite cannot be called
-         * directly, because a usb control sequence has to be send before each bulk request.
-         * This can only be done in the sample thread (in run()).
-         * @param command
-         * @return Return an usb error code.
-         */
-        int readSamples();
-
-        /// \brief Handles all USB communication and sampling until the device gets disconnected.
-        void run();
+        /// \brief Split the firmware records into chunks.
+        /// \param firmware The records: Length and address (little endian 16 bit each) and the data.
+        /// \param records The number of records.
+        static std::vector<FirmwareChunk> firmwareChunks(const unsigned char* firmware, int records);
+
+        /// \brief Write the next firmware chunks, run by the shared executor as the device task.
+        /// \return The time of the next step, Executor::finished if the upload is done or failed.
+        std::chrono::steady_clock::time_point uploadStep();
+
+        /// \brief Start the sampling and submit all blocks for the current record length.
+        /// \return LIBUSB_SUCCESS or a libusb error code.
+        int startStream();
+
+        /// \brief Cancel the transfers of the stream, the samples in the blocks are dropped.
+        /// It doesn't wait for the transfers, their completions wake the device task.
+        void stopStream();
+
+        /// \brief Submit the bulk transfer that fills a block.
+        /// \return LIBUSB_SUCCESS or a libusb error code.
+        int submitBlock(StreamBlock& block);
+
+        /// \return The number of transfers that have not completed yet.
+        unsigned submittedTransfers();
+
+        /// \brief Decimate a block if necessary and send the frames in it.
+        /// \param block The new block of the stream.
+        void processBlock(const std::vector<unsigned char>& block);
+
+        /// \brief Search the trigger in the last two blocks and send a frame.
+        /// \param block The new block, it follows the samples in history.
+        /// \param history The samples of the last complete block.
+        template<class Sample>
+        void processFrames(const std::vector<Sample>& block, std::vector<Sample>& history);
+
+        /// \brief Search a trigger event in interleaved samples.
+        /// \param data The interleaved samples, ADC codes.
+        /// \param first The first sample position that is checked.
+        /// \param last The sample position after the last that is checked.
+        /// \return The position of the trigger or -1 if there is no trigger event.
+        template<class Sample>
+        int findTrigger(const Sample* data, unsigned first, unsigned last) const;
+
+        /// \brief Convert interleaved samples into a frame and send it.
+        /// \param data The first sample of the frame.
+        /// \param length The samples per channel.
+        template<class Sample>
+        void sendFrame(const Sample* data, unsigned length);
+
+        /// \brief One step of the USB communication and sampling, run by the shared executor
+        /// until the device gets disconnected.
+        /// \return The time of the next step.
+        std::chrono::steady_clock::time_point step();
+
+        /// \brief Close the connection after the device has been plugged out.
+        /// \return Executor::finished, the device task ends. Executor::idle while
+        ///         transfers still have to complete.
+        std::chrono::steady_clock::time_point deviceLost();
 
         virtual void updatePretriggerPosition(double pretrigger_pos_in_s) override;
         virtual void updateRecordLength(unsigned int index) override;
+        virtual void updateChannelUsed(unsigned int channel, bool used) override;
+        virtual void updateCoupling(unsigned int channel, DSO::Coupling coupling) override;
         virtual void updateSamplerate(DSO::ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) override;
         virtual void updateGain(unsigned channel, unsigned char gainIndex, unsigned gainId);
         virtual void updateOffset(unsigned int channel, unsigned short int offsetValue);
         virtual ErrorCode updateTriggerSource(bool special, unsigned int channel);
         virtual ErrorCode updateTriggerLevel(unsigned int channel, double level);
         virtual ErrorCode updateTriggerSlope(DSO::Slope slope);
+        virtual std::pair<double, unsigned int> computeBestSamplerate(double samplerate,
+                                                                      const DSO::ControlSamplerateLimits* limits,
+                                                                      bool maximum) const override;
+        /// Signed 8 bit values with 0x80 as 0 V, scaled to the input range. There is no hardware offset.
+        virtual double convertSample(unsigned gainID, double offsetReal, double code) const override;
 };
 
 }
@@ -97,3 +97,68 @@ enum class HT6022_InputRange
     IR_2V    = 0x05, /*!< -1V    to 1V    */
     IR_1V    = 0x0A  /*!< -500mv to 500mv */
 };
+
+/**
+  * @brief Number of channels, one byte per channel and sample, the channels are interleaved
+  */
+#define HT6022_CHANNELS 2
+
+/**
+  * @brief Firmware upload: Contiguous records in the code memory (below HT6022_FIRMWARE_CODE_END)
+  * are merged into chunks of up to HT6022_FIRMWARE_CHUNK bytes, other records write registers
+  * like CPUCS and are sent on their own. HT6022_FIRMWARE_STEP_CHUNKS chunks are sent per step.
+  */
+#define HT6022_FIRMWARE_CHUNK        1023
+#define HT6022_FIRMWARE_CODE_END     0x4000
+#define HT6022_FIRMWARE_STEP_CHUNKS  8
+
+/**
+  * @brief Samplerates below 100 kS/s, the lowest rate of HT6022_SampleRate (the downsampler
+  * HT6022_DECIMATION_BASE of 48 MHz), are sampled with 100 kS/s and decimated in software by an
+  * even factor of up to HT6022_DECIMATION_MAX.
+  */
+#define HT6022_DECIMATION_BASE       480
+#define HT6022_DECIMATION_MAX        1000
+
+/// The blocks of the sample stream. All but the one that is converted are queued as bulk transfers.
+#define HT6022_STREAM_BLOCKS         4
+
+#include "utils/transferBuffer.h"
+
+namespace Hantek60xx {
+
+    //////////////////////////////////////////////////////////////////////////////
+    ///
+    /// \brief The HT6022_SR_REQUEST builder, sets the samplerate of both channels.
+    class ControlSetSamplerate : public FixedTransferBuffer<HT6022_SR_SIZE>, public ControlUSB {
+        public:
+            ControlSetSamplerate() : FixedTransferBuffer(HT6022_SR_REQUEST) {
+                setSamplerate(HT6022_SampleRate::SR_1MSa);
+            }
+            void setSamplerate(HT6022_SampleRate samplerate) { byte<0>() = (unsigned char) samplerate; }
+    };
+
+    //////////////////////////////////////////////////////////////////////////////
+    ///
+    /// \brief The HT6022_IR1_REQUEST/HT6022_IR2_REQUEST builder, sets the input range of one channel.
+    template<unsigned char Request>
+    class ControlSetInputRange : public FixedTransferBuffer<HT6022_IR1_SIZE>, public ControlUSB {
+        public:
+            ControlSetInputRange() : FixedTransferBuffer<HT6022_IR1_SIZE>(Request) {
+                setInputRange(HT6022_InputRange::IR_10V);
+            }
+            void setInputRange(HT6022_InputRange range) { byte<0>() = (unsigned char) range; }
+    };
+    typedef ControlSetInputRange<HT6022_IR1_REQUEST> ControlSetInputRangeCH1;
+    typedef ControlSetInputRange<HT6022_IR2_REQUEST> ControlSetInputRangeCH2;
+
+    //////////////////////////////////////////////////////////////////////////////
+    ///
+    /// \brief The HT6022_READ_CONTROL_REQUEST builder, starts streaming samples to the bulk endpoint.
+    class ControlStartSampling : public FixedTransferBuffer<HT6022_READ_CONTROL_SIZE>, public ControlUSB {
+        public:
+            ControlStartSampling() : FixedTransferBuffer(HT6022_READ_CONTROL_REQUEST) {
+                byte<0>() = HT6022_READ_CONTROL_DATA;
+            }
+    };
+}
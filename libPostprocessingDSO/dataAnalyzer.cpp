@@ -22,8 +22,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <cmath>
-#include <fftw3.h>
 #include "dataAnalyzer.h"
+#include "frequencyCounter.h"
 #include "deviceBase.h"
 #include "errorcodes.h"
 #include "utils/timestampDebug.h"
@@ -32,28 +32,20 @@ namespace DSOAnalyser {
 
 DataAnalyzer::DataAnalyzer(std::shared_ptr<DSO::DeviceBase> device, AnalyserSettings* analyserSettings)
     : _analyserSettings(analyserSettings), _device(device) {
-        // lock analyse thread mutex
-        _new_data_arrived_mutex.lock();
-
-        // Connect to device
-        using namespace std::placeholders;
-        _device->_samplesAvailable = std::bind(&DataAnalyzer::data_from_device, this, _1);
-
         _analyserSettings->spectrumEnabled.resize(_device->getChannelCount());
 
-        // Create thread
-        _keep_thread_running = true;
-        _thread = std::unique_ptr<std::thread>(new std::thread(&DataAnalyzer::analyseThread,std::ref(*this)));
+        // Create the analyser task, it waits for data
+        _task = _executor->schedule([this]() { return analyse(); });
+
+        // Subscribe to the device frames, a slow analysis skips the older frames
+        _subscription = _device->_frameBus.subscribe([this](const DSO::SharedFrame& frame) { data_from_device(*frame); },
+                                                     2, DSO::Backpressure::DROP_OLDEST);
     }
 
 DataAnalyzer::~DataAnalyzer() {
-    _analyzed = [](){};
-    if (!_thread.get()) return;
-    _keep_thread_running = false;
-    _new_data_arrived_mutex.unlock();
-    if (_thread->joinable()) _thread->join();
-    _thread.reset();
-    _device->_samplesAvailable = [](const std::vector<std::vector<double> >&){};
+    // No analysis runs afterwards, so _analyzed is not called anymore
+    _device->_frameBus.unsubscribe(_subscription);
+    _executor->cancel(_task);
 }
 
 /// \brief Returns the analyzed data.
@@ -75,10 +67,14 @@ unsigned DataAnalyzer::sampleCount() const {
 /// \brief Returns the mutex for the data.
 /// \return Mutex for the analyzed data.
 std::mutex& DataAnalyzer::mutex() {
-    return _data_in_use_mutex;
+    return _dataMutex;
 }
 
-void DataAnalyzer::copySamples(const std::vector<std::vector<double>>& incomingData, double samplerate, bool append) {
+void DataAnalyzer::releaseData() {
+    _dataInUse = false;
+}
+
+void DataAnalyzer::copySamples(const std::vector<DSO::SampleBuffer>& incomingData, double samplerate, bool append) {
     size_t maxSamples = 0;
 
     // Adapt the number of channels for analyzed data
@@ -124,9 +120,12 @@ void DataAnalyzer::computeMathChannels()
     _analyzedData.resize(math_channel_id+1);
 
     // Calculate values and write them into the sample buffer
-    std::vector<double>::const_iterator ch1Iterator = _analyzedData[0].samples.voltage.sample.begin();
-    std::vector<double>::const_iterator ch2Iterator = _analyzedData[1].samples.voltage.sample.begin();
-    std::vector<double> &resultData = this->_analyzedData[math_channel_id].samples.voltage.sample;
+    DSO::SampleBuffer::const_iterator ch1Iterator = _analyzedData[0].samples.voltage.sample.begin();
+    DSO::SampleBuffer::const_iterator ch2Iterator = _analyzedData[1].samples.voltage.sample.begin();
+    DSO::SampleBuffer &resultData = this->_analyzedData[math_channel_id].samples.voltage.sample;
+    this->_analyzedData[math_channel_id].samples.voltage.interval = _analyzedData[0].samples.voltage.interval;
+    resultData.clear();
+    resultData.reserve(_maxSamples);
     switch(_analyserSettings->mathmode) {
         case MathMode::ADD_CH1_CH2:
             for(unsigned i=0;i<_maxSamples;++i)
@@ -143,150 +142,25 @@ void DataAnalyzer::computeMathChannels()
     }
 }
 
-void DataAnalyzer::computeFreqSpectrumPeak(unsigned& lastRecordLength, WindowFunction& lastWindow, double *window) {
+template<typename T>
+void DataAnalyzer::computeFreqSpectrumPeak(std::vector<SpectrumEngine<T>>& engines) {
+    // std::vector::resize needs movable elements, the engines own FFTW resources
+    if(engines.size() != this->_analyzedData.size())
+        engines = std::vector<SpectrumEngine<T>>(this->_analyzedData.size());
+
     for(unsigned channel = 0; channel < this->_analyzedData.size(); ++channel) {
         AnalyzedData *const channelData = &this->_analyzedData[channel];
-        if(channelData->samples.spectrum.sample.empty()) {
+        SpectrumEngine<T>& engine = engines[channel];
+        channelData->harmonics = HarmonicAnalysis();
+        if(channelData->samples.voltage.sample.size() < 2) {
             // Clear unused channels
             channelData->samples.spectrum.interval = 0;
             channelData->samples.spectrum.sample.clear();
+            engine.resize(0, 0);
             continue;
         }
 
-        // Calculate new window
         unsigned sampleCount = channelData->samples.voltage.sample.size();
-        bool sampleCountChanged = lastRecordLength != sampleCount;
-        if(lastWindow != _analyserSettings->spectrumWindow || sampleCountChanged) {
-            if(sampleCountChanged || !window) {
-                lastRecordLength = sampleCount;
-
-                if(window)
-                    fftw_free(window);
-                window = (double *) fftw_malloc(sizeof(double) * lastRecordLength);
-            }
-
-            unsigned windowEnd = lastRecordLength - 1;
-            lastWindow = _analyserSettings->spectrumWindow;
-
-            switch(_analyserSettings->spectrumWindow) {
-                case WINDOW_HAMMING:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 0.54 - 0.46 * cos(2.0 * M_PI * windowPosition / windowEnd);
-                    break;
-                case WINDOW_HANN:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 0.5 * (1.0 - cos(2.0 * M_PI * windowPosition / windowEnd));
-                    break;
-                case WINDOW_COSINE:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = sin(M_PI * windowPosition / windowEnd);
-                    break;
-                case WINDOW_LANCZOS:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition) {
-                        double sincParameter = (2.0 * windowPosition / windowEnd - 1.0) * M_PI;
-                        if(sincParameter == 0)
-                            *(window + windowPosition) = 1;
-                        else
-                            *(window + windowPosition) = sin(sincParameter) / sincParameter;
-                    }
-                    break;
-                case WINDOW_BARTLETT:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 2.0 / windowEnd * (windowEnd / 2 - abs(windowPosition - windowEnd / 2));
-                    break;
-                case WINDOW_TRIANGULAR:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 2.0 / lastRecordLength * (lastRecordLength / 2 - abs(windowPosition - windowEnd / 2));
-                    break;
-                case WINDOW_GAUSS:
-                    {
-                        double sigma = 0.4;
-                        for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                            *(window + windowPosition) = exp(-0.5 * pow(((windowPosition - windowEnd / 2) / (sigma * windowEnd / 2)), 2));
-                    }
-                    break;
-                case WINDOW_BARTLETTHANN:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 0.62 - 0.48 * abs(windowPosition / windowEnd - 0.5) - 0.38 * cos(2.0 * M_PI * windowPosition / windowEnd);
-                    break;
-                case WINDOW_BLACKMAN:
-                    {
-                        double alpha = 0.16;
-                        for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                            *(window + windowPosition) = (1 - alpha) / 2 - 0.5 * cos(2.0 * M_PI * windowPosition / windowEnd) + alpha / 2 * cos(4.0 * M_PI * windowPosition / windowEnd);
-                    }
-                    break;
-                //case WINDOW_KAISER:
-                    //TODO Spectrum WINDOW_KAISER
-                    //double alpha = 3.0;
-                    //for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        //*(window + windowPosition) = ;
-                    //break;
-                case WINDOW_NUTTALL:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 0.355768 - 0.487396 * cos(2 * M_PI * windowPosition / windowEnd) + 0.144232 * cos(4 * M_PI * windowPosition / windowEnd) - 0.012604 * cos(6 * M_PI * windowPosition / windowEnd);
-                    break;
-                case WINDOW_BLACKMANHARRIS:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 0.35875 - 0.48829 * cos(2 * M_PI * windowPosition / windowEnd) + 0.14128 * cos(4 * M_PI * windowPosition / windowEnd) - 0.01168 * cos(6 * M_PI * windowPosition / windowEnd);
-                    break;
-                case WINDOW_BLACKMANNUTTALL:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 0.3635819 - 0.4891775 * cos(2 * M_PI * windowPosition / windowEnd) + 0.1365995 * cos(4 * M_PI * windowPosition / windowEnd) - 0.0106411 * cos(6 * M_PI * windowPosition / windowEnd);
-                    break;
-                case WINDOW_FLATTOP:
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 1.0 - 1.93 * cos(2 * M_PI * windowPosition / windowEnd) + 1.29 * cos(4 * M_PI * windowPosition / windowEnd) - 0.388 * cos(6 * M_PI * windowPosition / windowEnd) + 0.032 * cos(8 * M_PI * windowPosition / windowEnd);
-                    break;
-                default: // WINDOW_RECTANGULAR
-                    for(unsigned windowPosition = 0; windowPosition < lastRecordLength; ++windowPosition)
-                        *(window + windowPosition) = 1.0;
-            }
-        }
-
-        // Set sampling interval
-        channelData->samples.spectrum.interval = 1.0 / channelData->samples.voltage.interval / sampleCount;
-
-        // Number of real/complex samples
-        unsigned dftLength = sampleCount / 2;
-
-        // Reallocate memory for samples if the sample count has changed
-        channelData->samples.spectrum.sample.resize(sampleCount);
-
-        // Create sample buffer and apply window
-        m_windowedValues.resize(sampleCount);
-        m_correlation.resize(sampleCount);
-
-        for(unsigned position = 0; position < sampleCount; ++position)
-            m_windowedValues[position] = window[position] * channelData->samples.voltage.sample[position];
-
-        // Do discrete real to half-complex transformation
-        /// \todo Check if record length is multiple of 2
-        /// \todo Reuse plan and use FFTW_MEASURE to get fastest algorithm
-        fftw_plan fftPlan = fftw_plan_r2r_1d(sampleCount, &m_windowedValues[0],
-                                             &channelData->samples.spectrum.sample.front(),
-                                             FFTW_R2HC, FFTW_ESTIMATE);
-        fftw_execute(fftPlan);
-        fftw_destroy_plan(fftPlan);
-
-        // Do an autocorrelation to get the frequency of the signal
-        double *conjugateComplex = &m_windowedValues[0]; // Reuse the windowedValues buffer
-
-        // Real values
-        unsigned position;
-        double correctionFactor = 1.0 / dftLength / dftLength;
-        conjugateComplex[0] = (channelData->samples.spectrum.sample[0] * channelData->samples.spectrum.sample[0]) * correctionFactor;
-        for(position = 1; position < dftLength; ++position)
-            conjugateComplex[position] = (channelData->samples.spectrum.sample[position] * channelData->samples.spectrum.sample[position] + channelData->samples.spectrum.sample[sampleCount - position] * channelData->samples.spectrum.sample[sampleCount - position]) * correctionFactor;
-        // Complex values, all zero for autocorrelation
-        conjugateComplex[dftLength] = (channelData->samples.spectrum.sample[dftLength] * channelData->samples.spectrum.sample[dftLength]) * correctionFactor;
-        for(++position; position < sampleCount; ++position)
-            conjugateComplex[position] = 0;
-
-        // Do half-complex to real inverse transformation
-        fftPlan = fftw_plan_r2r_1d(sampleCount, conjugateComplex, &m_correlation[0], FFTW_HC2R, FFTW_ESTIMATE);
-        fftw_execute(fftPlan);
-        fftw_destroy_plan(fftPlan);
 
         // Calculate peak-to-peak voltage
         double minimalVoltage, maximalVoltage;
@@ -301,41 +175,138 @@ void DataAnalyzer::computeFreqSpectrumPeak(unsigned& lastRecordLength, WindowFun
 
         channelData->amplitude = maximalVoltage - minimalVoltage;
 
-        // Get the frequency from the correlation results
-        double minimumCorrelation = m_correlation[0];
-        double peakCorrelation = 0;
-        unsigned peakPosition = 0;
+        // Count the periods to get the frequency of the signal
+        bool frequencyCounted = countFrequency(channelData->samples.voltage.sample, channelData->samples.voltage.interval,
+                                               minimalVoltage, maximalVoltage, channelData->frequency);
+
+        // The spectrum is only needed for display, phase and harmonic measurements or as fallback for noisy signals
+        bool spectrumEnabled = channel < _analyserSettings->spectrumEnabled.size() && _analyserSettings->spectrumEnabled[channel];
+        if(!spectrumEnabled && frequencyCounted && !_analyserSettings->phaseEnabled && !_analyserSettings->harmonicsEnabled) {
+            channelData->samples.spectrum.interval = 0;
+            channelData->samples.spectrum.sample.clear();
+            continue;
+        }
 
-        for(unsigned position = 1; position < sampleCount / 2; ++position) {
-            if(m_correlation[position] > peakCorrelation && m_correlation[position] > minimumCorrelation * 2) {
-                peakCorrelation = m_correlation[position];
-                peakPosition = position;
+        // Only analyze the samples between the gate markers if requested
+        unsigned firstSample = 0;
+        unsigned analyzedCount = sampleCount;
+        if(_analyserSettings->spectrumGateEnabled) {
+            const double interval = channelData->samples.voltage.interval;
+            double gateStart = std::min(_analyserSettings->spectrumGateStart, _analyserSettings->spectrumGateEnd);
+            double gateEnd = std::max(_analyserSettings->spectrumGateStart, _analyserSettings->spectrumGateEnd);
+            unsigned gateFirst = (unsigned) std::min(std::max(floor(gateStart / interval), 0.0), (double) sampleCount);
+            unsigned gateLast = (unsigned) std::min(std::max(ceil(gateEnd / interval), 0.0), (double) sampleCount);
+            if(gateLast > gateFirst + 1) {
+                firstSample = gateFirst;
+                analyzedCount = gateLast - gateFirst;
             }
-            else if(m_correlation[position] < minimumCorrelation)
-                minimumCorrelation = m_correlation[position];
         }
 
-        // Calculate the frequency in Hz
-        if(peakPosition)
-            channelData->frequency = 1.0 / (channelData->samples.voltage.interval * peakPosition);
-        else
-            channelData->frequency = 0;
+        // Choose an FFT friendly size, the additional points are zero-padded.
+        // Buffers and plans are only reallocated if that size changed.
+        // Cross-correlations need at least twice the length to avoid wrap-around.
+        unsigned zeroPadding = std::max(_analyserSettings->spectrumZeroPadding, _analyserSettings->phaseEnabled ? 2u : 1u);
+        unsigned fftSize = SpectrumEngine<T>::fastSize(analyzedCount * zeroPadding);
+        engine.resize(fftSize, analyzedCount);
+        engine.setWindow(_analyserSettings->spectrumWindow);
+
+        // Set sampling interval
+        channelData->samples.spectrum.interval = 1.0 / channelData->samples.voltage.interval / fftSize;
+
+        // Number of real/complex samples
+        unsigned dftLength = analyzedCount / 2;
+
+        // Apply window and do the real to complex transformation
+        engine.transform(channelData->samples.voltage.sample, firstSample);
+
+        // Fall back to the interpolated spectrum peak if counting failed
+        if(!frequencyCounted)
+            channelData->frequency = engine.peakBin() * channelData->samples.spectrum.interval;
+
+        // Distortion figures from the same spectrum
+        if(_analyserSettings->harmonicsEnabled)
+            analyseHarmonics(engine, _analyserSettings->spectrumWindow, _analyserSettings->harmonicsCount,
+                             channelData->samples.spectrum.interval, _harmonicsMask, channelData->harmonics);
 
         // Finally calculate the real spectrum if we want it
-        if(_analyserSettings->spectrumEnabled[channel]) {
+        if(spectrumEnabled) {
+            channelData->samples.spectrum.sample.resize(engine.bins());
+
             // Convert values into dB (Relative to the reference level)
             double offset = 60 - _analyserSettings->spectrumReference - 20 * log10(dftLength);
             double offsetLimit = _analyserSettings->spectrumLimit - _analyserSettings->spectrumReference;
-            for(double& spectrumIterator: channelData->samples.spectrum.sample) {
-                double value = 20 * log10(fabs(channelData->samples.spectrum.sample[position])) + offset;
+            for(unsigned bin = 0; bin < engine.bins(); ++bin) {
+                double value = 10 * log10(engine.power(bin)) + offset;
 
                 // Check if this value has to be limited
                 if(offsetLimit > value)
                     value = offsetLimit;
 
-                spectrumIterator = value;
+                channelData->samples.spectrum.sample[bin] = value;
+            }
+        } else
+            channelData->samples.spectrum.sample.clear();
+    }
+}
+
+template<typename T>
+void DataAnalyzer::computePhaseDelay(std::vector<SpectrumEngine<T>>& engines) {
+    for(AnalyzedData& channelData: _analyzedData) {
+        channelData.phase = 0;
+        channelData.delay = 0;
+    }
+
+    const unsigned reference = _analyserSettings->phaseReference;
+    if(!_analyserSettings->phaseEnabled || reference >= _analyzedData.size() || !engines[reference].size())
+        return;
+
+    const AnalyzedData& referenceData = _analyzedData[reference];
+    const SpectrumEngine<T>& referenceEngine = engines[reference];
+    const double interval = referenceData.samples.voltage.interval;
+    const int size = referenceEngine.size();
+
+    // Limit the search to half a period, so the phase stays within +-180 degrees
+    int maxLag = referenceEngine.length() - 1;
+    if(referenceData.frequency > 0)
+        maxLag = std::min(maxLag, (int)(0.5 / (referenceData.frequency * interval)));
+    if(maxLag < 1)
+        return;
+
+    for(unsigned channel = 0; channel < _analyzedData.size(); ++channel) {
+        if(channel == reference || (int) engines[channel].size() != size)
+            continue;
+
+        const T* correlation = engines[channel].crossCorrelation(referenceEngine);
+        auto correlationAt = [correlation, size](int lag) -> double {
+            return correlation[(lag + size) % size];
+        };
+
+        // Find the correlation peak
+        int peakLag = 0;
+        double peakValue = correlation[0];
+        for(int lag = -maxLag; lag <= maxLag; ++lag) {
+            if(correlationAt(lag) > peakValue) {
+                peakValue = correlationAt(lag);
+                peakLag = lag;
             }
         }
+
+        // Parabolic interpolation for sub-sample resolution
+        const double left = correlationAt(peakLag - 1);
+        const double right = correlationAt(peakLag + 1);
+        const double denominator = left - 2 * peakValue + right;
+        const double lag = denominator < 0 ? peakLag + 0.5 * (left - right) / denominator : peakLag;
+
+        AnalyzedData& channelData = _analyzedData[channel];
+        channelData.delay = lag * interval;
+        if(referenceData.frequency > 0) {
+            double phase = fmod(360.0 * channelData.delay * referenceData.frequency, 360.0);
+            if(phase > 180.0)
+                phase -= 360.0;
+            else if(phase <= -180.0)
+                phase += 360.0;
+            channelData.phase = phase;
+        }
     }
 }
 
@@ -354,38 +325,49 @@ std::shared_ptr<DSO::DeviceBase> DataAnalyzer::getDevice() const
     return _device;
 }
 
-void DataAnalyzer::analyseThread() {
-    unsigned lastRecordLength = 0; ///< The record length of the previously analyzed data
-    WindowFunction lastWindow     = WINDOW_UNDEFINED; ///< The previously used dft window function
-    double *window                = nullptr; ///< The array for the dft window factors
+DSO::Executor::time_point DataAnalyzer::analyse() {
+    if(!_newData.exchange(false))
+        return DSO::Executor::idle;
 
-    while(_keep_thread_running) {
-        _new_data_arrived_mutex.lock();
+    {
+        std::lock_guard<std::mutex> lock(_dataMutex);
         computeMathChannels();
-        computeFreqSpectrumPeak(lastRecordLength, lastWindow, window);
-        _analyzed();
-
-        //static unsigned long id = 0;
-        //(void)id;
-        //timestampDebug("Analyzed packet " << id++);
+        if(_analyserSettings->spectrumPrecision == SpectrumPrecision::DOUBLE) {
+            _enginesSingle.clear();
+            computeFreqSpectrumPeak(_enginesDouble);
+            computePhaseDelay(_enginesDouble);
+        } else {
+            _enginesDouble.clear();
+            computeFreqSpectrumPeak(_enginesSingle);
+            computePhaseDelay(_enginesSingle);
+        }
     }
+    _analyzed();
+
+    //static unsigned long id = 0;
+    //(void)id;
+    //timestampDebug("Analyzed packet " << id++);
+    return DSO::Executor::idle;
 }
 
 /// \brief Starts the analyzing of new input data.
-/// \param data The data arrays with the input data.
-/// \param size The sizes of the data arrays.
-/// \param samplerate The samplerate for all input data.
-/// \param append The data will be appended to the previously analyzed data (Roll mode).
-/// \param mutex The mutex for all input data.
-void DataAnalyzer::data_from_device(const std::vector<std::vector<double>>& data) {
-    // Lock the device thread, make a copy of the sample data, unlock the device thread.
-    // Previous analysis still running, drop the new data
-    if(!_data_in_use_mutex.try_lock()) {
+/// \param frame The input data and the settings it was acquired with. The samplerate
+/// and roll mode are taken from the frame, not from the device, because the device
+/// may already use different settings.
+void DataAnalyzer::data_from_device(const DSO::dsoFrame& frame) {
+    // Make a copy of the sample data, the subscription task continues afterwards.
+    // Previous analysis still running or not yet displayed, drop the new data
+    if(_dataInUse.exchange(true)) {
         timestampDebug("Analyzer overload, dropping packets!");
         return;
     }
-    copySamples(data, _device->getSamplerate(), _device->isRollingMode());
-    _new_data_arrived_mutex.unlock(); ///< New data arrived, unlock analyse thread
+    {
+        std::lock_guard<std::mutex> lock(_dataMutex);
+        copySamples(frame.samples, frame.settings.samplerate, frame.settings.rollMode);
+        _frameSettings = frame.settings;
+    }
+    _newData = true;
+    _executor->wake(_task); ///< New data arrived, run the analyser task
 }
 
 }
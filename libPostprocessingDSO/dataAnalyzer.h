@@ -23,13 +23,17 @@
 #pragma once
 
 #include <vector>
-#include <thread>
 #include <mutex>
 #include <functional>
 #include <memory>
 #include <atomic>
 
 #include "dataAnalyzerSettings.h"
+#include "dsoFrame.h"
+#include "frameBus.h"
+#include "utils/executor.h"
+#include "spectrumEngine.h"
+#include "harmonicAnalysis.h"
 
 namespace DSO {
     class DeviceBase;
@@ -41,7 +45,7 @@ namespace DSOAnalyser {
 /// \struct SampleValues                                          dataanalyzer.h
 /// \brief Struct for a array of sample values.
 struct SampleValues {
-    std::vector<double> sample; ///< Vector holding the sampling data
+    DSO::SampleBuffer sample; ///< Vector holding the sampling data, from the FrameBufferPool
     double interval = 0.0; ///< The interval between two sample values
 };
 
@@ -60,6 +64,9 @@ struct AnalyzedData {
     SampleData samples; ///< Voltage and spectrum values
     double amplitude = 0.0; ///< The amplitude of the signal
     double frequency = 0.0; ///< The frequency of the signal
+    double phase = 0.0; ///< The phase relative to the reference channel in degrees
+    double delay = 0.0; ///< The delay relative to the reference channel in s
+    HarmonicAnalysis harmonics; ///< Distortion and noise figures
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -77,16 +84,22 @@ class DataAnalyzer {
         const std::vector<AnalyzedData>& getAllData() const {return _analyzedData;}
         unsigned int sampleCount() const;
 
-        /// Return a mutex that have to be locked while the analysed data
-        /// vector (acquired via data()) is in use and unlocked after that.
-        /// This class can not continue analysing incoming data until the
-        /// mutex is unlocked.
+        /// The device settings of the last analyzed frame. Same locking rules as for data().
+        const DSO::dsoFrameSettings& frameSettings() const {return _frameSettings;}
+
+        /// Return a mutex that has to be locked while the analysed data
+        /// vector (acquired via data()) is read. The analyser task holds it
+        /// while it writes the data.
         std::mutex& mutex();
 
+        /// Release the data of the last _analyzed signal. This class drops
+        /// incoming data until the data is released. May be called by any thread.
+        void releaseData();
+
         /// Signal: Data has been analyzed. Get the data via
         /// data(), get the sample count via sampleCount().
-        /// You must unlock the analysed mutex (get it by mutex())
-        /// after you have done your processing on data()/getAllData().
+        /// You must call releaseData() after you have done your
+        /// processing on data()/getAllData().
         std::function<void()> _analyzed = [](){};
 
         std::shared_ptr<DSO::DeviceBase> getDevice() const;
@@ -95,21 +108,26 @@ class DataAnalyzer {
 
 private:
 
-        /// Analyse incoming data from a device in a separate thread. Will make a copy of data for this purpose.
-        /// This method is connected to the device in the constructor.
-        void data_from_device(const std::vector<std::vector<double> >& data);
-
-        /// A separate thread that runs forever and analyses incoming data from a device.
-        /// Works with a copy of the device data. An anaylse iteration is started as soon
-        /// as _mutex is unlocked in data_from_device. _analyseIsRunning will be set true
-        /// for an iteration.
-        void analyseThread();
-        /// Analyses the data from the dso (in a separate thread).
-        void copySamples(const std::vector<std::vector<double>>& incomingData, double samplerate, bool append);
+        /// Analyse incoming data from a device in the analyser task. Will make a copy of data for this purpose.
+        /// Called by the frame bus subscription of the constructor.
+        void data_from_device(const DSO::dsoFrame& frame);
+
+        /// The analyser task on the shared executor. Works with a copy of the device data.
+        /// An analyse iteration is started as soon as data_from_device wakes the task.
+        /// \return Executor::idle, the task waits for the next data.
+        DSO::Executor::time_point analyse();
+        /// Analyses the data from the dso (in the analyser task).
+        void copySamples(const std::vector<DSO::SampleBuffer>& incomingData, double samplerate, bool append);
         /// Computes the math channels
         void computeMathChannels();
-        /// Calculate frequencies, peak-to-peak voltages and spectrums (in a separate thread).
-        void computeFreqSpectrumPeak(unsigned& lastRecordLength, WindowFunction& lastWindow, double *window);
+        /// Calculate frequencies, peak-to-peak voltages and spectrums (in the analyser task).
+        /// \param engines One spectrum engine per channel in the selected precision.
+        template<typename T>
+        void computeFreqSpectrumPeak(std::vector<SpectrumEngine<T>>& engines);
+        /// Calculate phase and delay of all channels against the reference channel.
+        /// Works on the spectra computed by computeFreqSpectrumPeak().
+        template<typename T>
+        void computePhaseDelay(std::vector<SpectrumEngine<T>>& engines);
 
         ///////// Input /////////
 
@@ -123,14 +141,23 @@ private:
         std::vector<AnalyzedData> _analyzedData;
         /// The maximum record length of the analyzed data
         unsigned int _maxSamples = 0;
-
-        /// A mutex that looks the analysing process to allow only one computation at a time
-        std::mutex _new_data_arrived_mutex;
-        std::mutex _data_in_use_mutex;
-        std::vector<double> m_windowedValues, m_correlation;
-        std::unique_ptr<std::thread> _thread;
-        bool _keep_thread_running;
+        /// The device settings of the analyzed data
+        DSO::dsoFrameSettings _frameSettings;
+
+        /// New data has been copied and not analysed yet
+        std::atomic<bool> _newData{false};
+        /// The analysed data was not released yet, incoming data is dropped until then
+        std::atomic<bool> _dataInUse{false};
+        /// Locked while the analysed data is written or read
+        std::mutex _dataMutex;
+        /// Per channel FFT buffers and plans, only the selected precision is allocated
+        std::vector<SpectrumEngine<float>> _enginesSingle;
+        std::vector<SpectrumEngine<double>> _enginesDouble;
+        std::vector<bool> _harmonicsMask; ///< Temporary buffer for the harmonic analysis
+        std::shared_ptr<DSO::Executor> _executor = DSO::Executor::shared(DSO::ThreadRole::ANALYSER);
+        DSO::Executor::TaskHandle _task;
         std::shared_ptr<DSO::DeviceBase> _device;
+        DSO::FrameBus::SubscriptionHandle _subscription; ///< The subscription to the device frames
 };
 
 }
@@ -39,6 +39,14 @@ enum class MathMode {
     SUB_CH1_FROM_CH2                     ///< Subtract CH1 from CH2
 };
 
+//////////////////////////////////////////////////////////////////////////////
+/// \enum SpectrumPrecision                                              dso.h
+/// \brief The floating point precision of the spectrum calculation.
+enum class SpectrumPrecision {
+    SINGLE,                          ///< 32-bit float FFT, enough for 8-bit ADC data
+    DOUBLE                           ///< 64-bit double FFT
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \struct OpenHantekSettingsScope                                          settings.h
 /// \brief Holds the settings for the oscilloscope.
@@ -49,6 +57,15 @@ struct AnalyserSettings {
     WindowFunction spectrumWindow = WINDOW_RECTANGULAR; ///< Window function for DFT
     double spectrumReference      = 0.0; ///< Reference level for spectrum in dBm
     double spectrumLimit          = 1.0; ///< Minimum magnitude of the spectrum (Avoids peaks)
+    SpectrumPrecision spectrumPrecision = SpectrumPrecision::SINGLE; ///< Precision of the DFT
+    unsigned spectrumZeroPadding  = 1; ///< The DFT size is at least this factor times the analyzed sample count
+    bool spectrumGateEnabled      = false; ///< Only analyze the time span between the gate start and end
+    double spectrumGateStart      = 0.0; ///< Gate start in s, relative to the first sample
+    double spectrumGateEnd        = 0.0; ///< Gate end in s, relative to the first sample
+    bool phaseEnabled             = false; ///< Measure phase and delay of all channels against phaseReference
+    unsigned phaseReference       = 0; ///< The reference channel for phase and delay measurements
+    bool harmonicsEnabled         = false; ///< Calculate THD, SNR, SINAD, SFDR and ENOB
+    unsigned harmonicsCount       = 5; ///< Number of harmonics after the fundamental
 };
 
 }
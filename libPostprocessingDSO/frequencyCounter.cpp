@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  frequencyCounter.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <algorithm>
+#include "frequencyCounter.h"
+
+namespace DSOAnalyser {
+
+bool countFrequency(const DSO::SampleBuffer& samples, double interval,
+                    double minimum, double maximum, double& frequency) {
+    frequency = 0;
+    const double amplitude = maximum - minimum;
+    if(samples.size() < 3 || amplitude <= 0 || interval <= 0)
+        return false;
+
+    const double threshold = (maximum + minimum) / 2;
+    const double lowLevel = threshold - amplitude * FREQUENCYCOUNTER_HYSTERESIS / 2;
+    const double highLevel = threshold + amplitude * FREQUENCYCOUNTER_HYSTERESIS / 2;
+
+    const double* sample = samples.data();
+    const unsigned sampleCount = samples.size();
+
+    bool armed = false;         // The signal was below the lower hysteresis level
+    double candidate = 0;       // Last rising threshold crossing since the signal was armed
+    double firstCrossing = 0, lastCrossing = 0;
+    unsigned crossings = 0;
+    double periodSum = 0, periodSquareSum = 0;
+
+    for(unsigned position = 1; position < sampleCount; ++position) {
+        const double previous = sample[position - 1];
+        const double current = sample[position];
+
+        armed |= current < lowLevel;
+        if(!armed)
+            continue;
+
+        // Interpolate the crossing position between the two samples
+        if(previous < threshold && current >= threshold)
+            candidate = (position - 1) + (threshold - previous) / (current - previous);
+
+        // The crossing only counts once the upper hysteresis level is reached
+        if(current >= highLevel) {
+            armed = false;
+            if(crossings) {
+                const double period = candidate - lastCrossing;
+                periodSum += period;
+                periodSquareSum += period * period;
+            } else
+                firstCrossing = candidate;
+            lastCrossing = candidate;
+            ++crossings;
+        }
+    }
+
+    if(crossings < 2)
+        return false;
+
+    // Average over all periods, the sum of the single periods equals the distance
+    // between the first and the last crossing
+    const unsigned periods = crossings - 1;
+    const double meanPeriod = (lastCrossing - firstCrossing) / periods;
+    if(meanPeriod <= 0)
+        return false;
+
+    // Reject noisy signals whose single periods differ too much
+    if(periods > 1) {
+        const double variance = std::max(periodSquareSum / periods - (periodSum / periods) * (periodSum / periods), 0.0);
+        if(sqrt(variance) > meanPeriod * FREQUENCYCOUNTER_MAX_JITTER)
+            return false;
+    }
+
+    frequency = 1.0 / (meanPeriod * interval);
+    return true;
+}
+
+}
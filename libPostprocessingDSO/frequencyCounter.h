@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+/// \brief Declares the zero-crossing frequency counter.
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "utils/frameBufferPool.h"
+
+namespace DSOAnalyser {
+
+/// Hysteresis around the threshold, relative to the peak-to-peak voltage
+#define FREQUENCYCOUNTER_HYSTERESIS 0.1
+/// Maximum standard deviation of the single periods, relative to the mean period.
+/// Signals with a higher jitter are considered noisy.
+#define FREQUENCYCOUNTER_MAX_JITTER 0.05
+
+/// \brief Measure the frequency of a periodic signal by counting rising threshold crossings.
+/// The threshold is the middle between minimum and maximum, a crossing is only
+/// accepted after the signal was below the lower and then above the upper
+/// hysteresis level. The crossing time is linearly interpolated between the two
+/// neighbouring samples and the period is averaged over all periods in the record.
+/// \param samples The time-domain voltage values.
+/// \param interval The time between two samples in s.
+/// \param minimum The minimal value of the samples.
+/// \param maximum The maximal value of the samples.
+/// \param frequency The measured frequency in Hz.
+/// \return false if less than one full period was found or the periods jitter too much.
+bool countFrequency(const DSO::SampleBuffer& samples, double interval,
+                    double minimum, double maximum, double& frequency);
+
+}
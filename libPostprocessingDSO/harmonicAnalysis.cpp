@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  harmonicAnalysis.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <algorithm>
+#include "harmonicAnalysis.h"
+#include "spectrumEngine.h"
+
+namespace DSOAnalyser {
+
+/// \brief Return the leakage width of a window function.
+/// This is the main lobe plus the sidelobes that are above the noise floor of
+/// an 8-bit ADC, so that the leaked power is assigned to the tone.
+/// \param windowFunction The window function.
+/// \return The half width in bins of a not zero-padded transform.
+static double leakageBins(WindowFunction windowFunction) {
+    switch(windowFunction) {
+        case WINDOW_RECTANGULAR:
+            return 3;
+        case WINDOW_COSINE:
+        case WINDOW_LANCZOS:
+        case WINDOW_HAMMING:
+        case WINDOW_BARTLETT:
+        case WINDOW_TRIANGULAR:
+            return 4;
+        case WINDOW_GAUSS:
+        case WINDOW_BARTLETTHANN:
+            return 5;
+        case WINDOW_HANN:
+        case WINDOW_BLACKMAN:
+        case WINDOW_NUTTALL:
+        case WINDOW_BLACKMANHARRIS:
+        case WINDOW_BLACKMANNUTTALL:
+            return 6;
+        case WINDOW_FLATTOP:
+            return 7;
+        default:
+            return 6;
+    }
+}
+
+template<typename T>
+void analyseHarmonics(const SpectrumEngine<T>& engine, WindowFunction windowFunction,
+                      unsigned harmonicCount, double binInterval,
+                      std::vector<bool>& mask, HarmonicAnalysis& result) {
+    result = HarmonicAnalysis();
+
+    const unsigned bins = engine.bins();
+    if(!engine.length() || bins < 8)
+        return;
+
+    // Leakage width, zero-padding widens the lobes by the padding factor
+    const unsigned lobe = (unsigned) ceil(leakageBins(windowFunction) * engine.size() / engine.length());
+
+    mask.assign(bins, false);
+
+    // Sums the power of a lobe around the given bin and marks it as assigned
+    auto lobePower = [&](unsigned center, double& peak) -> double {
+        const unsigned first = center > lobe ? center - lobe : 0;
+        const unsigned last = std::min(center + lobe, bins - 1);
+        double sum = 0;
+        peak = 0;
+        for(unsigned bin = first; bin <= last; ++bin) {
+            if(mask[bin])
+                continue;
+            mask[bin] = true;
+            const double binPower = engine.power(bin);
+            sum += binPower;
+            peak = std::max(peak, binPower);
+        }
+        return sum;
+    };
+
+    // DC is neither signal nor noise
+    double dcPeak;
+    lobePower(0, dcPeak);
+
+    // Fundamental
+    const double fundamentalBin = engine.peakBin();
+    if(fundamentalBin <= lobe || fundamentalBin >= bins - 1)
+        return;
+    double fundamentalPeak;
+    const double fundamentalPower = lobePower((unsigned) lround(fundamentalBin), fundamentalPeak);
+    if(fundamentalPower <= 0)
+        return;
+
+    // Harmonics
+    double harmonicPower = 0;
+    unsigned harmonics = 0;
+    for(unsigned harmonic = 2; harmonic <= harmonicCount + 1; ++harmonic) {
+        const unsigned center = (unsigned) lround(fundamentalBin * harmonic);
+        if(center + lobe >= bins)
+            break;
+        double peak;
+        harmonicPower += lobePower(center, peak);
+        ++harmonics;
+    }
+
+    // Noise is everything that was not assigned yet, the largest spur is the
+    // highest not fundamental bin outside the DC lobe
+    double noisePower = 0;
+    double spurPeak = 0;
+    for(unsigned bin = lobe + 1; bin < bins; ++bin) {
+        const double binPower = engine.power(bin);
+        if(!mask[bin])
+            noisePower += binPower;
+        if(fabs(bin - fundamentalBin) > lobe)
+            spurPeak = std::max(spurPeak, binPower);
+    }
+
+    const double minimalPower = 1e-30;
+    result.valid = true;
+    result.fundamental = fundamentalBin * binInterval;
+    result.harmonics = harmonics;
+    result.thd = 10 * log10(std::max(harmonicPower, minimalPower) / fundamentalPower);
+    result.snr = 10 * log10(fundamentalPower / std::max(noisePower, minimalPower));
+    result.sinad = 10 * log10(fundamentalPower / std::max(noisePower + harmonicPower, minimalPower));
+    result.sfdr = 10 * log10(fundamentalPeak / std::max(spurPeak, minimalPower));
+    result.enob = (result.sinad - 1.76) / 6.02;
+}
+
+template void analyseHarmonics<float>(const SpectrumEngine<float>&, WindowFunction, unsigned, double,
+                                      std::vector<bool>&, HarmonicAnalysis&);
+template void analyseHarmonics<double>(const SpectrumEngine<double>&, WindowFunction, unsigned, double,
+                                       std::vector<bool>&, HarmonicAnalysis&);
+
+}
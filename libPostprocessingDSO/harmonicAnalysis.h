@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+/// \brief Declares the harmonic analysis of a spectrum.
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+
+#include "dataAnalyzerSettings.h"
+
+namespace DSOAnalyser {
+
+template<typename T> class SpectrumEngine;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \struct HarmonicAnalysis                                  harmonicAnalysis.h
+/// \brief Distortion and noise figures of one channel.
+struct HarmonicAnalysis {
+    bool valid = false;         ///< False if no fundamental was found
+    double fundamental = 0.0;   ///< Frequency of the fundamental in Hz
+    unsigned harmonics = 0;     ///< Number of harmonics below the nyquist frequency
+    double thd = 0.0;           ///< Total harmonic distortion in dB
+    double snr = 0.0;           ///< Signal to noise ratio in dB
+    double sinad = 0.0;         ///< Signal to noise and distortion ratio in dB
+    double sfdr = 0.0;          ///< Spurious free dynamic range in dBc
+    double enob = 0.0;          ///< Effective number of bits
+};
+
+/// \brief Locate the fundamental and its harmonics in the last transform of an engine.
+/// The power of every tone is summed over the leakage width of the window
+/// function, scaled by the zero-padding factor. Everything else except DC is noise.
+/// \param engine The engine holding the spectrum of the current frame.
+/// \param windowFunction The window function the spectrum was computed with.
+/// \param harmonicCount The number of harmonics after the fundamental.
+/// \param binInterval The frequency step between two bins in Hz.
+/// \param mask Temporary buffer that marks already assigned bins.
+/// \param result The analysis results.
+template<typename T>
+void analyseHarmonics(const SpectrumEngine<T>& engine, WindowFunction windowFunction,
+                      unsigned harmonicCount, double binInterval,
+                      std::vector<bool>& mask, HarmonicAnalysis& result);
+
+}
@@ -22,9 +22,9 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-SOURCES += dataAnalyzer.cpp
+SOURCES += dataAnalyzer.cpp spectrumEngine.cpp frequencyCounter.cpp harmonicAnalysis.cpp
 
-HEADERS += dataAnalyzer.h  dataAnalyzerSettings.h
+HEADERS += dataAnalyzer.h  dataAnalyzerSettings.h spectrumEngine.h frequencyCounter.h harmonicAnalysis.h
 unix {
     target.path = /usr/lib
     INSTALLS += target
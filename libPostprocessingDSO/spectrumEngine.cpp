@@ -0,0 +1,263 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  spectrumEngine.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include "spectrumEngine.h"
+
+namespace DSOAnalyser {
+
+/// \brief Calculate the factors of the given window function.
+/// \param windowFunction The window function.
+/// \param window The array for the factors.
+/// \param length The number of factors.
+static void computeWindow(WindowFunction windowFunction, std::vector<double>& window, unsigned length) {
+    window.resize(length);
+    const double windowEnd = length > 1 ? length - 1 : 1;
+    const double windowCenter = windowEnd / 2;
+
+    switch(windowFunction) {
+        case WINDOW_HAMMING:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 0.54 - 0.46 * cos(2.0 * M_PI * windowPosition / windowEnd);
+            break;
+        case WINDOW_HANN:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 0.5 * (1.0 - cos(2.0 * M_PI * windowPosition / windowEnd));
+            break;
+        case WINDOW_COSINE:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = sin(M_PI * windowPosition / windowEnd);
+            break;
+        case WINDOW_LANCZOS:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition) {
+                double sincParameter = (2.0 * windowPosition / windowEnd - 1.0) * M_PI;
+                if(sincParameter == 0)
+                    window[windowPosition] = 1;
+                else
+                    window[windowPosition] = sin(sincParameter) / sincParameter;
+            }
+            break;
+        case WINDOW_BARTLETT:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 2.0 / windowEnd * (windowCenter - fabs(windowPosition - windowCenter));
+            break;
+        case WINDOW_TRIANGULAR:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 2.0 / length * (length / 2.0 - fabs(windowPosition - windowCenter));
+            break;
+        case WINDOW_GAUSS:
+            {
+                double sigma = 0.4;
+                for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                    window[windowPosition] = exp(-0.5 * pow(((windowPosition - windowCenter) / (sigma * windowCenter)), 2));
+            }
+            break;
+        case WINDOW_BARTLETTHANN:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 0.62 - 0.48 * fabs(windowPosition / windowEnd - 0.5) - 0.38 * cos(2.0 * M_PI * windowPosition / windowEnd);
+            break;
+        case WINDOW_BLACKMAN:
+            {
+                double alpha = 0.16;
+                for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                    window[windowPosition] = (1 - alpha) / 2 - 0.5 * cos(2.0 * M_PI * windowPosition / windowEnd) + alpha / 2 * cos(4.0 * M_PI * windowPosition / windowEnd);
+            }
+            break;
+        //case WINDOW_KAISER:
+            //TODO Spectrum WINDOW_KAISER
+            //double alpha = 3.0;
+            //for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                //window[windowPosition] = ;
+            //break;
+        case WINDOW_NUTTALL:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 0.355768 - 0.487396 * cos(2 * M_PI * windowPosition / windowEnd) + 0.144232 * cos(4 * M_PI * windowPosition / windowEnd) - 0.012604 * cos(6 * M_PI * windowPosition / windowEnd);
+            break;
+        case WINDOW_BLACKMANHARRIS:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 0.35875 - 0.48829 * cos(2 * M_PI * windowPosition / windowEnd) + 0.14128 * cos(4 * M_PI * windowPosition / windowEnd) - 0.01168 * cos(6 * M_PI * windowPosition / windowEnd);
+            break;
+        case WINDOW_BLACKMANNUTTALL:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 0.3635819 - 0.4891775 * cos(2 * M_PI * windowPosition / windowEnd) + 0.1365995 * cos(4 * M_PI * windowPosition / windowEnd) - 0.0106411 * cos(6 * M_PI * windowPosition / windowEnd);
+            break;
+        case WINDOW_FLATTOP:
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 1.0 - 1.93 * cos(2 * M_PI * windowPosition / windowEnd) + 1.29 * cos(4 * M_PI * windowPosition / windowEnd) - 0.388 * cos(6 * M_PI * windowPosition / windowEnd) + 0.032 * cos(8 * M_PI * windowPosition / windowEnd);
+            break;
+        default: // WINDOW_RECTANGULAR
+            for(unsigned windowPosition = 0; windowPosition < length; ++windowPosition)
+                window[windowPosition] = 1.0;
+    }
+}
+
+template<typename T>
+unsigned SpectrumEngine<T>::fastSize(unsigned minimum) {
+    if(minimum <= 1)
+        return 1;
+
+    uint64_t best = 1ull << 32;
+    for(uint64_t power5 = 1; power5 < best; power5 *= 5) {
+        for(uint64_t power35 = power5; power35 < best; power35 *= 3) {
+            uint64_t size = power35;
+            while(size < minimum)
+                size *= 2;
+            if(size < best)
+                best = size;
+        }
+    }
+    return (unsigned) best;
+}
+
+template<typename T>
+SpectrumEngine<T>::~SpectrumEngine() {
+    release();
+}
+
+template<typename T>
+void SpectrumEngine<T>::release() {
+    if(_forward) FFTW<T>::destroy(_forward);
+    if(_inverse) FFTW<T>::destroy(_inverse);
+    _forward = _inverse = nullptr;
+    FFTW<T>::free(_window);
+    FFTW<T>::free(_input);
+    FFTW<T>::free(_correlation);
+    FFTW<T>::free(_spectrum);
+    FFTW<T>::free(_scratch);
+    _window = _input = _correlation = nullptr;
+    _spectrum = _scratch = nullptr;
+    _size = _length = _windowLength = 0;
+}
+
+template<typename T>
+void SpectrumEngine<T>::resize(unsigned size, unsigned length) {
+    length = std::min(length, size);
+    if(size == _size) {
+        _length = length;
+        return;
+    }
+    release();
+    if(!size)
+        return;
+
+    _length = length;
+
+    _size = size;
+    _window      = (T*) FFTW<T>::malloc(sizeof(T) * _size);
+    _input       = (T*) FFTW<T>::malloc(sizeof(T) * _size);
+    _spectrum    = (Complex*) FFTW<T>::malloc(sizeof(Complex) * bins());
+
+    // Plans are created once per size and reused for every frame
+    _forward = FFTW<T>::r2c(_size, _input, _spectrum);
+
+    // Force a recalculation of the window factors
+    _windowFunction = WINDOW_UNDEFINED;
+}
+
+template<typename T>
+void SpectrumEngine<T>::setWindow(WindowFunction windowFunction) {
+    if((windowFunction == _windowFunction && _length == _windowLength) || !_size)
+        return;
+    _windowFunction = windowFunction;
+    _windowLength = _length;
+
+    // The factors are calculated in double precision and stored in the engine precision
+    std::vector<double> window;
+    computeWindow(windowFunction, window, _length);
+    for(unsigned position = 0; position < _length; ++position)
+        _window[position] = (T) window[position];
+}
+
+template<typename T>
+void SpectrumEngine<T>::transform(const DSO::SampleBuffer& samples, unsigned first) {
+    T* __restrict input = _input;
+    const T* __restrict window = _window;
+    const double* __restrict sample = samples.data() + first;
+    for(unsigned position = 0; position < _length; ++position)
+        input[position] = window[position] * (T) sample[position];
+    // Zero-padding
+    std::fill(input + _length, input + _size, (T) 0);
+
+    FFTW<T>::execute(_forward);
+}
+
+template<typename T>
+double SpectrumEngine<T>::peakBin() const {
+    const unsigned binCount = bins();
+    if(binCount < 3)
+        return 0;
+
+    unsigned peak = 0;
+    double peakPower = 0;
+    for(unsigned bin = 1; bin < binCount; ++bin) {
+        const double binPower = power(bin);
+        if(binPower > peakPower) {
+            peakPower = binPower;
+            peak = bin;
+        }
+    }
+    if(!peak || peak == binCount - 1)
+        return peak;
+
+    // Parabolic interpolation of the logarithmic magnitudes
+    const double minimalPower = 1e-30;
+    const double left = log(std::max(power(peak - 1), minimalPower));
+    const double center = log(std::max(peakPower, minimalPower));
+    const double right = log(std::max(power(peak + 1), minimalPower));
+    const double denominator = left - 2 * center + right;
+    if(denominator >= 0)
+        return peak;
+    return peak + 0.5 * (left - right) / denominator;
+}
+
+template<typename T>
+const T* SpectrumEngine<T>::crossCorrelation(const SpectrumEngine& other) {
+    if(!_size || other._size != _size)
+        return nullptr;
+
+    // The inverse transformation is only prepared if it is used
+    if(!_inverse) {
+        _correlation = (T*) FFTW<T>::malloc(sizeof(T) * _size);
+        _scratch     = (Complex*) FFTW<T>::malloc(sizeof(Complex) * bins());
+        _inverse = FFTW<T>::c2r(_size, _scratch, _correlation);
+    }
+
+    // Cross spectrum X * conj(Y)
+    const Complex* __restrict x = _spectrum;
+    const Complex* __restrict y = other._spectrum;
+    Complex* __restrict cross = _scratch;
+    for(unsigned bin = 0; bin < bins(); ++bin) {
+        cross[bin][0] = x[bin][0] * y[bin][0] + x[bin][1] * y[bin][1];
+        cross[bin][1] = x[bin][1] * y[bin][0] - x[bin][0] * y[bin][1];
+    }
+
+    // Do complex to real inverse transformation
+    FFTW<T>::execute(_inverse);
+    return _correlation;
+}
+
+template class SpectrumEngine<float>;
+template class SpectrumEngine<double>;
+
+}
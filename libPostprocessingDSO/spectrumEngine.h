@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+/// \brief Declares the SpectrumEngine class.
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+#include <fftw3.h>
+
+#include "dataAnalyzerSettings.h"
+#include "utils/frameBufferPool.h"
+
+namespace DSOAnalyser {
+
+////////////////////////////////////////////////////////////////////////////////
+/// \struct FFTW                                                spectrumEngine.h
+/// \brief Maps the fftw (double) and fftwf (float) APIs onto one interface.
+template<typename T> struct FFTW;
+
+template<> struct FFTW<float> {
+    typedef fftwf_complex complex;
+    typedef fftwf_plan plan;
+    static void* malloc(size_t bytes) { return fftwf_malloc(bytes); }
+    static void free(void* p) { fftwf_free(p); }
+    static plan r2c(int n, float* in, complex* out) { return fftwf_plan_dft_r2c_1d(n, in, out, FFTW_ESTIMATE); }
+    static plan c2r(int n, complex* in, float* out) { return fftwf_plan_dft_c2r_1d(n, in, out, FFTW_ESTIMATE); }
+    static void execute(const plan p) { fftwf_execute(p); }
+    static void destroy(plan p) { fftwf_destroy_plan(p); }
+};
+
+template<> struct FFTW<double> {
+    typedef fftw_complex complex;
+    typedef fftw_plan plan;
+    static void* malloc(size_t bytes) { return fftw_malloc(bytes); }
+    static void free(void* p) { fftw_free(p); }
+    static plan r2c(int n, double* in, complex* out) { return fftw_plan_dft_r2c_1d(n, in, out, FFTW_ESTIMATE); }
+    static plan c2r(int n, complex* in, double* out) { return fftw_plan_dft_c2r_1d(n, in, out, FFTW_ESTIMATE); }
+    static void execute(const plan p) { fftw_execute(p); }
+    static void destroy(plan p) { fftw_destroy_plan(p); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class SpectrumEngine                                       spectrumEngine.h
+/// \brief Windowed real-to-complex FFT of one channel.
+/// All buffers are allocated with fftw(f)_malloc so that FFTW can use its SIMD
+/// code paths. Buffers and plans are kept until the transform size changes.
+/// The transform size may be larger than the number of analyzed samples, the
+/// remaining input is zero-padded. The complex spectrum of the last transform
+/// stays available until the next call of transform(), inverse transforms work
+/// on a separate scratch buffer that is only allocated when needed.
+template<typename T>
+class SpectrumEngine {
+    public:
+        typedef typename FFTW<T>::complex Complex;
+
+        SpectrumEngine() = default;
+        ~SpectrumEngine();
+        SpectrumEngine(const SpectrumEngine&) = delete;
+        SpectrumEngine& operator=(const SpectrumEngine&) = delete;
+
+        /// \brief Return the smallest FFT-friendly size (2^a * 3^b * 5^c).
+        /// \param minimum The minimal size.
+        static unsigned fastSize(unsigned minimum);
+
+        /// \brief Allocate buffers and create plans for the given transform size.
+        /// Buffers and plans are only recreated if the transform size changed.
+        /// \param size The number of real input points, should be a fastSize().
+        /// \param length The number of analyzed samples, the rest is zero-padded.
+        void resize(unsigned size, unsigned length);
+
+        /// \brief Recompute the window factors if the window function or the length changed.
+        void setWindow(WindowFunction windowFunction);
+
+        /// \brief Apply the window to the given samples and do the r2c transformation.
+        /// \param samples The time-domain input.
+        /// \param first The first of length() analyzed samples.
+        void transform(const DSO::SampleBuffer& samples, unsigned first = 0);
+
+        /// \brief Find the strongest bin of the last transform, DC is ignored.
+        /// The position is refined by a parabolic interpolation of the
+        /// logarithmic magnitudes of the peak bin and its neighbours.
+        /// \return The fractional bin index of the peak, 0 if there is none.
+        double peakBin() const;
+
+        /// \brief Cross-correlate the last transforms of this and another engine.
+        /// The cross spectrum X * conj(Y) is built in the scratch buffer and
+        /// transformed back, the spectra themselves are not modified.
+        /// \param other The engine of the reference signal, must have the same size().
+        /// \return The circular cross-correlation with size() values. A peak at
+        /// index k means this signal lags the reference by k samples, negative
+        /// lags are found at size() - k.
+        const T* crossCorrelation(const SpectrumEngine& other);
+
+        /// \return The squared magnitude of the given bin of the last transform.
+        inline double power(unsigned bin) const {
+            return (double)_spectrum[bin][0] * _spectrum[bin][0] + (double)_spectrum[bin][1] * _spectrum[bin][1];
+        }
+
+        /// \return The complex output of the last transform with bins() values.
+        const Complex* spectrum() const { return _spectrum; }
+
+        /// \return The number of real input points.
+        unsigned size() const { return _size; }
+        /// \return The number of analyzed samples.
+        unsigned length() const { return _length; }
+        /// \return The number of complex output bins (size() / 2 + 1).
+        unsigned bins() const { return _size / 2 + 1; }
+
+    private:
+        void release();
+
+        unsigned _size = 0;
+        unsigned _length = 0;
+        unsigned _windowLength = 0;
+        WindowFunction _windowFunction = WINDOW_UNDEFINED;
+        T* _window = nullptr;           ///< The window factors
+        T* _input = nullptr;            ///< The windowed input values
+        T* _correlation = nullptr;      ///< The output of the inverse transformation
+        Complex* _spectrum = nullptr;   ///< The output of the forward transformation
+        Complex* _scratch = nullptr;    ///< The input of the inverse transformation
+        typename FFTW<T>::plan _forward = nullptr;
+        typename FFTW<T>::plan _inverse = nullptr;
+};
+
+extern template class SpectrumEngine<float>;
+extern template class SpectrumEngine<double>;
+
+}
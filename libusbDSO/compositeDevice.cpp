@@ -0,0 +1,401 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  compositeDevice.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+#include "compositeDevice.h"
+#include "utils/timestampDebug.h"
+
+namespace DSO {
+
+/// The number of frames of a member that wait for their partners at most
+static const unsigned maxQueuedFrames = 4;
+
+CompositeDevice::CompositeDevice(const std::vector<std::shared_ptr<DeviceBase>>& devices)
+    : DeviceBase(DSODeviceDescription()) {
+    _members.resize(devices.size());
+    for(unsigned index = 0; index < devices.size(); ++index)
+        _members[index].device = devices[index];
+}
+
+CompositeDevice::~CompositeDevice() {
+    disconnectDevice();
+}
+
+unsigned CompositeDevice::getUniqueID() const {
+    unsigned id = 0;
+    for(const Member& member: _members)
+        id = id * 31 + member.device->getUniqueID();
+    return id;
+}
+
+bool CompositeDevice::needFirmware() const {
+    for(const Member& member: _members)
+        if(member.device->needFirmware())
+            return true;
+    return false;
+}
+
+ErrorCode CompositeDevice::uploadFirmware() {
+    for(Member& member: _members) {
+        if(!member.device->needFirmware())
+            continue;
+        ErrorCode errorCode = member.device->uploadFirmware();
+        if(errorCode != ErrorCode::ERROR_NONE)
+            return errorCode;
+    }
+    return ErrorCode::ERROR_NONE;
+}
+
+bool CompositeDevice::isDeviceConnected() const {
+    return isDeviceTaskRunning();
+}
+
+void CompositeDevice::connectDevice() {
+    if(_members.empty() || isDeviceTaskRunning())
+        return;
+
+    // Members publish their frames on their own tasks, the subscriptions are added
+    // before their tasks are started
+    for(unsigned index = 0; index < _members.size(); ++index) {
+        Member& member = _members[index];
+        member.frames.clear();
+        member.triggerMode = TriggerMode::UNDEFINED;
+        member.subscription = member.device->_frameBus.subscribe(
+                    [this, index](const SharedFrame& frame) { receiveFrame(index, frame); },
+                    maxQueuedFrames, Backpressure::DROP_OLDEST, ThreadRole::DEVICE);
+    }
+
+    unsigned channels = 0;
+    for(Member& member: _members) {
+        if(!member.device->isDeviceConnected())
+            member.device->connectDevice();
+        if(!member.device->isDeviceConnected()) {
+            releaseMembers();
+            _statusMessage((int)ErrorCode::ERROR_CONNECTION);
+            return;
+        }
+        member.firstChannel = channels;
+        member.channels = member.device->getChannelCount();
+        channels += member.channels;
+    }
+    if(channels > MAX_CHANNELS) {
+        releaseMembers();
+        _statusMessage((int)ErrorCode::ERROR_PARAMETER);
+        return;
+    }
+
+    _specification.channels = channels;
+    resetSettings();
+
+    // The first member defines the limits, all members are expected to be of the same model
+    const dsoSpecification& first = _members.front().device->getSpecification();
+    _specification.samplerate_single = first.samplerate_single;
+    _specification.samplerate_multi = first.samplerate_multi;
+    _specification.sampleSize = first.sampleSize;
+    _specification.channels_special = first.channels_special;
+    _specification.specialTriggerSources = first.specialTriggerSources;
+    _specification.features = first.features;
+
+    // The offset calibration is per channel, it is taken from the member owning the channel
+    _specification.gainLevel = first.gainLevel;
+    for(unsigned gainID = 0; gainID < _specification.gainLevel.size(); ++gainID) {
+        for(const Member& member: _members) {
+            const dsoSpecification& specification = member.device->getSpecification();
+            if(gainID >= specification.gainLevel.size())
+                continue;
+            for(unsigned channel = 0; channel < member.channels; ++channel)
+                _specification.gainLevel[gainID].offset[member.firstChannel + channel] =
+                        specification.gainLevel[gainID].offset[channel];
+        }
+    }
+
+    setSamplerate(_members.front().device->getSamplerate());
+
+    // _signals for initial _settings
+    notifySamplerateLimitsChanged();
+    _recordLengthChanged(_settings.recordTypeID);
+    if(!isRollingMode())
+        _recordTimeChanged((double) getCurrentRecordType().length_per_channel / _settings.samplerate.current);
+    _samplerateChanged(_settings.samplerate.current);
+
+    _sampling = false;
+    _membersSampling = false;
+    // The merge loop is running until the device is disconnected
+    startDeviceTask(std::bind(&CompositeDevice::step, this));
+
+    for (unsigned c = 0; c < _specification.channels; ++c)
+        setOffset(c, 0.5);
+
+    _deviceConnected();
+}
+
+void CompositeDevice::disconnectDevice() {
+    if(!isDeviceTaskRunning())
+        return;
+    stopDeviceTask();
+
+    releaseMembers();
+    _statusMessage((int)ErrorCode::ERROR_NONE);
+}
+
+void CompositeDevice::releaseMembers() {
+    // The member tasks are stopped before the subscription is removed
+    for(Member& member: _members) {
+        member.device->disconnectDevice();
+        member.device->_frameBus.unsubscribe(member.subscription);
+        member.subscription.reset();
+    }
+    std::lock_guard<std::mutex> lock(_framesMutex);
+    for(Member& member: _members)
+        member.frames.clear();
+}
+
+ErrorCode CompositeDevice::setSharedTrigger(unsigned specialSource) {
+    return setTriggerSource(true, specialSource);
+}
+
+ErrorCode CompositeDevice::setSkew(unsigned device, double skew_in_s) {
+    if(device >= _members.size())
+        return ErrorCode::ERROR_PARAMETER;
+
+    dispatchSettings([this, device, skew_in_s]() {
+        _members[device].skew_in_s = skew_in_s;
+    });
+    return ErrorCode::ERROR_NONE;
+}
+
+void CompositeDevice::setAlignmentWindow(double window_in_s) {
+    dispatchSettings([this, window_in_s]() {
+        _alignmentWindow = window_in_s;
+    });
+}
+
+std::pair<CompositeDevice::Member*, unsigned> CompositeDevice::memberChannel(unsigned channel) {
+    for(Member& member: _members)
+        if(channel < member.firstChannel + member.channels)
+            return std::make_pair(&member, channel - member.firstChannel);
+    return std::make_pair(nullptr, 0u);
+}
+
+void CompositeDevice::receiveFrame(unsigned device, const SharedFrame& frame) {
+    {
+        std::lock_guard<std::mutex> lock(_framesMutex);
+        std::deque<SharedFrame>& frames = _members[device].frames;
+        if(frames.size() >= maxQueuedFrames)
+            frames.pop_front();
+        frames.push_back(frame);
+    }
+    wakeDeviceTask();
+}
+
+bool CompositeDevice::mergeFrames() {
+    // The oldest frame of every member, if they belong together
+    std::vector<SharedFrame>& frames = _merging;
+    frames.resize(_members.size());
+    {
+        std::lock_guard<std::mutex> lock(_framesMutex);
+        for(;;) {
+            unsigned oldest = 0, newest = 0;
+            for(unsigned index = 0; index < _members.size(); ++index) {
+                const std::deque<SharedFrame>& queue = _members[index].frames;
+                if(queue.empty())
+                    return false;
+                if(queue.front()->settings.timestamp < _members[oldest].frames.front()->settings.timestamp)
+                    oldest = index;
+                if(queue.front()->settings.timestamp > _members[newest].frames.front()->settings.timestamp)
+                    newest = index;
+            }
+            const std::chrono::duration<double> distance = _members[newest].frames.front()->settings.timestamp -
+                                                           _members[oldest].frames.front()->settings.timestamp;
+            if(distance.count() <= _alignmentWindow)
+                break;
+            // The oldest frame has no partners
+            _members[oldest].frames.pop_front();
+        }
+        for(unsigned index = 0; index < _members.size(); ++index) {
+            frames[index] = std::move(_members[index].frames.front());
+            _members[index].frames.pop_front();
+        }
+    }
+
+    const dsoFrameSettings& reference = frames.front()->settings;
+
+    // Drop the samples that were taken before the latest member started
+    double minimumSkew = 0;
+    for(const Member& member: _members)
+        minimumSkew = std::min(minimumSkew, member.skew_in_s);
+
+    std::vector<unsigned>& shift = _shift;
+    shift.resize(_members.size());
+    unsigned length = UINT_MAX;
+    for(unsigned index = 0; index < _members.size(); ++index) {
+        shift[index] = (unsigned) lround((_members[index].skew_in_s - minimumSkew) * reference.samplerate);
+        for(const SampleBuffer& samples: frames[index]->samples) {
+            if(samples.empty())
+                continue;
+            length = std::min(length, samples.size() > shift[index] ? (unsigned) samples.size() - shift[index] : 0u);
+        }
+    }
+
+    for(unsigned index = 0; index < _members.size(); ++index) {
+        const Member& member = _members[index];
+        for(unsigned channel = 0; channel < member.channels; ++channel) {
+            SampleBuffer& target = _frame.samples[member.firstChannel + channel];
+            if(channel >= frames[index]->samples.size() || frames[index]->samples[channel].empty() ||
+               !_settings.voltage[member.firstChannel + channel].used) {
+                target.clear();
+                continue;
+            }
+            const SampleBuffer& samples = frames[index]->samples[channel];
+            target.assign(samples.begin() + shift[index], samples.begin() + shift[index] + length);
+        }
+    }
+
+    snapshotSettings(_frame.settings);
+    // The members may use other rates than computed for the composite device
+    _frame.settings.samplerate = reference.samplerate;
+    _frame.settings.rollMode = reference.rollMode;
+    _frame.settings.recordLength = reference.recordLength;
+
+    // The trigger point is reported by the member that owns the trigger source, it moves with the dropped samples
+    std::pair<Member*, unsigned> source = memberChannel(_settings.trigger.source);
+    const unsigned sourceIndex = !_settings.trigger.special && source.first ? source.first - _members.data() : 0;
+    const unsigned triggerPoint = frames[sourceIndex]->settings.triggerPoint;
+    _frame.settings.triggerPoint = triggerPoint > shift[sourceIndex] ? triggerPoint - shift[sourceIndex] : 0;
+
+    // Release the member frames, so that the members reuse their buffers
+    for(SharedFrame& frame: frames)
+        frame.reset();
+
+    timestampDebug("Merged frame " << _frame.settings.id);
+    _frameBus.publish(_frame);
+    return true;
+}
+
+void CompositeDevice::synchronizeMembers() {
+    const bool sampling = _sampling;
+    if(sampling != _membersSampling) {
+        _membersSampling = sampling;
+        for(Member& member: _members) {
+            if(sampling)
+                member.device->startSampling();
+            else
+                member.device->stopSampling();
+        }
+    }
+
+    const Member* source = _settings.trigger.special ? nullptr : memberChannel(_settings.trigger.source).first;
+    for(Member& member: _members) {
+        const TriggerMode mode = (source && source != &member) ? TriggerMode::AUTO : _settings.trigger.mode;
+        if(mode != member.triggerMode) {
+            member.triggerMode = mode;
+            member.device->setTriggerMode(mode);
+        }
+    }
+}
+
+Executor::time_point CompositeDevice::step() {
+    synchronizeMembers();
+
+    while(mergeFrames());
+
+    // Woken up by new member frames or settings changes
+    return Executor::idle;
+}
+
+void CompositeDevice::updateChannelUsed(unsigned int channel, bool used) {
+    std::pair<Member*, unsigned> target = memberChannel(channel);
+    if(target.first)
+        target.first->device->setChannelUsed(target.second, used);
+}
+
+void CompositeDevice::updateCoupling(unsigned int channel, Coupling coupling) {
+    std::pair<Member*, unsigned> target = memberChannel(channel);
+    if(target.first)
+        target.first->device->setCoupling(target.second, coupling);
+}
+
+void CompositeDevice::updatePretriggerPosition(double pretrigger_pos_in_s) {
+    for(Member& member: _members)
+        member.device->setPreTriggerPosition(pretrigger_pos_in_s);
+}
+
+void CompositeDevice::updateRecordLength(unsigned int index) {
+    for(Member& member: _members)
+        member.device->setRecordLengthByID(index);
+}
+
+void CompositeDevice::updateSamplerate(ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) {
+    // The members compute their best samplerate for the same target themselves
+    for(Member& member: _members)
+        member.device->setSamplerate(_settings.samplerate.target_samplerate);
+}
+
+void CompositeDevice::updateGain(unsigned channel, unsigned char gainIndex, unsigned gainId) {
+    std::pair<Member*, unsigned> target = memberChannel(channel);
+    if(target.first)
+        target.first->device->setGain(target.second, _specification.gainLevel[gainId].gainSteps);
+}
+
+void CompositeDevice::updateOffset(unsigned int channel, unsigned short int offsetValue) {
+    std::pair<Member*, unsigned> target = memberChannel(channel);
+    if(!target.first)
+        return;
+
+    // The members compute the offset value again from the screen offset
+    const dsoShortMinMax& range = _specification.gainLevel[_settings.voltage[channel].gainID].offset[channel];
+    const double offset = range.maximum > range.minimum ?
+                (double) (offsetValue - range.minimum) / (range.maximum - range.minimum) : 0.0;
+    target.first->device->setOffset(target.second, offset);
+}
+
+ErrorCode CompositeDevice::updateTriggerSource(bool special, unsigned int channel) {
+    if(special) {
+        // A shared trigger input, all members trigger on the same event
+        for(Member& member: _members)
+            member.device->setTriggerSource(true, channel);
+        return ErrorCode::ERROR_NONE;
+    }
+
+    std::pair<Member*, unsigned> target = memberChannel(channel);
+    if(!target.first)
+        return ErrorCode::ERROR_PARAMETER;
+    return target.first->device->setTriggerSource(false, target.second);
+}
+
+ErrorCode CompositeDevice::updateTriggerLevel(unsigned int channel, double level) {
+    std::pair<Member*, unsigned> target = memberChannel(channel);
+    if(!target.first)
+        return ErrorCode::ERROR_PARAMETER;
+    return target.first->device->setTriggerLevel(target.second, level);
+}
+
+ErrorCode CompositeDevice::updateTriggerSlope(Slope slope) {
+    for(Member& member: _members)
+        member.device->setTriggerSlope(slope);
+    return ErrorCode::ERROR_NONE;
+}
+
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  compositeDevice.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "deviceBase.h"
+
+namespace DSO {
+
+//////////////////////////////////////////////////////////////////////////////
+/// \brief Several devices that act as one logical scope.
+/// The channels of the member devices are numbered one after another: The
+/// channels of the first device come first, then those of the second and so on.
+/// Settings are forwarded to the member that owns the channel, samplerate,
+/// record length and trigger settings are forwarded to all members.
+///
+/// The members are expected to be of the same model: Samplerate limits and gain
+/// levels are taken from the first member.
+///
+/// Every member delivers its own frames. A merged frame is sent as soon as every
+/// member has a frame and all of them were completed within the alignment window.
+/// Frames without a partner are dropped. If the members share a trigger signal on a
+/// special trigger input (EXT), all frames belong to the same trigger event.
+class CompositeDevice : public DeviceBase {
+    public:
+        /// \param devices The member devices. They are connected by connectDevice() if necessary.
+        CompositeDevice(const std::vector<std::shared_ptr<DeviceBase>>& devices);
+        ~CompositeDevice();
+
+        virtual unsigned getUniqueID() const override;
+
+        virtual bool needFirmware() const override;
+        virtual ErrorCode uploadFirmware() override;
+
+        virtual bool isDeviceConnected() const override;
+        virtual void connectDevice() override;
+        virtual void disconnectDevice() override;
+
+        /// \brief Trigger all members on the same special trigger source.
+        /// \param specialSource The special trigger source the shared trigger signal is connected to.
+        /// \return See ::ErrorCode::ErrorCode.
+        ErrorCode setSharedTrigger(unsigned specialSource);
+
+        /// \brief Set the skew correction of a member.
+        /// \param device The index of the member.
+        /// \param skew_in_s How much earlier the member samples than the others (s). Its
+        ///        first skew_in_s*samplerate samples are dropped, so that all channels start
+        ///        at the same instant. Negative values delay the other members.
+        /// \return See ::ErrorCode::ErrorCode.
+        ErrorCode setSkew(unsigned device, double skew_in_s);
+
+        /// \brief Set the maximum distance of the host timestamps of frames that are merged.
+        /// \param window_in_s The alignment window (s).
+        void setAlignmentWindow(double window_in_s);
+
+        /// \return The number of member devices.
+        unsigned getDeviceCount() const { return _members.size(); }
+
+    private:
+        /// One member device with its frames that wait to be merged
+        struct Member {
+            std::shared_ptr<DeviceBase> device;
+            unsigned firstChannel = 0;   ///< The composite channel of the first member channel
+            unsigned channels = 0;       ///< The number of member channels
+            double skew_in_s = 0;        ///< Skew correction, owned by the composite device task
+            TriggerMode triggerMode = TriggerMode::UNDEFINED; ///< The trigger mode that was forwarded last
+            FrameBus::SubscriptionHandle subscription; ///< The subscription to the frames of the member
+            std::deque<SharedFrame> frames; ///< Received frames, protected by _framesMutex
+        };
+
+        std::vector<Member> _members;
+        std::mutex _framesMutex;
+        double _alignmentWindow = 0.010;   ///< Owned by the composite device task
+        std::vector<SharedFrame> _merging; ///< The frames that are merged, released after merging
+        std::vector<unsigned> _shift;      ///< Samples dropped per member by the skew correction
+
+        bool _membersSampling = false;     ///< The sampling state that was forwarded last
+
+        /// \return The member and the channel of the member for a composite channel.
+        std::pair<Member*, unsigned> memberChannel(unsigned channel);
+
+        /// \brief Called by the subscriptions to the member frames.
+        void receiveFrame(unsigned device, const SharedFrame& frame);
+
+        /// \brief Merge the oldest frames of all members if they belong together.
+        /// \return True if a frame has been sent.
+        bool mergeFrames();
+
+        /// \brief Forward the sampling state and the trigger mode, which have no update hooks.
+        /// Without a shared trigger only the member owning the trigger source uses the trigger
+        /// mode, the others run in auto mode to provide their partner frames.
+        void synchronizeMembers();
+
+        /// \brief Merges the frames of the members, run by the shared executor.
+        /// \return Executor::idle, the step runs again for new frames and settings changes.
+        Executor::time_point step();
+
+        /// \brief Disconnect the members and unsubscribe from their frames.
+        void releaseMembers();
+
+    protected:
+        virtual void updateChannelUsed(unsigned int channel, bool used) override;
+        virtual void updateCoupling(unsigned int channel, Coupling coupling) override;
+        virtual void updatePretriggerPosition(double pretrigger_pos_in_s) override;
+        virtual void updateRecordLength(unsigned int index) override;
+        virtual void updateSamplerate(ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) override;
+        virtual void updateGain(unsigned channel, unsigned char gainIndex, unsigned gainId) override;
+        virtual void updateOffset(unsigned int channel, unsigned short int offsetValue) override;
+        virtual ErrorCode updateTriggerSource(bool special, unsigned int channel) override;
+        virtual ErrorCode updateTriggerLevel(unsigned int channel, double level) override;
+        virtual ErrorCode updateTriggerSlope(Slope slope) override;
+};
+
+}
@@ -28,7 +28,7 @@
 namespace DSO {
     void DeviceBase::resetSettings()
     {
-        _samples.resize(_specification.channels);
+        _frame.samples.resize(_specification.channels);
         _settings.samplerate.limits = &(_specification.samplerate_single);
         _specification.gainLevel.clear();
 
@@ -44,6 +44,9 @@ namespace DSO {
 
         _specification.specialTriggerSources.clear();
 
+        // The gain levels are set up again
+        _selfCalibration.reset();
+        invalidateConversionTables();
     }
 
     /// \brief Get a list of the names of the special trigger sources.
@@ -57,28 +60,39 @@ namespace DSO {
         if(channel >= _specification.channels)
             return ErrorCode::ERROR_PARAMETER;
 
-        // Update _settings
-        _settings.voltage[channel].used = used;
-        unsigned int channelCount = 0;
-        for(unsigned channelCounter = 0; channelCounter < _specification.channels; ++channelCounter) {
-            if(_settings.voltage[channelCounter].used)
-                ++channelCount;
-        }
+        dispatchSettings([this, channel, used]() {
+            // Update _settings
+            _settings.voltage[channel].used = used;
+            unsigned int channelCount = 0;
+            for(unsigned channelCounter = 0; channelCounter < _specification.channels; ++channelCounter) {
+                if(_settings.voltage[channelCounter].used)
+                    ++channelCount;
+            }
+
+            // Check if fast rate mode availability changed
+            bool fastRateChanged = (_settings.usedChannels <= 1) != (channelCount <= 1);
+            _settings.usedChannels = channelCount;
 
-        // Check if fast rate mode availability changed
-        bool fastRateChanged = (_settings.usedChannels <= 1) != (channelCount <= 1);
-        _settings.usedChannels = channelCount;
+            updateChannelUsed(channel, used);
 
-        if(fastRateChanged)
-            notifySamplerateLimitsChanged();
+            if(fastRateChanged)
+                notifySamplerateLimitsChanged();
+        });
 
-        return ErrorCode::ERROR_PARAMETER;
+        return ErrorCode::ERROR_NONE;
     }
 
     ErrorCode DeviceBase::setCoupling(unsigned int channel, Coupling coupling)
     {
-        _settings.voltage[channel].coupling = coupling;
-        return ErrorCode::ERROR_PARAMETER;
+        if(channel >= _specification.channels)
+            return ErrorCode::ERROR_PARAMETER;
+
+        dispatchSettings([this, channel, coupling]() {
+            _settings.voltage[channel].coupling = coupling;
+            updateCoupling(channel, coupling);
+        });
+
+        return ErrorCode::ERROR_NONE;
     }
 
     ErrorCode DeviceBase::setGain(unsigned int channel, double gain)
@@ -99,9 +113,11 @@ namespace DSO {
         if(gainID == _specification.gainLevel.size())
             return ErrorCode::ERROR_PARAMETER;
 
-        updateGain(channel, _specification.gainLevel[gainID].gainIndex, gainID);
-        _settings.voltage[channel].gainID = gainID;
-        setOffset(channel, _settings.voltage[channel].offset);
+        dispatchSettings([this, channel, gainID]() {
+            updateGain(channel, _specification.gainLevel[gainID].gainIndex, gainID);
+            _settings.voltage[channel].gainID = gainID;
+            setOffset(channel, _settings.voltage[channel].offset);
+        });
 
         // _specification.gainSteps[gainId]
         return ErrorCode::ERROR_NONE;
@@ -115,56 +131,195 @@ namespace DSO {
         if(channel >= _specification.channels)
             return ErrorCode::ERROR_PARAMETER;
 
-        // Calculate the offset value
-        // The range is given by the calibration data (convert from big endian)
-        unsigned int gainID = _settings.voltage[channel].gainID;
-        unsigned short int minimum, maximum, offsetDiff, offsetValue;
-        minimum = _specification.gainLevel[gainID].offset[channel].minimum;
-        maximum = _specification.gainLevel[gainID].offset[channel].maximum;
-        offsetDiff = maximum - minimum;
-        offsetValue = offset * offsetDiff + minimum + 0.5;
-        double offsetReal = (double) offset + 0.5 / offsetDiff;
+        dispatchSettings([this, channel, offset]() {
+            // Calculate the offset value
+            // The range is given by the calibration data (convert from big endian)
+            unsigned int gainID = _settings.voltage[channel].gainID;
+            unsigned short int minimum, maximum, offsetDiff, offsetValue;
+            minimum = _specification.gainLevel[gainID].offset[channel].minimum;
+            maximum = _specification.gainLevel[gainID].offset[channel].maximum;
+            offsetDiff = maximum - minimum;
+            offsetValue = offset * offsetDiff + minimum + 0.5;
+            double offsetReal = (double) offset + 0.5 / offsetDiff;
 
-        updateOffset(channel, offsetValue);
+            updateOffset(channel, offsetValue);
 
-        _settings.voltage[channel].offset = offset;
-        _settings.voltage[channel].offsetReal = offsetReal;
+            _settings.voltage[channel].offset = offset;
+            _settings.voltage[channel].offsetReal = offsetReal;
 
-        updateTriggerLevel(channel, _settings.trigger.level[channel]);
+            updateTriggerLevel(channel, _settings.trigger.level[channel]);
+        });
 
         // offsetReal;
         return ErrorCode::ERROR_NONE;
     }
 
+    ErrorCode DeviceBase::setCalibration(unsigned int channel, unsigned int gainID, const dsoAdcCalibration& calibration)
+    {
+        if(channel >= _specification.channels || gainID >= _specification.gainLevel.size())
+            return ErrorCode::ERROR_PARAMETER;
+
+        dispatchSettings([this, channel, gainID, calibration]() {
+            _specification.gainLevel[gainID].calibration[channel] = calibration;
+            invalidateConversionTables();
+            _calibrationChanged(channel, gainID, calibration);
+        });
+
+        return ErrorCode::ERROR_NONE;
+    }
+
+    ErrorCode DeviceBase::startSelfCalibration()
+    {
+        if(!isDeviceConnected())
+            return ErrorCode::ERROR_CONNECTION;
+
+        if(_specification.gainLevel.empty())
+            return ErrorCode::ERROR_UNSUPPORTED;
+
+        dispatchSettings([this]() {
+            if(_selfCalibration)
+                return;
+
+            _calibrationSettings = _settings;
+            _calibrationSampling = _sampling;
+            _calibrationBackup = _specification.gainLevel;
+
+            // Measure the codes of the uncalibrated ADCs
+            for(dsoGainLevel& gainLevel: _specification.gainLevel)
+                for(dsoAdcCalibration& calibration: gainLevel.calibration)
+                    calibration = dsoAdcCalibration();
+            invalidateConversionTables();
+
+            _selfCalibration.reset(new SelfCalibration(_specification.channels, _specification.gainLevel.size()));
+            for(unsigned channel = 0; channel < _specification.channels; ++channel)
+                setChannelUsed(channel, true);
+            _settings.trigger.mode = TriggerMode::AUTO;
+            applyCalibrationStep();
+
+            if(!_sampling)
+                startSampling();
+        });
+
+        return ErrorCode::ERROR_NONE;
+    }
+
+    bool DeviceBase::calibrationFrame()
+    {
+        if(!_selfCalibration)
+            return false;
+
+        // Without calibration the conversion is linear and can be inverted to get the mean code
+        std::vector<double> measured(_specification.channels), expected(_specification.channels);
+        for(unsigned channel = 0; channel < _specification.channels; ++channel) {
+            const SampleBuffer& samples = _frame.samples[channel];
+            const double* voltage = conversionTable(channel);
+            const double step = voltage[1] - voltage[0];
+            if(samples.empty() || step == 0.0)
+                continue;
+
+            double mean = 0.0;
+            for(double sample: samples)
+                mean += sample;
+            mean /= samples.size();
+
+            measured[channel] = (mean - voltage[0]) / step;
+            expected[channel] = -voltage[0] / step;
+        }
+
+        if(_selfCalibration->addFrame(measured, expected)) {
+            if(_selfCalibration->finished())
+                finishSelfCalibration(true);
+            else if(!_calibrationProgress(_selfCalibration->progress()))
+                finishSelfCalibration(false);
+            else
+                applyCalibrationStep();
+        }
+        return true;
+    }
+
+    void DeviceBase::applyCalibrationStep()
+    {
+        const unsigned gainID = _selfCalibration->gainID();
+        for(unsigned channel = 0; channel < _specification.channels; ++channel) {
+            updateGain(channel, _specification.gainLevel[gainID].gainIndex, gainID);
+            _settings.voltage[channel].gainID = gainID;
+            setOffset(channel, _selfCalibration->offset());
+        }
+    }
+
+    void DeviceBase::finishSelfCalibration(bool completed)
+    {
+        const unsigned codes = 1u << _specification.sampleSize;
+        for(unsigned gainID = 0; gainID < _specification.gainLevel.size(); ++gainID) {
+            for(unsigned channel = 0; channel < _specification.channels; ++channel) {
+                dsoAdcCalibration& calibration = _specification.gainLevel[gainID].calibration[channel];
+                if(!completed) {
+                    calibration = _calibrationBackup[gainID].calibration[channel];
+                    continue;
+                }
+                calibration = _selfCalibration->result(channel, gainID, codes);
+                _calibrationChanged(channel, gainID, calibration);
+            }
+        }
+        invalidateConversionTables();
+        _selfCalibration.reset();
+        _calibrationBackup.clear();
+
+        for(unsigned channel = 0; channel < _specification.channels; ++channel) {
+            const dsoSettingsChannel& voltage = _calibrationSettings.voltage[channel];
+            updateGain(channel, _specification.gainLevel[voltage.gainID].gainIndex, voltage.gainID);
+            _settings.voltage[channel].gainID = voltage.gainID;
+            setOffset(channel, voltage.offset);
+            setChannelUsed(channel, voltage.used);
+        }
+        _settings.trigger.mode = _calibrationSettings.trigger.mode;
+        if(!_calibrationSampling)
+            stopSampling();
+
+        if(completed)
+            _calibrationProgress(100);
+    }
+
     ErrorCode DeviceBase::setTriggerSource(bool special, unsigned int channel)
     {
-        ErrorCode c = updateTriggerSource(special, channel);
-        if (c != ErrorCode::ERROR_NONE) return c;
+        if((!special && channel >= _specification.channels) || (special && channel >= _specification.channels_special))
+            return ErrorCode::ERROR_PARAMETER;
+
+        dispatchSettings([this, special, channel]() {
+            if (updateTriggerSource(special, channel) != ErrorCode::ERROR_NONE) return;
 
-        _settings.trigger.special = special;
-        _settings.trigger.source = channel;
+            _settings.trigger.special = special;
+            _settings.trigger.source = channel;
 
-        if(!special)
-            this->setTriggerLevel(channel, _settings.trigger.level[channel]);
+            if(!special)
+                this->setTriggerLevel(channel, _settings.trigger.level[channel]);
+        });
 
         return ErrorCode::ERROR_NONE;
     }
 
     ErrorCode DeviceBase::setTriggerLevel(unsigned int channel, double level)
     {
-        ErrorCode c = updateTriggerLevel(channel, level);
-        if (c != ErrorCode::ERROR_NONE) return c;
+        if(channel >= _specification.channels)
+            return ErrorCode::ERROR_PARAMETER;
+
+        dispatchSettings([this, channel, level]() {
+            if (updateTriggerLevel(channel, level) != ErrorCode::ERROR_NONE) return;
+
+            _settings.trigger.level[channel] = level;
+        });
 
-        _settings.trigger.level[channel] = level;
         return ErrorCode::ERROR_NONE;
     }
 
     ErrorCode DeviceBase::setTriggerSlope(Slope slope)
     {
-        ErrorCode c = updateTriggerSlope(slope);
-        if (c != ErrorCode::ERROR_NONE) return c;
+        dispatchSettings([this, slope]() {
+            if (updateTriggerSlope(slope) != ErrorCode::ERROR_NONE) return;
+
+            _settings.trigger.slope = slope;
+        });
 
-        _settings.trigger.slope = slope;
         return ErrorCode::ERROR_NONE;
     }
 
@@ -175,7 +330,10 @@ namespace DSO {
         if(mode < TriggerMode::AUTO || mode > TriggerMode::SINGLE)
             return ErrorCode::ERROR_PARAMETER;
 
-        _settings.trigger.mode = mode;
+        dispatchSettings([this, mode]() {
+            _settings.trigger.mode = mode;
+        });
+
         return ErrorCode::ERROR_NONE;
     }
-}
+}
\ No newline at end of file
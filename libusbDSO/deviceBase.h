@@ -26,8 +26,10 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 
 #include "deviceBaseSamples.h"
+#include "selfCalibration.h"
 #include "errorcodes.h"
 
 namespace DSO {
@@ -38,18 +40,23 @@ namespace DSO {
 class DeviceBase : public DeviceBaseSamples {
     public:
         DeviceBase(const DSODeviceDescription& model) : DeviceBaseSamples(model) {}
+        /// Devices are owned through pointers to this class
+        virtual ~DeviceBase() {}
+
+        // The setters validate their parameters immediately and apply the change
+        // asynchronously if the device task is running, see DeviceBaseSamples::dispatchSettings().
 
         /// \brief Enables/disables filtering of the given channel.
         /// \param channel The channel that should be set.
         /// \param used true if the channel should be sampled.
         /// \return See ::ErrorCode::ErrorCode.
-        virtual ErrorCode setChannelUsed(unsigned int channel, bool used);
+        ErrorCode setChannelUsed(unsigned int channel, bool used);
 
         /// \brief Set the coupling (AC/DC/Off) for the given channel.
         /// \param channel The channel that should be set.
         /// \param coupling The new coupling for the channel.
         /// \return See ::ErrorCode::ErrorCode.
-        virtual ErrorCode setCoupling(unsigned int channel, Coupling coupling);
+        ErrorCode setCoupling(unsigned int channel, Coupling coupling);
 
         /// \brief Sets the gain for the given channel.
         /// Find lowest gain voltage in DeviceBaseSpecifications::gainLevel
@@ -58,35 +65,48 @@ class DeviceBase : public DeviceBaseSamples {
         /// \param gain The gain that should be met (V/div).
         /// \return Returns ::ErrorCode::ERROR_PARAMETER if channel or gain
         ///         level not found,
-        virtual ErrorCode setGain(unsigned int channel, double gain);
+        ErrorCode setGain(unsigned int channel, double gain);
 
         /// \brief Set the offset for the given channel.
         /// \param channel The channel that should be set.
         /// \param offset The new offset value (0.0 - 1.0).
         /// \return See ::ErrorCode::ErrorCode.
-        virtual ErrorCode setOffset(unsigned int channel, double offset);
+        ErrorCode setOffset(unsigned int channel, double offset);
 
         /// \brief Set the trigger source.
         /// \param special true for a special channel (EXT, ...) as trigger source.
         /// \param id The number of the channel, that should be used as trigger.
         /// \return See ::ErrorCode::ErrorCode.
-        virtual ErrorCode setTriggerSource(bool special, unsigned int channel);
+        ErrorCode setTriggerSource(bool special, unsigned int channel);
 
         /// \brief Set the trigger level.
         /// \param channel The channel that should be set.
         /// \param level The new trigger level (V).
         /// \return See ::ErrorCode::ErrorCode.
-        virtual ErrorCode setTriggerLevel(unsigned int channel, double level);
+        ErrorCode setTriggerLevel(unsigned int channel, double level);
 
         /// \brief Set the trigger slope.
         /// \param slope The Slope that should cause a trigger.
         /// \return See ::ErrorCode::ErrorCode.
-        virtual ErrorCode setTriggerSlope(Slope slope);
+        ErrorCode setTriggerSlope(Slope slope);
 
         /// \brief Set the trigger mode.
         /// \return See ::ErrorCode::ErrorCode.
         ErrorCode setTriggerMode(TriggerMode mode);
 
+        /// \brief Set the ADC calibration of a channel at a gain level, for example
+        /// the result of a previous self calibration.
+        /// \param channel The channel that should be set.
+        /// \param gainID The gain level (@see DSO::dsoSpecification.gainLevel[gainID]).
+        /// \return See ::ErrorCode::ErrorCode.
+        ErrorCode setCalibration(unsigned int channel, unsigned int gainID, const dsoAdcCalibration& calibration);
+
+        /// \brief Calibrate the ADCs of all channels at all gain levels. The inputs have to be
+        /// grounded. Sampling is started and the settings are restored afterwards. The progress is
+        /// reported by _calibrationProgress, the results by _calibrationChanged.
+        /// \return See ::ErrorCode::ErrorCode.
+        ErrorCode startSelfCalibration();
+
         /// \brief Set the trigger mode.
         /// \return True if a firmware upload is necessary. connectDevice() will fail if this
         ///         method return true.
@@ -134,12 +154,30 @@ class DeviceBase : public DeviceBaseSamples {
         std::function<bool(int)> _uploadProgress = [](int){return true;};
         /// Status message about the oscilloscope (int messageID)
         std::function<void(int)> _statusMessage = [](int){};
+        /// Self calibration progress in percent: 100% == completed. Called by the device task.
+        /// If progress is < 0 then it represents an ::ErrorCode::ErrorCode.
+        /// Return true if you want to continue the calibration, false if you want to abort it.
+        std::function<bool(int)> _calibrationProgress = [](int){return true;};
+        /// The ADC calibration of a channel (first parameter) at a gain level (second parameter)
+        /// has changed. Called by the device task.
+        std::function<void(unsigned,unsigned,const dsoAdcCalibration&)> _calibrationChanged =
+                [](unsigned,unsigned,const dsoAdcCalibration&){};
 
 protected:
         /// \brief Reset settings to a reasonable default state.
         /// Should be called by connectDevice().
         void resetSettings();
 
+        /// \brief Enables/disables sampling of the given channel. _settings is already updated.
+        /// \param channel The channel that should be set.
+        /// \param used true if the channel should be sampled.
+        virtual void updateChannelUsed(unsigned int channel, bool used) = 0;
+
+        /// \brief Set the coupling (AC/DC/Off) for the given channel.
+        /// \param channel The channel that should be set.
+        /// \param coupling The new coupling for the channel.
+        virtual void updateCoupling(unsigned int channel, Coupling coupling) = 0;
+
         /// \brief Sets the gain for the given channel.
         /// \param channel The channel that should be set.
         /// \param gain The gain that should be met (V/div).
@@ -163,6 +201,21 @@ protected:
         /// \brief Set the trigger slope.
         /// \param slope The Slope that should cause a trigger.
         virtual ErrorCode updateTriggerSlope(Slope slope) = 0;
+
+        virtual bool calibrationFrame() override;
+
+private:
+        /// \brief Apply the gain level and offset of the current calibration measurement.
+        void applyCalibrationStep();
+
+        /// \brief Restore the settings of before the self calibration.
+        /// \param completed False to restore the previous calibration as well.
+        void finishSelfCalibration(bool completed);
+
+        std::unique_ptr<SelfCalibration> _selfCalibration; ///< The running self calibration
+        dsoSettings _calibrationSettings;    ///< The settings before the self calibration
+        bool _calibrationSampling = false;   ///< Sampling was running before the self calibration
+        std::vector<dsoGainLevel> _calibrationBackup; ///< The calibration before the self calibration
 };
 
 }
@@ -33,8 +33,68 @@ namespace DSO {
 std::vector<int>& operator<<(std::vector<int>& v, int x);
 std::vector<unsigned short int>& operator<<(std::vector<unsigned short int>& v, unsigned short int x);
 
+void DeviceBaseSamples::dispatchSettings(SettingsDelta delta) {
+    if(!_taskRunning || _stepThread.load() == std::this_thread::get_id())
+        delta();
+    else {
+        _settingsDeltas.push(std::move(delta));
+        wakeDeviceTask();
+    }
+}
+
+void DeviceBaseSamples::applySettingsDeltas() {
+    SettingsDelta delta;
+    while(_settingsDeltas.pop(delta))
+        delta();
+}
+
+void DeviceBaseSamples::startDeviceTask(DeviceStep step) {
+    updateSettingsSnapshot();
+    _taskRunning = true;
+    // Other threads may wake the previous task at the same time
+    std::atomic_store(&_task, _executor->schedule([this, step]() {
+        _stepThread = std::this_thread::get_id();
+        applySettingsDeltas();
+        updateSettingsSnapshot();
+        const Executor::time_point next = step();
+        updateSettingsSnapshot();
+        if(next == Executor::finished) {
+            // Changes dispatched from now on are applied directly
+            _taskRunning = false;
+            applySettingsDeltas();
+        }
+        _stepThread = std::thread::id();
+        return next;
+    }));
+}
+
+void DeviceBaseSamples::stopDeviceTask() {
+    _executor->cancel(std::atomic_load(&_task));
+    _taskRunning = false;
+    // A running step has finished or it is the caller, the caller owns _settings now
+    applySettingsDeltas();
+}
+
+bool DeviceBaseSamples::ownsSettings() const {
+    return !_taskRunning || _stepThread.load() == std::this_thread::get_id();
+}
+
+void DeviceBaseSamples::updateSettingsSnapshot() {
+    _settingsSnapshot.samplerate = _settings.samplerate.current;
+    // The record types are not known before the device is initialized
+    const bool initialized = _settings.samplerate.limits &&
+                             _settings.recordTypeID < _settings.samplerate.limits->recordTypes.size();
+    _settingsSnapshot.rollingMode = initialized && isRollingMode();
+    _settingsSnapshot.expectedRecordLength = initialized ? getExpectedRecordLength() : 0;
+}
+
+void DeviceBaseSamples::wakeDeviceTask() {
+    _executor->wake(std::atomic_load(&_task));
+}
+
 void DeviceBaseSamples::startSampling() {
     _sampling = true;
+    wakeDeviceTask();
     _samplingStarted();
 }
 
@@ -44,13 +104,16 @@ void DeviceBaseSamples::stopSampling() {
 }
 
 bool DeviceBaseSamples::toogleSampling() {
-    _sampling = !_sampling;
-    if (_sampling)
+    const bool sampling = !_sampling;
+    _sampling = sampling;
+    if (sampling) {
+        wakeDeviceTask();
         _samplingStarted();
+    }
     else
         _samplingStopped();
 
-    return _sampling;
+    return sampling;
 }
 
 double DeviceBaseSamples::getMinSamplerate() {
@@ -64,7 +127,14 @@ double DeviceBaseSamples::getMaxSamplerate() {
 
 double DeviceBaseSamples::getSamplerate()
 {
-    return _settings.samplerate.current;
+    return ownsSettings() ? _settings.samplerate.current : _settingsSnapshot.samplerate.load();
+}
+
+bool DeviceBaseSamples::isRollingMode() const
+{
+    if(!ownsSettings())
+        return _settingsSnapshot.rollingMode;
+    return getCurrentRecordType().length_per_channel == rollModeValue;
 }
 
 void DeviceBaseSamples::notifySamplerateLimitsChanged() {
@@ -80,23 +150,29 @@ void DeviceBaseSamples::setSamplerate(double samplerate) {
     if(samplerate == 0.0)
         throw std::runtime_error("setSamplerate with 0 not allowed");
 
-    recomputeSamplerate(samplerate, _specification.samplerate_single.max, false);
+    dispatchSettings([this, samplerate]() {
+        recomputeSamplerate(samplerate, _specification.samplerate_single.max, false);
+    });
 }
 
 void DeviceBaseSamples::setSamplerateByRecordTime(double duration_in_s) {
     if(duration_in_s <= 0.0)
         throw std::runtime_error("setRecordTime with 0 not allowed");
 
-    // Calculate the maximum samplerate that would still provide the requested duration
-    double maxSamplerate = getCurrentRecordType().length_per_channel / duration_in_s;
+    dispatchSettings([this, duration_in_s]() {
+        // Calculate the maximum samplerate that would still provide the requested duration
+        double maxSamplerate = getCurrentRecordType().length_per_channel / duration_in_s;
 
-    recomputeSamplerate(maxSamplerate, _specification.samplerate_multi.base, true);
+        recomputeSamplerate(maxSamplerate, _specification.samplerate_multi.base, true);
+    });
 }
 
 void DeviceBaseSamples::setPreTriggerPosition(double pretrigger_pos_in_s)
 {
-    _settings.trigger.pretrigger_pos_in_s = pretrigger_pos_in_s;
-    updatePretriggerPosition(pretrigger_pos_in_s);
+    dispatchSettings([this, pretrigger_pos_in_s]() {
+        _settings.trigger.pretrigger_pos_in_s = pretrigger_pos_in_s;
+        updatePretriggerPosition(pretrigger_pos_in_s);
+    });
 }
 
 
@@ -110,7 +186,7 @@ void DeviceBaseSamples::recomputeSamplerate(double samplerate, double baseSample
                     (samplerate >= baseSamplerate / getCurrentRecordType().divider);
     bool fastRateChanged = fastRate != isFastRate();
     if(fastRateChanged) {
-        _settings.samplerate.limits = fastRate ? &_specification.samplerate_single : &_specification.samplerate_multi;
+        _settings.samplerate.limits = fastRate ? &_specification.samplerate_multi : &_specification.samplerate_single;
     }
 
     // What is the nearest, at least as high samplerate the scope can provide?
@@ -178,6 +254,9 @@ double DeviceBaseSamples::getDownsamplerRate(double bestDownsampler, bool maximu
 }
 
 unsigned int DeviceBaseSamples::getExpectedRecordLength() {
+    if(!ownsSettings())
+        return _settingsSnapshot.expectedRecordLength;
+
     unsigned recordLength = getCurrentRecordType().length_per_channel;
     if(!isFastRate())
         recordLength *= _specification.channels;
@@ -186,25 +265,28 @@ unsigned int DeviceBaseSamples::getExpectedRecordLength() {
 }
 
 void DeviceBaseSamples::setRecordLengthByID(unsigned int recordTypeID) {
-    updateRecordLength(recordTypeID);
+    dispatchSettings([this, recordTypeID]() {
+        updateRecordLength(recordTypeID);
 
-    // Check if the divider has changed and adapt samplerate limits accordingly
-    bool bDividerChanged = recordTypeID != _settings.recordTypeID;
-    _settings.recordTypeID = recordTypeID;
+        // Check if the divider has changed and adapt samplerate limits accordingly
+        bool bDividerChanged = recordTypeID != _settings.recordTypeID;
+        _settings.recordTypeID = recordTypeID;
+        reserveFrameBuffers();
 
-    if(bDividerChanged) {
-        this->notifySamplerateLimitsChanged();
+        if(bDividerChanged) {
+            this->notifySamplerateLimitsChanged();
 
-        // Samplerate dividers changed, recalculate it
-        setSamplerate(_settings.samplerate.target_samplerate);
-    }
+            // Samplerate dividers changed, recalculate it
+            setSamplerate(_settings.samplerate.target_samplerate);
+        }
 
-    updatePretriggerPosition(_settings.trigger.pretrigger_pos_in_s);
+        updatePretriggerPosition(_settings.trigger.pretrigger_pos_in_s);
 
-    _recordLengthChanged(_settings.recordTypeID);
+        _recordLengthChanged(_settings.recordTypeID);
+    });
 }
 
-void DeviceBaseSamples::processSamples(std::vector<unsigned char>& data) {
+bool DeviceBaseSamples::processSamples(std::vector<unsigned char>& data) {
     unsigned sampleCountAllChannels;
 
     const bool samplesize_greater_byte = _specification.sampleSize > 8;
@@ -230,18 +312,15 @@ void DeviceBaseSamples::processSamples(std::vector<unsigned char>& data) {
     for(unsigned channel = 0; channel < _specification.channels; ++channel) {
         if(!_settings.voltage[channel].used) {
             // Clear unused channels
-            _samples[channel].resize(0);
+            _frame.samples[channel].resize(0);
             continue;
         }
 
         // Resize sample vector
-        _samples[channel].resize(sampleCount);
+        _frame.samples[channel].resize(sampleCount);
 
-        const unsigned gainID  = _settings.voltage[channel].gainID;
-        const double gain_limit = _specification.gainLevel[gainID].voltage;
-        const double gain       = _specification.gainLevel[gainID].gainSteps;
-        const double offsetReal = _settings.voltage[channel].offsetReal;
-        double extra_value      = 0; // For sample sizes of > 8 bit, the computed extra value is stored here.
+        const double* voltage   = conversionTable(channel);
+        unsigned extra_value    = 0; // For sample sizes of > 8 bit, the extra bits are stored here.
         unsigned bufferPosition = _settings.trigger.point * 2;
 
         // Fastrate uses the entire buffer, no offset in the data buffer for different channels.
@@ -250,7 +329,7 @@ void DeviceBaseSamples::processSamples(std::vector<unsigned char>& data) {
         const int chanOffset = fastRate ? 0 : _specification.channels - 1 - channel;
 
         for(unsigned sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex, bufferPosition += buffer_inc) {
-            bufferPosition %= sampleCount;
+            bufferPosition %= sampleCountAllChannels;
 
             if (samplesize_greater_byte) {
                 if (fastRate) {
@@ -264,14 +343,86 @@ void DeviceBaseSamples::processSamples(std::vector<unsigned char>& data) {
                 }
             }
 
-            const double value = data[bufferPosition + chanOffset] + extra_value;
-            _samples[channel][sampleIndex] = (value / gain_limit - offsetReal) * gain;
+            _frame.samples[channel][sampleIndex] = voltage[data[bufferPosition + chanOffset] + extra_value];
+        }
+    }
+
+    snapshotSettings(_frame.settings);
+
+    timestampDebug("Received packet " << _frame.settings.id);
+
+    return !calibrationFrame();
+}
+
+void DeviceBaseSamples::reserveFrameBuffers() {
+    if(isRollingMode())
+        return;
+    const unsigned length = getCurrentRecordType().length_per_channel;
+    for(SampleBuffer& samples: _frame.samples)
+        samples.reserve(length);
+    // One copy per channel in the analyser and one frame in flight
+    FrameBufferPool::instance().reserve(length * sizeof(double), 2 * _specification.channels);
+}
+
+double DeviceBaseSamples::convertSample(unsigned gainID, double offsetReal, double code) const {
+    const dsoGainLevel& gainLevel = _specification.gainLevel[gainID];
+    return (code / gainLevel.voltage - offsetReal) * gainLevel.gainSteps;
+}
+
+const double* DeviceBaseSamples::conversionTable(unsigned channel) {
+    const unsigned gainID = _settings.voltage[channel].gainID;
+    const double offsetReal = _settings.voltage[channel].offsetReal;
+    const unsigned codes = 1u << _specification.sampleSize;
+
+    std::vector<ConversionTable>& tables = _conversionTables[channel];
+    if(tables.size() < _specification.gainLevel.size())
+        tables.resize(_specification.gainLevel.size());
+    ConversionTable& table = tables[gainID];
+
+    if(table.generation != _conversionGeneration || table.offsetReal != offsetReal || table.values.size() != codes) {
+        const dsoAdcCalibration& calibration = _specification.gainLevel[gainID].calibration[channel];
+        const bool linearity = calibration.linearity.size() == codes;
+
+        table.values.resize(codes);
+        for(unsigned code = 0; code < codes; ++code) {
+            double corrected = (code - calibration.offset) * calibration.gain;
+            if(linearity)
+                corrected -= calibration.linearity[code];
+            table.values[code] = convertSample(gainID, offsetReal, corrected);
         }
+        table.offsetReal = offsetReal;
+        table.generation = _conversionGeneration;
+    }
+    return table.values.data();
+}
+
+void DeviceBaseSamples::snapshotSettings(dsoFrameSettings& settings) {
+    settings.id = ++_frameCounter;
+    settings.timestamp = std::chrono::steady_clock::now();
+    settings.samplerate = _settings.samplerate.current;
+    settings.rollMode = isRollingMode();
+    settings.fastRate = isFastRate();
+    settings.recordTypeID = _settings.recordTypeID;
+    settings.recordLength = getCurrentRecordType().length_per_channel;
+
+    settings.channels = _specification.channels;
+    for(unsigned channel = 0; channel < _specification.channels; ++channel) {
+        const dsoSettingsChannel& voltage = _settings.voltage[channel];
+        dsoFrameChannel& frameChannel = settings.channel[channel];
+        frameChannel.used = voltage.used;
+        frameChannel.gainID = voltage.gainID;
+        frameChannel.gain = voltage.gainID < _specification.gainLevel.size() ? _specification.gainLevel[voltage.gainID].gainSteps : 0.0;
+        frameChannel.offset = voltage.offset;
+        frameChannel.offsetReal = voltage.offsetReal;
+        frameChannel.coupling = voltage.coupling;
     }
 
-    static unsigned id = 0;
-    (void)id;
-    timestampDebug("Received packet " << id++);
+    settings.triggerPoint = _settings.trigger.point;
+    settings.pretrigger_pos_in_s = _settings.trigger.pretrigger_pos_in_s;
+    settings.triggerMode = _settings.trigger.mode;
+    settings.triggerSlope = _settings.trigger.slope;
+    settings.triggerSpecial = _settings.trigger.special;
+    settings.triggerSource = _settings.trigger.source;
 }
 
 }
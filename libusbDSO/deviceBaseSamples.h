@@ -22,15 +22,24 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <vector>
 #include <climits>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
 
 #include "dsoSettings.h"
+#include "dsoFrame.h"
+#include "frameBus.h"
 #include "dsoSpecification.h"
 #include "errorcodes.h"
 #include "deviceDescriptionEntry.h"
 #include "deviceBaseSpecifications.h"
+#include "utils/mpscQueue.h"
+#include "utils/executor.h"
 
 namespace DSO {
 #define rollModeValue UINT_MAX
@@ -42,6 +51,10 @@ class DeviceBaseSamples : public DeviceBaseSpecifications {
 public:
     DeviceBaseSamples(const DSODeviceDescription& model) : DeviceBaseSpecifications(model) {}
 
+    /// A change of the device settings. It captures all parameters by value
+    /// and is executed by the device task that owns _settings.
+    typedef std::function<void(void)> SettingsDelta;
+
     /// \brief Get minimum samplerate for this oscilloscope.
     /// \return The minimum samplerate for the current configuration in S/s.
     double getMinSamplerate();
@@ -51,9 +64,12 @@ public:
     double getMaxSamplerate();
 
     /// \brief Get the current samplerate.
+    /// Other threads than the device task get the value after its last step.
     double getSamplerate();
 
     /// \brief Sets the samplerate of the oscilloscope.
+    /// The setters of this class and of DeviceBase can be called by any thread. While the
+    /// device task is running they are applied asynchronously, see dispatchSettings().
     /// \param samplerate The samplerate that should be met (S/s). Have to be greater than 0.
     /// To restore the samplerate to the current one, call with _settings.samplerate.target.samplerate.
     void setSamplerate(double samplerate);
@@ -63,6 +79,7 @@ public:
     void setSamplerateByRecordTime(double duration_in_s);
 
     /// \brief Return the number of samples accumulated for all enabled channels that are expected.
+    /// Other threads than the device task get the value after its last step.
     unsigned int getExpectedRecordLength();
 
     /// \brief Sets the size of the oscilloscopes sample buffer.
@@ -83,8 +100,10 @@ public:
     /// \brief Stop/Start sampling process.
     bool toogleSampling();
 
-    inline bool isRollingMode() { return getCurrentRecordType().length_per_channel == rollModeValue; }
-    inline bool isFastRate() { return _settings.samplerate.limits == &_specification.samplerate_multi;}
+    /// \return True if the device streams in roll mode.
+    /// Other threads than the device task get the value after its last step.
+    bool isRollingMode() const;
+    inline bool isFastRate() const { return _settings.samplerate.limits == &_specification.samplerate_multi;}
 protected:
     /// \brief Sets the size of the sample buffer without updating dependencies.
     /// \param index The record length index that should be set.
@@ -97,6 +116,41 @@ protected:
     virtual void updateSamplerate(ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) = 0;
 
     virtual void updatePretriggerPosition(double position) = 0;
+
+    /// \brief Apply a settings change. If the device task is running and the caller is
+    /// not its step, the change is queued and applied before the next step.
+    /// Otherwise nobody else accesses _settings and it is applied directly.
+    void dispatchSettings(SettingsDelta delta);
+
+    /// \brief Apply all queued settings changes in the order they were dispatched.
+    /// Called before every step of the device task, the change notification
+    /// callbacks are therefore called by the device task.
+    void applySettingsDeltas();
+
+    /// \brief The state machine of a device. It is called by the shared executor
+    /// after all queued settings changes have been applied.
+    /// \return The time of the next step, Executor::idle to wait for wakeDeviceTask() or
+    ///         Executor::finished if the device is not available anymore.
+    typedef std::function<Executor::time_point(void)> DeviceStep;
+
+    /// \brief Run the state machine of the device on the shared executor. The device task
+    /// owns _settings from now on. Must be called before other threads may change settings.
+    void startDeviceTask(DeviceStep step);
+
+    /// \brief Remove the device task and apply the queued changes. Blocks until a running
+    /// step has finished, unless it is called by the step itself.
+    void stopDeviceTask();
+
+    /// \return True if the device task is running.
+    bool isDeviceTaskRunning() const { return _taskRunning; }
+
+    /// \return True if the caller may access _settings, because the device task is not
+    /// running or it is the caller.
+    bool ownsSettings() const;
+
+    /// \brief Run the next step of the device task as soon as possible, for example
+    /// after a settings change or when new data is available.
+    void wakeDeviceTask();
 public:
     /**
      * This section contains callback methods. Register your function or class method to get notified
@@ -108,10 +162,9 @@ public:
     /// The oscilloscope stopped sampling/waiting for trigger
     std::function<void(void)> _samplingStopped = [](){};
 
-    /// New sample data is available as channel[data] vectors, the samplerate, rollMode flag
-    /// and mutex to block the communication thread if necessary to parse the incoming data.
-    std::function<void(const std::vector<std::vector<double>>&)> _samplesAvailable
-        = [](const std::vector<std::vector<double>>&){};
+    /// New sample data is available. Subscribers get the frames with channel[data] vectors and a
+    /// copy of the settings they were acquired with. The device task publishes them.
+    FrameBus _frameBus;
 
     /// The available record lengths, empty list for continuous
     /// and the ID for the current record length.
@@ -140,9 +193,42 @@ protected:
     ///    entry{3} = sample, chan1
     ///    if Samplesize >8bit:
     ///       Additional bits are found in the second half of the vector like in a2.
-    /// The result is saved in {@see DeviceBaseSamples::_samples}.
+    /// The result is saved in {@see DeviceBaseSamples::_frame} together with a snapshot of the settings.
+    /// The samples are converted by the table of conversionTable().
     /// You need to override or not use this method if your DSO works in a different way.
-    void processSamples(std::vector<unsigned char>& data);
+    /// \return False if the frame was used by a calibration and must not be published.
+    bool processSamples(std::vector<unsigned char>& data);
+
+    /// \brief Converts a calibrated ADC code to volts. The default is the Hantek conversion,
+    /// the code gainLevel.voltage is the top of the screen and the offset shifts the signal.
+    /// It is only called to build the conversion tables.
+    /// \param gainID The gain level (@see DSO::dsoSpecification.gainLevel[gainID]).
+    /// \param offsetReal The real offset of the channel.
+    /// \param code The ADC code, corrected by the calibration.
+    virtual double convertSample(unsigned gainID, double offsetReal, double code) const;
+
+    /// \brief The lookup table from ADC codes (with the extra bits of >8 bit ADCs) to volts
+    /// for the current gain and offset of a channel, including the calibration. There is a
+    /// table per channel and gain level, it is only rebuilt if offset or calibration changed.
+    /// \return 2^sampleSize values, valid until the settings or the calibration change.
+    const double* conversionTable(unsigned channel);
+
+    /// \brief Rebuild all conversion tables before they are used next, after the
+    /// calibration or the gain levels changed.
+    void invalidateConversionTables() { ++_conversionGeneration; }
+
+    /// \brief Called for every converted frame, before it is published.
+    /// \return True if the frame was consumed by a calibration.
+    virtual bool calibrationFrame() { return false; }
+
+    /// \brief Copy the current settings into a frame snapshot and assign the next sequence number.
+    /// \param settings The snapshot to fill.
+    void snapshotSettings(dsoFrameSettings& settings);
+
+    /// \brief Size the sample buffers of _frame for the current record length and keep
+    /// buffers for the copies of the analyser in the FrameBufferPool, so that the first
+    /// frames after a record length change don't allocate either.
+    void reserveFrameBuffers();
 
     /// \brief Notifies about the minimum and maximum supported samplerate.
     void notifySamplerateLimitsChanged();
@@ -162,9 +248,34 @@ protected:
 
     virtual double getDownsamplerRate(double bestDownsampler, bool maximum) const;
 protected:
-    typedef std::vector<double> data_one_channel;
-    std::vector<data_one_channel> _samples;    ///< Sample data vectors sent to the data analyzer
-    bool _sampling;      ///< true, if the oscilloscope is taking samples
+    dsoFrame _frame;     ///< Sample data vectors and settings sent to the data analyzer
+    std::atomic<bool> _sampling{false};   ///< true, if the oscilloscope is taking samples
+private:
+    MPSCQueue<SettingsDelta> _settingsDeltas;   ///< Changes from other threads for the device task
+    std::atomic<std::thread::id> _stepThread;   ///< The worker running a step of the device task
+    std::atomic<bool> _taskRunning{false};      ///< The device task owns _settings
+    std::shared_ptr<Executor> _executor = Executor::shared(ThreadRole::DEVICE);
+    Executor::TaskHandle _task;                 ///< The device task, kept after it was stopped
+    unsigned long long _frameCounter = 0;       ///< Sequence number of the last frame
+
+    /// The settings read by the public getters of other threads, updated after every step
+    struct SettingsSnapshot {
+        std::atomic<double> samplerate{0.0};
+        std::atomic<bool> rollingMode{false};
+        std::atomic<unsigned> expectedRecordLength{0};
+    } _settingsSnapshot;
+
+    /// \brief Update _settingsSnapshot from _settings. Called by the owner of _settings.
+    void updateSettingsSnapshot();
+
+    /// The conversion table of a channel at one gain level
+    struct ConversionTable {
+        std::vector<double> values;
+        double offsetReal = 0.0;             ///< The offset the table was built for
+        unsigned long long generation = 0;   ///< Outdated if not _conversionGeneration
+    };
+    std::array<std::vector<ConversionTable>, MAX_CHANNELS> _conversionTables;
+    unsigned long long _conversionGeneration = 1;
 };
 
 }
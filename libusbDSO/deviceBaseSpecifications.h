@@ -37,6 +37,7 @@ class DeviceBaseSpecifications {
 public:
     DeviceBaseSpecifications(const DSODeviceDescription& model) : _model(model) {}
     const DSODeviceDescription& getModel() const { return _model; }
+    const dsoSpecification& getSpecification() const { return _specification; }
     unsigned getChannelCount() const {return _specification.channels; }
     unsigned getUsedChannelCount() const {return _settings.usedChannels; }
     dsoRecord& getCurrentRecordType() const { return _settings.samplerate.limits->recordTypes[_settings.recordTypeID]; }
@@ -3,34 +3,116 @@
 #include <iostream>
 
 #include "deviceDescriptionEntry.h"
+#include "utils/threadPolicy.h"
 
 namespace DSO {
 
 DeviceList::DeviceList() {
-    libusb_init(&_usb_context);
+    if(libusb_init(&_usb_context) != LIBUSB_SUCCESS) {
+        std::cerr << "Failed to initialize libusb" << std::endl;
+        _usb_context = nullptr;
+        return;
+    }
+    startEventThread();
 }
 
 DeviceList::~DeviceList() {
     setAutoUpdate(false);
-    libusb_exit(_usb_context);
+    // The event thread completes the transfers the devices cancel on destruction. The devices
+    // are destroyed after the lock is released, like in releaseRemovedDevices().
+    {
+        std::vector<std::shared_ptr<DeviceBase>> devices;
+        std::vector<std::shared_ptr<DeviceBase>> removed;
+        {
+            std::lock_guard<std::mutex> lock(_deviceListMutex);
+            devices.swap(_deviceList);
+            removed.swap(_removedDevices);
+        }
+    }
+    stopEventThread();
+    if(_usb_context)
+        libusb_exit(_usb_context);
+}
+
+void DeviceList::startEventThread() {
+    if(!_usb_context || _eventThreadRunning)
+        return;
+    _eventThreadRunning = true;
+    _eventThread = std::thread(&DeviceList::eventThread, this);
+}
+
+void DeviceList::stopEventThread() {
+    if(!_eventThreadRunning)
+        return;
+    _eventThreadRunning = false;
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+    libusb_interrupt_event_handler(_usb_context);
+#endif
+    if(_eventThread.joinable())
+        _eventThread.join();
+    // Devices are not added or destroyed on the calling thread
+    std::lock_guard<std::mutex> lock(_hotplugMutex);
+    for(const std::pair<libusb_device*, bool>& event: _hotplugEvents)
+        libusb_unref_device(event.first);
+    _hotplugEvents.clear();
+}
+
+void DeviceList::eventThread() {
+    // Completes the asynchronous transfers of the devices and queues the hotplug events
+    ThreadPolicies& policies = ThreadPolicies::instance();
+    unsigned policyGeneration = 0;
+    while(_eventThreadRunning) {
+        policies.applyIfChanged(ThreadRole::DEVICE, policyGeneration);
+        // Older libusb versions can not be interrupted, the timeout limits the time stopEventThread() waits
+        struct timeval t = {0, 200000};
+        libusb_handle_events_timeout_completed(_usb_context, &t, nullptr);
+        processHotplugEvents();
+    }
 }
 
 void DeviceList::registerModel(const DSODeviceDescription& model) {
-    _registeredModels.push_back(model);
+    {
+        std::lock_guard<std::mutex> lock(_deviceListMutex);
+        _registeredModels.push_back(model);
+    }
     _modelsChanged();
 }
 
 int hotplug_callback_fn(libusb_context *ctx, libusb_device *device, libusb_hotplug_event event, void *user_data) {
-    if (event==LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED)
-        ((DeviceList*)user_data)->hotplugAdd(device);
-    else
-        ((DeviceList*)user_data)->hotplugRemove(device);
-
+    ((DeviceList*)user_data)->hotplugEvent(device, event==LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
     return 0; // if we return 1 this callback is deregistered.
 }
 
+void DeviceList::hotplugEvent(libusb_device *device, bool arrived) {
+    // Devices must not be opened or closed within a libusb callback
+    std::lock_guard<std::mutex> lock(_hotplugMutex);
+    _hotplugEvents.push_back(std::make_pair(libusb_ref_device(device), arrived));
+}
+
+void DeviceList::processHotplugEvents() {
+    // Held while processing, setAutoUpdate(false) waits for running events
+    std::lock_guard<std::mutex> lock(_hotplugMutex);
+    std::vector<std::pair<libusb_device*, bool>> events;
+    events.swap(_hotplugEvents);
+    for(const std::pair<libusb_device*, bool>& event: events) {
+        // Events queued before autoupdate was disabled are dropped
+        if(_autoUpdate && event.second)
+            hotplugAdd(event.first);
+        else if(_autoUpdate)
+            hotplugRemove(event.first);
+        libusb_unref_device(event.first);
+    }
+}
+
 void DeviceList::hotplugAdd(libusb_device *device) {
     uint8_t uniqueID = libusb_get_port_number(device);
+
+    // Filter device
+    libusb_device_descriptor descriptor;
+    if(libusb_get_device_descriptor(device, &(descriptor)) < 0)
+        return;
+
+    std::unique_lock<std::mutex> lock(_deviceListMutex);
     // Check if device is connected and known already
     for(auto itr = _deviceList.begin(); itr != _deviceList.end();++itr) {
         if (itr->get()->getUniqueID() == uniqueID) {
@@ -38,11 +120,6 @@ void DeviceList::hotplugAdd(libusb_device *device) {
         }
     }
 
-    // Filter device
-    libusb_device_descriptor descriptor;
-    if(libusb_get_device_descriptor(device, &(descriptor)) < 0)
-        return;
-
     const DSODeviceDescription* foundModel = nullptr;
 
     for(const DSODeviceDescription& model: _registeredModels) {
@@ -66,40 +143,54 @@ void DeviceList::hotplugAdd(libusb_device *device) {
 
     // Add device
     DeviceBase* d = foundModel->createDevice(device, *foundModel);
-    _deviceList.push_back(std::unique_ptr<DeviceBase>(d));
+    _deviceList.push_back(std::shared_ptr<DeviceBase>(d));
+    lock.unlock();
     _listChanged();
 }
 
 void DeviceList::hotplugRemove(libusb_device *device) {
     uint8_t uniqueID = libusb_get_port_number(device);
-    bool changed = false;
-    for(auto itr = _deviceList.begin(); itr != _deviceList.end();) {
-        if (itr->get()->getUniqueID() == uniqueID) {
-            itr = _deviceList.erase(itr);
-            changed = true;
+    // Removed devices are destroyed by the owner, see releaseRemovedDevices()
+    bool removed = false;
+    {
+        std::lock_guard<std::mutex> lock(_deviceListMutex);
+        for(auto itr = _deviceList.begin(); itr != _deviceList.end();) {
+            if (itr->get()->getUniqueID() == uniqueID) {
+                _removedDevices.push_back(*itr);
+                itr = _deviceList.erase(itr);
+                removed = true;
+            } else
+                ++itr;
         }
     }
 
-    if (changed)
+    if (removed)
         _listChanged();
 }
 
-void DeviceList::checkForDevices() const
-{
-    struct timeval t = {0,0};
-    libusb_handle_events_timeout_completed(nullptr, &t, nullptr);
+void DeviceList::releaseRemovedDevices() {
+    std::vector<std::shared_ptr<DeviceBase>> removed;
+    {
+        std::lock_guard<std::mutex> lock(_deviceListMutex);
+        removed.swap(_removedDevices);
+    }
+    // Destroyed here, after the lock is released
 }
 
 void DeviceList::setAutoUpdate(bool autoUpdate) {
     // Unregister callback before doing anything else
     if (_autoUpdate && _callback_handle) {
-        libusb_hotplug_deregister_callback(nullptr, _callback_handle);
+        libusb_hotplug_deregister_callback(_usb_context, _callback_handle);
         _callback_handle = 0;
     }
-    _autoUpdate = autoUpdate;
+    {
+        // Waits for the events the event thread is processing, queued ones are dropped
+        std::lock_guard<std::mutex> lock(_hotplugMutex);
+        _autoUpdate = autoUpdate && _usb_context;
+    }
     if (_autoUpdate) {
         int err;
-        err = libusb_hotplug_register_callback(nullptr,
+        err = libusb_hotplug_register_callback(_usb_context,
                                          libusb_hotplug_event(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED|LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
                                          libusb_hotplug_flag(0), // no flags
                                          LIBUSB_HOTPLUG_MATCH_ANY, // vendor
@@ -116,9 +207,10 @@ void DeviceList::setAutoUpdate(bool autoUpdate) {
 }
 
 int DeviceList::update() {
-    int errorCode = libusb_init(&(_usb_context));
-    if(errorCode != LIBUSB_SUCCESS)
-        return errorCode;
+    if(!_usb_context)
+        return LIBUSB_ERROR_OTHER;
+
+    releaseRemovedDevices();
 
     libusb_device **deviceList;
 
@@ -133,16 +225,20 @@ int DeviceList::update() {
     /// \todo Remove old devices
 
     libusb_free_device_list(deviceList, true);
-    return errorCode;
+    return LIBUSB_SUCCESS;
 }
 
 void DeviceList::addDevice(DeviceBase* device) {
-    _deviceList.push_back(std::shared_ptr<DeviceBase>(device));
+    {
+        std::lock_guard<std::mutex> lock(_deviceListMutex);
+        _deviceList.push_back(std::shared_ptr<DeviceBase>(device));
+    }
     _listChanged();
 }
 
 std::shared_ptr<DeviceBase> DeviceList::getDeviceByUID(unsigned uid)
 {
+    std::lock_guard<std::mutex> lock(_deviceListMutex);
     for (std::shared_ptr<DSO::DeviceBase>& device: _deviceList) {
         if (device->getUniqueID() == uid)
             return device;
@@ -150,12 +246,14 @@ std::shared_ptr<DeviceBase> DeviceList::getDeviceByUID(unsigned uid)
     return nullptr;
 }
 
-const std::vector<std::shared_ptr<DeviceBase> >& DeviceList::getList() const {
+std::vector<std::shared_ptr<DeviceBase> > DeviceList::getList() const {
+    std::lock_guard<std::mutex> lock(_deviceListMutex);
     return _deviceList;
 }
 
 const std::vector<DSODeviceDescription> DeviceList::getKnownModels() const
 {
+    std::lock_guard<std::mutex> lock(_deviceListMutex);
     return _registeredModels;
 }
 
@@ -2,6 +2,10 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <utility>
 
 #include "deviceBase.h"
 
@@ -12,6 +16,10 @@ namespace DSO {
 
 /**
  * A list of all connected usb DSO devices.
+ *
+ * The list owns the libusb context of all devices and a thread that handles its
+ * events: Hotplug notifications and the completions of asynchronous transfers.
+ * The signals are therefore called by the event thread.
  */
 class DeviceList {
     public:
@@ -22,9 +30,21 @@ class DeviceList {
         /// autoupdate is enabled or if update() is called.
         void registerModel(const DSODeviceDescription& model);
 
-        /// Enable/disable automatic device discovery / hotplugging
+        /// Enable/disable automatic device discovery / hotplugging. After disabling
+        /// it, no hotplug event changes the list or calls _listChanged anymore.
         void setAutoUpdate(bool autoUpdate);
 
+        /// Start the libusb event thread. Called by the constructor.
+        void startEventThread();
+
+        /// Stop the libusb event thread and wait for it. Called by the destructor.
+        /// Asynchronous transfers do not complete while the thread is stopped and
+        /// queued hotplug events are dropped, call update() after a restart.
+        void stopEventThread();
+
+        /// \return The libusb context of all devices in this list.
+        libusb_context* context() const { return _usb_context; }
+
         /// Update the deviceList manually
         /// \return Return a libusb errorcode or LIBUSB_SUCCESS if successful.
         int update();
@@ -44,9 +64,15 @@ class DeviceList {
           */
         std::shared_ptr<DeviceBase> getDeviceByUID(unsigned uid);
 
-        /// Get list of devices. This is a vector of unique pointers
-        /// -> You are not allowed to copy this vector.
-        const std::vector<std::shared_ptr<DeviceBase>>& getList() const;
+        /// Get list of devices. This is a copy, the list may be changed by the event thread.
+        std::vector<std::shared_ptr<DeviceBase>> getList() const;
+
+        /// Destroy the devices that have been removed from the list by hotplug events
+        /// and are not referenced anymore. The event thread does not destroy devices,
+        /// because that waits for their threads and transfers. Call it from the thread
+        /// that owns the list, e.g. after _listChanged. Also called by update() and the
+        /// destructor.
+        void releaseRemovedDevices();
 
         /// Get list of known models.
         const std::vector<DSODeviceDescription> getKnownModels() const;
@@ -54,19 +80,36 @@ class DeviceList {
         void hotplugAdd(libusb_device *device);
         void hotplugRemove(libusb_device *device);
 
-        /// To be called periodically so that hotplug events work
-        void checkForDevices() const;
+        /// Called by libusb within the event thread. Queues the event, it is processed
+        /// by the event thread as soon as libusb returns.
+        void hotplugEvent(libusb_device *device, bool arrived);
 
         /// Signal: list has changed
         std::function<void(void)> _listChanged = [](){};
         /// Signal: supported models changed
         std::function<void(void)> _modelsChanged = [](){};
 private:
-    std::vector<std::shared_ptr<DeviceBase>> _deviceList;
+    /// The event loop: Handles libusb events until stopEventThread() is called.
+    void eventThread();
+
+    /// Add and remove the devices of all queued hotplug events.
+    void processHotplugEvents();
+
+    std::vector<std::shared_ptr<DeviceBase>> _deviceList; ///< Protected by _deviceListMutex
+    /// Removed by hotplug events, released by the owner. Protected by _deviceListMutex
+    std::vector<std::shared_ptr<DeviceBase>> _removedDevices;
+    mutable std::mutex _deviceListMutex;
     std::vector<DSODeviceDescription> _registeredModels;
     bool _autoUpdate = false;
     libusb_context* _usb_context = nullptr;
     int _callback_handle = 0;
+
+    std::thread _eventThread;
+    std::atomic<bool> _eventThreadRunning {false};
+    /// Referenced devices with true for arrival and false for departure
+    std::vector<std::pair<libusb_device*, bool>> _hotplugEvents;
+    /// Protects _hotplugEvents and _autoUpdate, held while the events are processed
+    std::mutex _hotplugMutex;
 };
 
 }
@@ -9,6 +9,8 @@ public:
     using DeviceBase::DeviceBase;
     virtual void updatePretriggerPosition(double position) {}
     virtual void updateRecordLength(unsigned int index) {}
+    virtual void updateChannelUsed(unsigned int channel, bool used) {}
+    virtual void updateCoupling(unsigned int channel, DSO::Coupling coupling) {}
     virtual void updateSamplerate(DSO::ControlSamplerateLimits *limits, unsigned int downsampler, bool fastRate) {}
     virtual void updateGain(unsigned channel, unsigned char gain, unsigned gainId) {}
     virtual void updateOffset(unsigned int channel, unsigned short int offsetValue) {}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  dsoFrame.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <chrono>
+
+#include "dsoSettings.h"
+#include "utils/frameBufferPool.h"
+
+namespace DSO {
+
+    //////////////////////////////////////////////////////////////////////////////
+    /// \struct dsoFrameChannel
+    /// \brief The amplification settings of one channel when the frame was acquired.
+    struct dsoFrameChannel {
+        bool used         = false;///< true, if the channel was sampled
+        unsigned int gainID = 0;  ///< The gain id (@see DSO::dsoSpecification.gainLevel[gainID])
+        double gain       = 0.0;  ///< The voltage steps in V/screenheight
+        double offset     = 0.0;  ///< The screen offset
+        double offsetReal = 0.0;  ///< The real offset (Due to quantization)
+        Coupling coupling = Coupling::DC; ///< The coupling
+    };
+
+    //////////////////////////////////////////////////////////////////////////////
+    /// \struct dsoFrameSettings
+    /// \brief The device settings that were used to acquire one frame.
+    /// It is a copy, so it can be used by other threads without locking while
+    /// the device continues with other settings.
+    struct dsoFrameSettings {
+        unsigned long long id    = 0;     ///< Sequence number of the frame
+        std::chrono::steady_clock::time_point timestamp; ///< Host time when the frame was completed
+        double samplerate        = 0.0;   ///< The samplerate in S/s
+        bool rollMode            = false; ///< true, if the samples continue the previous frame
+        bool fastRate            = false; ///< true, if one channel used all buffers
+        unsigned int recordTypeID = 0;    ///< The id of the record type
+        unsigned int recordLength = 0;    ///< The record length per channel, rollModeValue if rolling
+        unsigned int channels    = 0;     ///< The number of valid entries in channel
+        std::array<dsoFrameChannel,MAX_CHANNELS> channel; ///< The amplification settings
+        unsigned int triggerPoint = 0;    ///< The trigger position in Hantek coding
+        double pretrigger_pos_in_s = 0;   ///< The pretrigger position in s
+        TriggerMode triggerMode  = TriggerMode::NORMAL; ///< The trigger mode
+        Slope triggerSlope       = Slope::POSITIVE; ///< The trigger slope
+        bool triggerSpecial      = false; ///< true, if the trigger source is special
+        unsigned int triggerSource = 0;   ///< The trigger source
+    };
+
+    //////////////////////////////////////////////////////////////////////////////
+    /// \struct dsoFrame
+    /// \brief One acquisition: the samples of all channels and their settings.
+    struct dsoFrame {
+        dsoFrameSettings settings;                 ///< The settings of this acquisition
+        std::vector<SampleBuffer> samples;         ///< The voltage values for each channel (V), from the FrameBufferPool
+    };
+}
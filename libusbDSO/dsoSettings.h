@@ -38,7 +38,7 @@ namespace DSO {
     /// \struct dsoSettingsSamplerate
     /// \brief Stores the current samplerate settings of the device.
     struct dsoSettingsSamplerate {
-        double target_samplerate;        ///< The target samplerate set via setSamplerate
+        double target_samplerate  = 1e8; ///< The target samplerate set via setSamplerate
         ControlSamplerateLimits *limits; ///< The samplerate limits
         unsigned int downsampler  = 1;   ///< The variable downsampling factor
         double current            = 1e8; ///< The current samplerate
@@ -2,6 +2,7 @@
 
 /// \todo Make channels configurable
 
+#include <string>
 #include <vector>
 
 namespace DSO {
@@ -36,6 +37,19 @@ namespace DSO {
         std::vector<dsoRecord> recordTypes;
     };
 
+    //////////////////////////////////////////////////////////////////////////////
+    /// \struct dsoAdcCalibration
+    /// \brief Corrects the ADC codes of one channel at one gain level before they are
+    /// converted to volts: corrected = (code - offset) * gain - linearity[code].
+    /// The default is an ideal ADC.
+    struct dsoAdcCalibration {
+        double offset = 0.0; ///< The code the ADC reports for the code 0
+        double gain   = 1.0; ///< Correction factor of the code steps
+        std::vector<float> linearity; ///< Remaining error per code after offset and gain, empty if linear
+
+        bool isIdeal() const { return offset == 0.0 && gain == 1.0 && linearity.empty(); }
+    };
+
     struct dsoGainLevel {
         /// The index of the selected gain on the hardware
         unsigned char gainIndex;
@@ -45,6 +59,8 @@ namespace DSO {
         unsigned short int voltage;
         // Calibration per channel
         dsoShortMinMax offset[MAX_CHANNELS];
+        /// ADC calibration per channel
+        dsoAdcCalibration calibration[MAX_CHANNELS];
 
         dsoGainLevel(unsigned char gainIndex, double gainSteps, unsigned short int voltage)
             : gainIndex(gainIndex), gainSteps(gainSteps), voltage(voltage) {}
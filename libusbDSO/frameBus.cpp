@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  frameBus.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "frameBus.h"
+
+namespace DSO {
+
+class FrameBus::Subscription {
+public:
+    Subscription(Handler handler, unsigned capacity, Backpressure backpressure, ThreadRole role)
+        : handler(std::move(handler)), backpressure(backpressure),
+          queue(std::max(capacity, 1u)), executor(Executor::shared(role)) {}
+
+    const Handler handler;
+    const Backpressure backpressure;
+    std::vector<SharedFrame> queue; ///< Ring buffer of the waiting frames, protected by the bus mutex
+    unsigned head = 0;              ///< The oldest waiting frame
+    unsigned count = 0;             ///< The number of waiting frames
+    Statistics statistics;          ///< Protected by the bus mutex
+    std::shared_ptr<Executor> executor;
+    Executor::TaskHandle task;
+};
+
+/// The released frames. The mutex hands the buffers of a frame from the subscriber
+/// that released it last to the publisher.
+struct FrameBus::Pool {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<dsoFrame>> frames;
+};
+
+FrameBus::FrameBus() : _pool(std::make_shared<Pool>()) {}
+
+FrameBus::~FrameBus() {
+    std::vector<SubscriptionHandle> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        subscriptions.swap(_subscriptions);
+    }
+    for(const SubscriptionHandle& subscription: subscriptions)
+        subscription->executor->cancel(subscription->task);
+}
+
+FrameBus::SubscriptionHandle FrameBus::subscribe(Handler handler, unsigned capacity, Backpressure backpressure,
+                                                 ThreadRole role) {
+    SubscriptionHandle subscription(new Subscription(std::move(handler), capacity, backpressure, role));
+    Subscription* const s = subscription.get();
+
+    // Deliver one frame per step, so that other tasks of the executor get their turn
+    subscription->task = subscription->executor->schedule([this, s]() -> Executor::time_point {
+        SharedFrame frame;
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(!s->count)
+                return Executor::idle;
+            frame = std::move(s->queue[s->head]);
+            s->head = (s->head + 1) % s->queue.size();
+            more = --s->count > 0;
+            ++s->statistics.delivered;
+        }
+        s->handler(frame);
+        return more ? Executor::time_point() : Executor::idle;
+    });
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _subscriptions.push_back(subscription);
+    return subscription;
+}
+
+void FrameBus::unsubscribe(const SubscriptionHandle& subscription) {
+    if(!subscription)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _subscriptions.erase(std::remove(_subscriptions.begin(), _subscriptions.end(), subscription),
+                             _subscriptions.end());
+    }
+    // Not with the mutex held, the running step may wait for it
+    subscription->executor->cancel(subscription->task);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(SharedFrame& frame: subscription->queue)
+        frame.reset();
+    subscription->count = 0;
+}
+
+FrameBus::Statistics FrameBus::statistics(const SubscriptionHandle& subscription) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return subscription ? subscription->statistics : Statistics();
+}
+
+bool FrameBus::congested() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const SubscriptionHandle& subscription: _subscriptions)
+        if(subscription->count == subscription->queue.size())
+            return true;
+    return false;
+}
+
+std::shared_ptr<dsoFrame> FrameBus::recycledFrame() {
+    std::unique_ptr<dsoFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(_pool->mutex);
+        if(!_pool->frames.empty()) {
+            frame = std::move(_pool->frames.back());
+            _pool->frames.pop_back();
+        }
+    }
+    if(!frame)
+        frame.reset(new dsoFrame());
+
+    std::shared_ptr<Pool> pool = _pool;
+    return std::shared_ptr<dsoFrame>(frame.release(), [pool](dsoFrame* released) {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->frames.emplace_back(released);
+    });
+}
+
+void FrameBus::publish(dsoFrame& frame) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_subscriptions.empty())
+            return;
+    }
+
+    // Exchange the buffers instead of copying the samples
+    std::shared_ptr<dsoFrame> shared = recycledFrame();
+    shared->settings = frame.settings;
+    shared->samples.resize(frame.samples.size());
+    for(unsigned channel = 0; channel < frame.samples.size(); ++channel)
+        shared->samples[channel].swap(frame.samples[channel]);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const SubscriptionHandle& subscription: _subscriptions) {
+        Subscription& s = *subscription;
+        const unsigned capacity = s.queue.size();
+        if(s.count == capacity) {
+            ++s.statistics.dropped;
+            if(s.backpressure == Backpressure::DROP_NEWEST)
+                continue;
+            s.queue[s.head].reset();
+            s.head = (s.head + 1) % capacity;
+            --s.count;
+        }
+        s.queue[(s.head + s.count) % capacity] = shared;
+        ++s.count;
+        s.executor->wake(s.task);
+    }
+}
+
+}
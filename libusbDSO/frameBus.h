@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  frameBus.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dsoFrame.h"
+#include "utils/executor.h"
+
+namespace DSO {
+
+/// A published frame. Subscribers may keep it as long as they need it.
+typedef std::shared_ptr<const dsoFrame> SharedFrame;
+
+//////////////////////////////////////////////////////////////////////////////
+/// \enum Backpressure
+/// \brief What happens to a new frame if the queue of a subscriber is full.
+enum class Backpressure {
+    DROP_NEWEST, ///< The new frame is dropped, the queued frames are delivered without gaps
+    DROP_OLDEST  ///< The oldest queued frame is dropped, the subscriber gets the latest frames
+};
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief Distributes the frames of a device to any number of subscribers.
+///
+/// Every subscriber has a bounded queue and a task on the executor of its role,
+/// which calls its handler for the queued frames. Publishing only queues a shared
+/// pointer per subscriber, so a slow subscriber never delays the device or the
+/// other subscribers, it loses frames according to its Backpressure instead.
+///
+/// The frames are not copied: publish() moves the sample buffers of the device
+/// frame into a shared frame and gives the device the buffers of a frame that all
+/// subscribers have released.
+class FrameBus {
+public:
+    /// Called for every delivered frame. Calls of one subscriber never overlap.
+    typedef std::function<void(const SharedFrame&)> Handler;
+
+    class Subscription;
+    typedef std::shared_ptr<Subscription> SubscriptionHandle;
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \struct Statistics
+    /// \brief The frames of a subscriber since it subscribed.
+    struct Statistics {
+        unsigned long long delivered = 0; ///< Frames passed to the handler
+        unsigned long long dropped = 0;   ///< Frames lost because the queue was full
+    };
+
+    FrameBus();
+    ~FrameBus();
+
+    FrameBus(const FrameBus&) = delete;
+    FrameBus& operator=(const FrameBus&) = delete;
+
+    /// \brief Add a subscriber.
+    /// \param handler Called with every frame that is not dropped.
+    /// \param capacity The number of frames that may wait for the handler, at least 1.
+    /// \param backpressure Which frames are dropped if the handler can't keep up.
+    /// \param role The executor that runs the handler.
+    /// \return The handle to unsubscribe and to get the statistics.
+    SubscriptionHandle subscribe(Handler handler, unsigned capacity, Backpressure backpressure,
+                                 ThreadRole role = ThreadRole::ANALYSER);
+
+    /// \brief Remove a subscriber. Blocks until a running handler returned, unless it is
+    /// called by the handler. Queued frames are discarded.
+    void unsubscribe(const SubscriptionHandle& subscription);
+
+    /// \return The delivered and dropped frames of a subscriber.
+    Statistics statistics(const SubscriptionHandle& subscription) const;
+
+    /// \brief Send a frame to all subscribers. Called by the device task.
+    /// \param frame The frame of the device. Its sample buffers are exchanged with
+    ///        released ones of the same channel count, their content is undefined.
+    void publish(dsoFrame& frame);
+
+    /// \return True if the queue of a subscriber is full, the next frame would be dropped.
+    bool congested() const;
+
+private:
+    struct Pool;
+
+    /// \return A frame that is not used by any subscriber. It returns to the pool when
+    /// the last subscriber released it.
+    std::shared_ptr<dsoFrame> recycledFrame();
+
+    mutable std::mutex _mutex;
+    std::vector<SubscriptionHandle> _subscriptions; ///< Protected by _mutex
+    std::shared_ptr<Pool> _pool; ///< Shared with the published frames, they may outlive the bus
+};
+
+}
@@ -24,26 +24,44 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += deviceBase.cpp \
+           compositeDevice.cpp \
            deviceList.cpp \
            usbCommunicationQueues.cpp \
            deviceBaseSamples.cpp \
            usbCommunication.cpp \
+           usbTransferPolicy.cpp \
+           selfCalibration.cpp \
+           frameBus.cpp \
            utils/transferBuffer.cpp \
+           utils/executor.cpp \
+           utils/decimator.cpp \
+           utils/frameBufferPool.cpp \
+           utils/threadPolicy.cpp \
            utils/stdstringsplit.cpp
 
 HEADERS += deviceBase.h \
+           compositeDevice.h \
            devicedummy.h \
            errorcodes.h \
            deviceBaseSamples.h \
            deviceList.h \
            usbCommunication.h \
+           usbTransferPolicy.h \
+           selfCalibration.h \
+           frameBus.h \
            deviceBaseSpecifications.h \
            dsoSettings.h \
+           dsoFrame.h \
            usbCommunicationQueues.h \
            deviceDescriptionEntry.h \
            dsoSpecification.h \
            utils/containerStream.h \
            utils/stdStringSplit.h \
+           utils/mpscQueue.h \
+           utils/executor.h \
+           utils/decimator.h \
+           utils/frameBufferPool.h \
+           utils/threadPolicy.h \
            utils/timestampDebug.h \
            utils/transferBuffer.h
 
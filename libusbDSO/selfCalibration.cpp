@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  selfCalibration.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "selfCalibration.h"
+
+namespace DSO {
+
+SelfCalibration::SelfCalibration(unsigned channels, unsigned gainLevels)
+    : _channels(channels), _gainLevels(gainLevels),
+      _measuredSum(channels), _expectedSum(channels),
+      _measurements(channels * gainLevels) {
+}
+
+double SelfCalibration::offset() const {
+    // Keep a margin to the ends of the ADC range, clipped codes are useless
+    const unsigned index = _step % CALIBRATION_OFFSET_STEPS;
+    return 0.1 + 0.8 * index / (CALIBRATION_OFFSET_STEPS - 1);
+}
+
+int SelfCalibration::progress() const {
+    const unsigned steps = _gainLevels * CALIBRATION_OFFSET_STEPS;
+    return steps ? std::min(_step, steps) * 100 / steps : 100;
+}
+
+bool SelfCalibration::addFrame(const std::vector<double>& measured, const std::vector<double>& expected) {
+    if(finished())
+        return false;
+
+    // The first frames may have been captured before the settings were applied
+    if(++_frames <= CALIBRATION_SETTLE_FRAMES)
+        return false;
+
+    for(unsigned channel = 0; channel < _channels && channel < measured.size(); ++channel) {
+        _measuredSum[channel] += measured[channel];
+        _expectedSum[channel] += expected[channel];
+    }
+    if(_frames < CALIBRATION_SETTLE_FRAMES + CALIBRATION_AVERAGE_FRAMES)
+        return false;
+
+    for(unsigned channel = 0; channel < _channels; ++channel) {
+        _measurements[gainID() * _channels + channel].push_back(
+                    Measurement{_measuredSum[channel] / CALIBRATION_AVERAGE_FRAMES,
+                                _expectedSum[channel] / CALIBRATION_AVERAGE_FRAMES});
+        _measuredSum[channel] = _expectedSum[channel] = 0.0;
+    }
+    _frames = 0;
+    ++_step;
+    return true;
+}
+
+dsoAdcCalibration SelfCalibration::result(unsigned channel, unsigned gainID, unsigned codes) const {
+    dsoAdcCalibration calibration;
+    if(channel >= _channels || gainID >= _gainLevels)
+        return calibration;
+
+    // Only measurements within the ADC range
+    std::vector<Measurement> points;
+    for(const Measurement& point: _measurements[gainID * _channels + channel])
+        if(point.measured >= 1.0 && point.measured <= codes - 2.0)
+            points.push_back(point);
+    if(points.empty())
+        return calibration;
+
+    double meanMeasured = 0.0, meanExpected = 0.0;
+    double minExpected = points.front().expected, maxExpected = minExpected;
+    for(const Measurement& point: points) {
+        meanMeasured += point.measured;
+        meanExpected += point.expected;
+        minExpected = std::min(minExpected, point.expected);
+        maxExpected = std::max(maxExpected, point.expected);
+    }
+    meanMeasured /= points.size();
+    meanExpected /= points.size();
+
+    // Without a hardware offset all measurements are at the same code
+    if(maxExpected - minExpected < 1.0) {
+        calibration.offset = meanMeasured - meanExpected;
+        return calibration;
+    }
+
+    // Least squares fit of expected = gain * (measured - offset)
+    double varianceMeasured = 0.0, covariance = 0.0;
+    for(const Measurement& point: points) {
+        varianceMeasured += (point.measured - meanMeasured) * (point.measured - meanMeasured);
+        covariance += (point.measured - meanMeasured) * (point.expected - meanExpected);
+    }
+    if(varianceMeasured <= 0.0 || covariance <= 0.0)
+        return calibration; // The ADC doesn't follow the offset, the input is probably not grounded
+    calibration.gain = covariance / varianceMeasured;
+    calibration.offset = meanMeasured - meanExpected / calibration.gain;
+
+    // Two points are always on the line
+    if(points.size() < 3)
+        return calibration;
+
+    // Interpolate the remaining error between the measured codes
+    std::sort(points.begin(), points.end(),
+              [](const Measurement& a, const Measurement& b) { return a.measured < b.measured; });
+    std::vector<double> error(points.size());
+    for(unsigned index = 0; index < points.size(); ++index)
+        error[index] = (points[index].measured - calibration.offset) * calibration.gain - points[index].expected;
+
+    calibration.linearity.resize(codes);
+    unsigned segment = 0;
+    for(unsigned code = 0; code < codes; ++code) {
+        while(segment + 2 < points.size() && code > points[segment + 1].measured)
+            ++segment;
+        const Measurement& left = points[segment];
+        const Measurement& right = points[segment + 1];
+        double position = 0.0;
+        if(right.measured > left.measured)
+            position = std::min(std::max((code - left.measured) / (right.measured - left.measured), 0.0), 1.0);
+        calibration.linearity[code] = (float) (error[segment] + (error[segment + 1] - error[segment]) * position);
+    }
+    return calibration;
+}
+
+}
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  selfCalibration.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+#include "dsoSpecification.h"
+
+namespace DSO {
+
+#define CALIBRATION_OFFSET_STEPS   6 ///< Offsets measured at every gain level
+#define CALIBRATION_SETTLE_FRAMES  2 ///< Frames dropped after the settings changed
+#define CALIBRATION_AVERAGE_FRAMES 1 ///< Frames averaged for one measurement
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief Plans the measurements of a self calibration and fits the ADC calibration
+/// from them.
+///
+/// The inputs have to be grounded. At every gain level the offset of the channels
+/// is swept over the screen and the code the ADC reports for 0 V is compared with
+/// the code the offset should result in. Offset and gain are fitted by least squares,
+/// the remaining error is interpolated between the measured codes. Devices without a
+/// hardware offset only get their offset corrected.
+class SelfCalibration {
+public:
+    SelfCalibration(unsigned channels, unsigned gainLevels);
+
+    /// \return The gain level of the current measurement.
+    unsigned gainID() const { return _step / CALIBRATION_OFFSET_STEPS; }
+
+    /// \return The offset (0.0 - 1.0) of the current measurement.
+    double offset() const;
+
+    /// \return True if all measurements are done.
+    bool finished() const { return _step >= _gainLevels * CALIBRATION_OFFSET_STEPS; }
+
+    /// \return The progress in percent.
+    int progress() const;
+
+    /// \brief Account a frame captured with the current settings.
+    /// \param measured The mean ADC code of each channel.
+    /// \param expected The code 0 V should have for each channel.
+    /// \return True if the measurement is done and the settings of the next one have to be applied.
+    bool addFrame(const std::vector<double>& measured, const std::vector<double>& expected);
+
+    /// \brief Fit the calibration of a channel at a gain level.
+    /// \param codes The number of codes of the ADC.
+    /// \return The calibration, ideal if the measurements are not usable.
+    dsoAdcCalibration result(unsigned channel, unsigned gainID, unsigned codes) const;
+
+private:
+    struct Measurement {
+        double measured;
+        double expected;
+    };
+
+    const unsigned _channels;
+    const unsigned _gainLevels;
+    unsigned _step = 0;   ///< The current measurement, gain level after gain level
+    unsigned _frames = 0; ///< Frames captured with the current settings
+    std::vector<double> _measuredSum;
+    std::vector<double> _expectedSum;
+    std::vector<std::vector<Measurement>> _measurements; ///< Indexed by gainID * channels + channel
+};
+
+}
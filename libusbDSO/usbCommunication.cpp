@@ -26,6 +26,7 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 #include <libusb-1.0/libusb.h>
 
@@ -54,6 +55,10 @@ void USBCommunication::setDisconnected_signal(const std::function<void ()>& disc
     _disconnected_signal = disconnected_signal;
 }
 
+USBTransferPolicy& USBCommunication::transferPolicy() {
+    return _transferPolicy;
+}
+
 /// \brief Search for compatible devices.
 /// \return A string with the result of the search.
 int USBCommunication::connect() {
@@ -151,6 +156,18 @@ void USBCommunication::disconnect() {
     if(!handle)
         return;
 
+    // Make transfer problems visible
+    for(const auto& endpoint: _transferPolicy.getStatistics()) {
+        const TransferStatistics& statistics = endpoint.second;
+        if(statistics.retries || statistics.timeouts || statistics.errors)
+            std::cout << _model.modelName << " endpoint 0x" << std::hex << (unsigned) endpoint.first << std::dec
+                      << ": " << statistics.transfers << " transfers, " << statistics.retries << " retries, "
+                      << statistics.timeouts << " timeouts, " << statistics.errors << " errors" << std::endl;
+    }
+
+    // libusb must not free the running transfers
+    cancelTransfers();
+
     // Release claimed interface
     libusb_release_interface(handle, _interface);
     _interface = -1;
@@ -173,16 +190,26 @@ bool USBCommunication::isConnected() const {
 /// \param data Buffer for the sent/recieved data.
 /// \param length The length of the packet.
 /// \param attempts The number of attempts, that are done on timeouts.
-/// \param timeout The timeout in ms.
+/// \param timeout The timeout in ms, 0 for the adaptive timeout of the endpoint.
 /// \return Number of transferred bytes on success, libusb error code on error.
 int USBCommunication::bulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length, int attempts, unsigned int timeout) {
     if(!handle)
         return LIBUSB_ERROR_NO_DEVICE;
 
     int errorCode = LIBUSB_ERROR_TIMEOUT;
-    int transferred;
-    for(int attempt = 0; (attempt < attempts || attempts == -1) && errorCode == LIBUSB_ERROR_TIMEOUT; ++attempt)
-            errorCode = libusb_bulk_transfer(handle, endpoint, data, length, &transferred, timeout);
+    int transferred = 0;
+    int attempt = 0;
+    std::chrono::steady_clock::time_point start;
+    for(; (attempt < attempts || attempts == -1) && errorCode == LIBUSB_ERROR_TIMEOUT; ++attempt) {
+        start = std::chrono::steady_clock::now();
+        errorCode = libusb_bulk_transfer(handle, endpoint, data, length, &transferred,
+                                         timeout ? timeout : _transferPolicy.timeout(endpoint, length, attempt));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    _transferPolicy.record(endpoint, errorCode < 0 ? errorCode : transferred, attempt - 1, elapsed);
+    if(errorCode >= 0 && transferred > ((endpoint & LIBUSB_ENDPOINT_IN) ? inPacketLength : outPacketLength))
+        _transferPolicy.recordThroughput(endpoint, transferred, elapsed);
 
     if(errorCode == LIBUSB_ERROR_NO_DEVICE)
         disconnect();
@@ -217,16 +244,19 @@ int USBCommunication::bulkRead(unsigned char *data, unsigned int length) {
 /// \param attempts The number of attempts, that are done on timeouts.
 /// \return Number of received bytes on success, libusb error code on error.
 int USBCommunication::bulkReadMulti(unsigned char *data, unsigned int length) {
+    const auto start = std::chrono::steady_clock::now();
     unsigned received = 0;
     while(received < length) {
         unsigned read_size = std::min(length - received, (unsigned) inPacketLength);
-        int errorCode = bulkTransfer(_model.bulk_endpoint_in, data, read_size, USB_COMM_ATTEMPTS_MULTI, USB_COMM_TIMEOUT_MULTI);
+        int errorCode = bulkTransfer(_model.bulk_endpoint_in, data, read_size, USB_COMM_ATTEMPTS_MULTI);
         if(errorCode <= 0)
             return errorCode;
         data += read_size;
         received += errorCode;
     }
 
+    // The packets are read one by one, their throughput is measured as a whole
+    _transferPolicy.recordThroughput(_model.bulk_endpoint_in, received, std::chrono::steady_clock::now() - start);
     return received;
 }
 
@@ -243,10 +273,19 @@ int USBCommunication::controlTransfer(unsigned char type, unsigned char request,
     if(!handle)
         return LIBUSB_ERROR_NO_DEVICE;
 
+    // Control transfers are accounted by their direction
+    const unsigned char endpoint = type & LIBUSB_ENDPOINT_DIR_MASK;
+
     int attempts = USB_COMM_ATTEMPTS;
     int errorCode = LIBUSB_ERROR_TIMEOUT;
-    for(int attempt = 0; (attempt < attempts || attempts == -1) && errorCode == LIBUSB_ERROR_TIMEOUT; ++attempt)
-        errorCode = libusb_control_transfer(handle, type, request, value, index, data, length, USB_COMM_TIMEOUT);
+    int attempt = 0;
+    std::chrono::steady_clock::time_point start;
+    for(; (attempt < attempts || attempts == -1) && errorCode == LIBUSB_ERROR_TIMEOUT; ++attempt) {
+        start = std::chrono::steady_clock::now();
+        errorCode = libusb_control_transfer(handle, type, request, value, index, data, length,
+                                            _transferPolicy.timeout(endpoint, length, attempt));
+    }
+    _transferPolicy.record(endpoint, errorCode, attempt - 1, std::chrono::steady_clock::now() - start);
 
     if(errorCode == LIBUSB_ERROR_NO_DEVICE)
         disconnect();
@@ -277,6 +316,98 @@ int USBCommunication::controlRead(unsigned char request, unsigned char *data, un
     return controlTransfer(LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_ENDPOINT_IN, request, data, length, value, index);
 }
 
+/// The state of one asynchronous transfer, passed to the callback by libusb
+struct USBCommunication::AsyncTransfer {
+    USBCommunication* device;
+    TransferCompletion completion;
+    std::chrono::steady_clock::time_point start;
+};
+
+int USBCommunication::submitBulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length,
+                                         TransferCompletion completion, unsigned int timeout) {
+    if(!handle)
+        return LIBUSB_ERROR_NO_DEVICE;
+
+    libusb_transfer* transfer = libusb_alloc_transfer(0);
+    if(!transfer)
+        return LIBUSB_ERROR_NO_MEM;
+    AsyncTransfer* async = new AsyncTransfer{this, std::move(completion), std::chrono::steady_clock::now()};
+    libusb_fill_bulk_transfer(transfer, handle, endpoint, data, length, &USBCommunication::transferCompleted, async,
+                              timeout ? timeout : _transferPolicy.timeout(endpoint, length));
+
+    // The callback waits for the mutex, so it finds the transfer in the list
+    std::lock_guard<std::mutex> lock(_transfersMutex);
+    const int errorCode = libusb_submit_transfer(transfer);
+    if(errorCode != LIBUSB_SUCCESS) {
+        delete async;
+        libusb_free_transfer(transfer);
+        return errorCode;
+    }
+    _transfers.push_back(transfer);
+    return LIBUSB_SUCCESS;
+}
+
+void USBCommunication::transferCompleted(libusb_transfer* transfer) {
+    AsyncTransfer* async = (AsyncTransfer*) transfer->user_data;
+    USBCommunication* device = async->device;
+    const auto elapsed = std::chrono::steady_clock::now() - async->start;
+
+    int result;
+    switch(transfer->status) {
+        case LIBUSB_TRANSFER_COMPLETED:
+            result = transfer->actual_length;
+            break;
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            result = LIBUSB_ERROR_TIMEOUT;
+            break;
+        case LIBUSB_TRANSFER_CANCELLED:
+            result = LIBUSB_ERROR_INTERRUPTED;
+            break;
+        case LIBUSB_TRANSFER_STALL:
+            result = LIBUSB_ERROR_PIPE;
+            break;
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            result = LIBUSB_ERROR_NO_DEVICE;
+            break;
+        case LIBUSB_TRANSFER_OVERFLOW:
+            result = LIBUSB_ERROR_OVERFLOW;
+            break;
+        default:
+            result = LIBUSB_ERROR_IO;
+            break;
+    }
+
+    // Cancelled transfers are no transfer problems
+    if(result != LIBUSB_ERROR_INTERRUPTED)
+        device->_transferPolicy.record(transfer->endpoint, result, 0, elapsed);
+    if(result > ((transfer->endpoint & LIBUSB_ENDPOINT_IN) ? device->inPacketLength : device->outPacketLength))
+        device->_transferPolicy.recordThroughput(transfer->endpoint, result, elapsed);
+
+    async->completion(result);
+    delete async;
+
+    // The device may be destroyed as soon as the list is empty and the mutex is released
+    std::lock_guard<std::mutex> lock(device->_transfersMutex);
+    device->_transfers.erase(std::find(device->_transfers.begin(), device->_transfers.end(), transfer));
+    libusb_free_transfer(transfer);
+    device->_transfersDone.notify_all();
+}
+
+void USBCommunication::cancelTransfers(bool wait) {
+    std::unique_lock<std::mutex> lock(_transfersMutex);
+    for(libusb_transfer* transfer: _transfers)
+        libusb_cancel_transfer(transfer);
+    if(!wait)
+        return;
+
+    // The completions use this object and the buffers of the caller, so there is no timeout.
+    // The event thread of the DeviceList runs until all devices have been destroyed.
+    while(!_transfersDone.wait_for(lock, std::chrono::milliseconds(USB_COMM_CANCEL_TIMEOUT),
+                                   [this]() { return _transfers.empty(); }))
+        std::cerr << _model.modelName << ": " << _transfers.size()
+                  << " cancelled transfers did not complete yet, is the libusb event thread running?" << std::endl;
+}
+
 /// \brief Gets the maximum size of one packet transmitted via bulk transfer.
 /// \return The maximum packet size in bytes, -1 on error.
 int USBCommunication::getPacketSize() const {
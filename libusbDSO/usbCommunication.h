@@ -23,23 +23,40 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 #include "deviceDescriptionEntry.h"
 #include "utils/transferBuffer.h"
+#include "usbTransferPolicy.h"
 
 class libusb_context;
 class libusb_device_handle;
 class libusb_device;
+struct libusb_transfer;
 
 namespace DSO {
 
 //////////////////////////////////////////////////////////////////////////////
 ///
 /// \brief This class handles the USB communication with the oscilloscope.
+/// The connection and transfer methods are virtual, so that a device can be
+/// emulated in software.
+///
+/// Transfers use the adaptive timeouts of the transfer policy, which also keeps
+/// the statistics of every endpoint. Control transfers are accounted as endpoint
+/// 0x00 (out) and 0x80 (in).
+///
+/// The synchronous transfers block the calling thread until they are done. They
+/// suit command/response protocols, where every command waits for a short answer.
+/// Streams submit asynchronous bulk transfers instead, so that several transfers
+/// are queued in the host controller. Their completions are called by the libusb
+/// event thread of the DeviceList.
 class USBCommunication {
-    #define USB_COMM_TIMEOUT              500 ///< Timeout for USB transfers in ms
-    #define USB_COMM_TIMEOUT_MULTI         10 ///< Timeout for multi packet USB transfers in ms
+    #define USB_COMM_TIMEOUT              500 ///< Timeout for unmeasured USB transfers in ms
     #define USB_COMM_ATTEMPTS               3 ///< The number of transfer attempts
-    #define USB_COMM_ATTEMPTS_MULTI         1 ///< The number of multi packet transfer attempts
+    #define USB_COMM_ATTEMPTS_MULTI         2 ///< The number of attempts per packet of multi packet transfers
+    #define USB_COMM_CANCEL_TIMEOUT      1000 ///< Cancelled transfers that take longer to complete are reported, in ms
 
     public:
         /**
@@ -47,28 +64,49 @@ class USBCommunication {
          */
         USBCommunication(libusb_device *device,
                          const DSODeviceDescription& model);
-        ~USBCommunication();
+        virtual ~USBCommunication();
 
-        int connect();
-        void disconnect();
-        bool isConnected() const;
+        virtual int connect();
+        virtual void disconnect();
+        virtual bool isConnected() const;
 
         // Various methods to handle USB transfers
-        int bulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length, int attempts = USB_COMM_ATTEMPTS, unsigned int timeout = USB_COMM_TIMEOUT);
+        virtual int bulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length, int attempts = USB_COMM_ATTEMPTS, unsigned int timeout = 0);
         int bulkWrite(const unsigned char *data, unsigned int length);
         int bulkRead(unsigned char *data, unsigned int length);
         int bulkReadMulti(unsigned char *data, unsigned int length);
 
-        int controlTransfer(unsigned char type, unsigned char request, unsigned char *data, unsigned int length, int value, int index);
+        virtual int controlTransfer(unsigned char type, unsigned char request, unsigned char *data, unsigned int length, int value, int index);
         int controlWrite(unsigned char request, const unsigned char *data, unsigned int length, int value = 0, int index = 0);
         int controlRead(unsigned char request, unsigned char *data, unsigned int length, int value = 0, int index = 0);
 
+        /// Called by the libusb event thread when an asynchronous transfer has finished.
+        /// \param result The number of transferred bytes or a libusb error code,
+        ///        LIBUSB_ERROR_INTERRUPTED if the transfer was cancelled.
+        typedef std::function<void(int result)> TransferCompletion;
+
+        /// \brief Submit a bulk transfer that runs in the background. The data buffer
+        /// has to stay valid until the completion was called.
+        /// \param timeout The timeout in ms, 0 for the adaptive timeout of the endpoint.
+        /// \return LIBUSB_SUCCESS or a libusb error code, then the completion is not called.
+        virtual int submitBulkTransfer(unsigned char endpoint, unsigned char *data, unsigned int length,
+                                       TransferCompletion completion, unsigned int timeout = 0);
+
+        /// \brief Cancel all submitted transfers, their completions get LIBUSB_ERROR_INTERRUPTED.
+        /// \param wait Wait until the completions returned, before the buffers may be freed.
+        ///        There is no timeout, the libusb event thread has to run.
+        ///        Must be false if it is called by a completion, the event thread calls them.
+        virtual void cancelTransfers(bool wait = true);
+
         int getPacketSize() const;
         const DSODeviceDescription& model() const;
 
-        uint8_t getUniqueID();
+        virtual uint8_t getUniqueID();
         void setDisconnected_signal(const std::function<void ()>& disconnected_signal);
 
+        /// \return The timeouts and statistics of the endpoints.
+        USBTransferPolicy& transferPolicy();
+
 protected:
 
         /// The usb context used for this device
@@ -92,6 +130,18 @@ protected:
         const DSODeviceDescription _model;
 
         std::function<void(void)> _disconnected_signal;
+
+        USBTransferPolicy _transferPolicy {USB_COMM_TIMEOUT};
+
+private:
+        struct AsyncTransfer;
+
+        /// \brief The libusb callback of all asynchronous transfers.
+        static void transferCompleted(libusb_transfer* transfer);
+
+        std::vector<libusb_transfer*> _transfers; ///< The submitted transfers, protected by _transfersMutex
+        std::mutex _transfersMutex;
+        std::condition_variable _transfersDone;   ///< Notified when a transfer was removed from _transfers
 };
 
 }
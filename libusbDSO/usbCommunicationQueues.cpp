@@ -89,15 +89,23 @@ namespace DSO {
         return ErrorCode::ERROR_UNSUPPORTED;
     }
 
+    int CommunicationThreadQueues::sendBulkCommand(USBCommunication* device, const USBTransferBuffer* cmd) {
+        return device->bulkWrite(cmd->data(), cmd->size());
+    }
+
     bool CommunicationThreadQueues::sendPendingCommands(USBCommunication* device) {
         int errorCode = 0;
 
-        while(_pendingBulkCommands.size()) {
-            const USBTransferBuffer* cmd = _pendingBulkCommands.front();
-            _pendingBulkCommands.pop();
+        // Take the current batch, commands added while sending go into the next one
+        _batchBulkCommands.swap(_pendingBulkCommands);
+        _batchControlCommands.swap(_pendingControlCommands);
+        _pendingBulkCommands.clear();
+        _pendingControlCommands.clear();
+
+        for(const USBTransferBuffer* cmd: _batchBulkCommands) {
             timestampDebug("Sending bulk command: " << hexDump(cmd->data(), cmd->size()));
 
-            errorCode = device->bulkWrite(cmd->data(), cmd->size());
+            errorCode = sendBulkCommand(device, cmd);
             if(errorCode < 0) {
                 std::cerr << "Sending bulk command %02x failed: " << " " <<
                 libusb_error_name((libusb_error)errorCode) << " " <<
@@ -110,10 +118,7 @@ namespace DSO {
 
         errorCode = 0;
 
-        while(_pendingControlCommands.size()) {
-            const USBTransferBuffer* cmd = _pendingControlCommands.front();
-            _pendingControlCommands.pop();
-
+        for(const USBTransferBuffer* cmd: _batchControlCommands) {
             timestampDebug("Sending control command " << cmd->extra << " " << hexDump(cmd->data(), cmd->size()));
 
             errorCode = device->controlWrite(cmd->extra, cmd->data(), cmd->size());
@@ -126,6 +131,9 @@ namespace DSO {
                     return false;
             }
         }
+
+        _batchBulkCommands.clear();
+        _batchControlCommands.clear();
         return true;
     }
 
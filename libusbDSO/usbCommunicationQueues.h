@@ -23,8 +23,10 @@
 #pragma once
 
 #include <vector>
-#include <queue>
 #include <memory>
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
 
 #include "utils/transferBuffer.h"
 #include "errorcodes.h"
@@ -45,32 +47,19 @@ class USBCommunication;
 /// As soon as you use addPending(..) the TransferBuffer
 /// will be added to the queue and the queue is processed in sendPendingCommands(...).
 ///
-/// Implementation details:
-/// The compiler ensures that every struct given as template argument
-/// to get<T>() will get its own memory, so there is no need to "register" or
-/// reserve memory for all used structs.
-/// The template specialised get() method will reserve memory for the structure
-/// while in compile time.
+/// Commands are coalesced: Every buffer type is queued at most once. Because the
+/// queue only refers to the buffer returned by get<T>(), adding it again while it
+/// is still pending only updates its content (last writer wins) and keeps its
+/// position. sendPendingCommands(...) flushes everything that is pending at that
+/// moment as one batch: all bulk commands first, then all control commands,
+/// each in the order they were first added. Control commands like relays and
+/// offsets depend on the gain and channel settings sent via bulk commands.
+///
+/// Every device instance owns its transfer buffers, see CommunicationThreadBuffers.
+/// Several devices of the same driver can therefore be driven at the same time.
 class CommunicationThreadQueues {
 public:
-    /// Return an object of the struct of the given type. The state of the object
-    /// is kept through the entire lifetime of CommunicationThreadQueues. If you
-    /// use an object from get and want it to be reseted to the state after construction,
-    /// (e.g. after connect()/disconnect() from a usb device)
-    /// you may for example use std::swap in <algorithm>. Example workflow:
-    ///
-    /// {connect to device}
-    /// CoolObject& o = get<CoolObject>();
-    /// o.alterState();
-    /// addPending(o);
-    /// {disconnect from device}
-    /// std::swap(o, CoolObject());
-    /// {repeat}
-    template<class BufferType>
-    BufferType& get() {
-        static BufferType b;
-        return b;
-    }
+    virtual ~CommunicationThreadQueues() {}
 
     /// Add pending USBTransferBuffer objects.
     /// \param cmd An object of the type USBTransferBuffer, that also inherits either
@@ -83,9 +72,13 @@ public:
 
     /// Clear all queues
     void resetPending() {
-        std::queue<const USBTransferBuffer*> a;
-        _pendingControlCommands.swap(a);
-        _pendingBulkCommands.swap(a);
+        _pendingControlCommands.clear();
+        _pendingBulkCommands.clear();
+    }
+
+    /// \return True if there are commands waiting to be sent
+    bool hasPendingCommands() const {
+        return !_pendingControlCommands.empty() || !_pendingBulkCommands.empty();
     }
 
     /// \brief Sends bulk/control commands directly.
@@ -102,29 +95,74 @@ public:
     /// \return See ::ErrorCode::ErrorCode.
     ErrorCode stringCommand(const std::string& command);
 
-    /// Send all pending bulk/control commands
+    /// Send all pending bulk/control commands as one batch
+    /// \return False if the device is not available anymore.
     bool sendPendingCommands(DSO::USBCommunication* device);
 protected:
-    /// The queue for the usb control commands
-    std::queue<const USBTransferBuffer*> _pendingControlCommands;
-    /// The queue for the usb bulk commands
-    std::queue<const USBTransferBuffer*> _pendingBulkCommands;
+    /// Send one bulk command of a batch. Devices that need a preparing control
+    /// command before every bulk transfer should override this.
+    /// \return The libusb error code
+    virtual int sendBulkCommand(DSO::USBCommunication* device, const USBTransferBuffer* cmd);
+
+    /// The queue for the usb control commands, every buffer at most once
+    std::vector<const USBTransferBuffer*> _pendingControlCommands;
+    /// The queue for the usb bulk commands, every buffer at most once
+    std::vector<const USBTransferBuffer*> _pendingBulkCommands;
+    /// The commands of the batch that is currently sent. Kept as members to reuse their memory.
+    std::vector<const USBTransferBuffer*> _batchControlCommands, _batchBulkCommands;
 
     /// A helper struct to differentiate between the tweo addPending overloads.
     template<bool...> struct tag_type {};
     typedef tag_type<true, false> useControlQueue;
     typedef tag_type<false, true> useBulkQueue;
 
+    /// Queue a command if it is not already pending
+    static inline void coalesce(std::vector<const USBTransferBuffer*>& queue, const USBTransferBuffer* cmd) {
+        if(std::find(queue.begin(), queue.end(), cmd) == queue.end())
+            queue.push_back(cmd);
+    }
+
     template <typename T>
     inline void addPending(const T& cmd, useControlQueue) {
-        _pendingControlCommands.push(&cmd);
+        coalesce(_pendingControlCommands, &cmd);
     }
 
     template <typename T>
     inline void addPending(const T& cmd, useBulkQueue) {
-        _pendingBulkCommands.push(&cmd);
+        coalesce(_pendingBulkCommands, &cmd);
+    }
+
+};
+
+/// A helper struct to find the position of a type in a type list at compile time.
+/// Using a type that is not in the list is a compile error.
+template<class T, class... Types> struct TypeIndex;
+template<class T, class... Rest>
+struct TypeIndex<T, T, Rest...> : std::integral_constant<std::size_t, 0> {};
+template<class T, class U, class... Rest>
+struct TypeIndex<T, U, Rest...> : std::integral_constant<std::size_t, 1 + TypeIndex<T, Rest...>::value> {};
+
+//////////////////////////////////////////////////////////////////////////////
+/// \brief CommunicationThreadQueues with the storage for all transfer buffers of a driver.
+/// The buffers are members of the device object, one instance of every
+/// type in Buffers. They are constructed with the device, get<T>() is resolved at
+/// compile time and does not allocate.
+///
+/// A driver lists every protocol buffer it uses:
+/// class HantekDevice : public DeviceBase,
+///                      public CommunicationThreadBuffers<ControlSetOffset, BulkSetGain> {...};
+template<class... Buffers>
+class CommunicationThreadBuffers : public CommunicationThreadQueues {
+public:
+    /// Return the transfer buffer of the given type of this device. The state of
+    /// the object is kept through the entire lifetime of the device.
+    template<class BufferType>
+    BufferType& get() {
+        return std::get<TypeIndex<BufferType, Buffers...>::value>(_buffers);
     }
 
+private:
+    std::tuple<Buffers...> _buffers;
 };
 
 }
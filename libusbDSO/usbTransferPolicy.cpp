@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  usbTransferPolicy.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include <libusb-1.0/libusb.h>
+
+#include "usbTransferPolicy.h"
+
+namespace DSO {
+
+USBTransferPolicy::USBTransferPolicy(unsigned defaultTimeout)
+    : _defaultTimeout(defaultTimeout) {
+}
+
+unsigned USBTransferPolicy::timeout(unsigned char endpoint, unsigned length, int attempt) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto found = _endpoints.find(endpoint);
+    const Endpoint* state = found == _endpoints.end() ? nullptr : &found->second;
+    const double dataRate = state ? state->statistics.dataRate : 0;
+
+    double base;
+    if(!state || !state->measured) {
+        // Nothing learned yet, only the data rate is known
+        base = _defaultTimeout;
+        if(dataRate > 0)
+            base += 2000.0 * length / dataRate;
+    } else {
+        // The transfer can't be faster than the usb connection or the device
+        double rate = state->statistics.throughput;
+        if(dataRate > 0 && (rate <= 0 || dataRate < rate))
+            rate = dataRate;
+
+        double seconds = state->statistics.latency_in_s + 4 * state->latencyVariation;
+        if(rate > 0)
+            seconds += 2.0 * length / rate;
+        base = std::max(std::ceil(seconds * 1000), (double) USB_COMM_TIMEOUT_MIN);
+        if(dataRate <= 0)
+            base = std::min(base, (double) _defaultTimeout);
+    }
+
+    // Retries back off, but don't wait longer than the default timeout unless the data needs it
+    const double backoff = base * (1u << std::min(std::max(attempt, 0), 16));
+    return (unsigned) std::min(backoff, std::max(base, (double) _defaultTimeout));
+}
+
+void USBTransferPolicy::record(unsigned char endpoint, int result, int retries, duration elapsed) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Endpoint& state = _endpoints[endpoint];
+    TransferStatistics& statistics = state.statistics;
+
+    ++statistics.transfers;
+    statistics.retries += retries;
+
+    if(result == LIBUSB_ERROR_TIMEOUT) {
+        ++statistics.timeouts;
+        // Like TCP: Be more patient after a timeout, until transfers are measured again
+        if(state.measured)
+            state.latencyVariation = std::min(std::max(2 * state.latencyVariation, USB_COMM_TIMEOUT_MIN / 1000.0),
+                                              _defaultTimeout / 1000.0);
+        return;
+    }
+    if(result < 0) {
+        ++statistics.errors;
+        return;
+    }
+
+    statistics.bytes += result;
+
+    const long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    unsigned bucket = 0;
+    while(bucket + 1 < USB_COMM_LATENCY_BUCKETS && (microseconds >> (bucket + 1)) > 0)
+        ++bucket;
+    ++statistics.latency[bucket];
+
+    // The latency is what remains without the time of the data
+    double rate = statistics.throughput;
+    if(statistics.dataRate > 0 && (rate <= 0 || statistics.dataRate < rate))
+        rate = statistics.dataRate;
+    double sample = std::chrono::duration<double>(elapsed).count();
+    if(rate > 0)
+        sample = std::max(sample - result / rate, 0.0);
+
+    if(!state.measured) {
+        statistics.latency_in_s = sample;
+        state.latencyVariation = sample / 2;
+        state.measured = true;
+    } else {
+        state.latencyVariation = 0.75 * state.latencyVariation + 0.25 * std::fabs(statistics.latency_in_s - sample);
+        statistics.latency_in_s = 0.875 * statistics.latency_in_s + 0.125 * sample;
+    }
+}
+
+void USBTransferPolicy::recordThroughput(unsigned char endpoint, unsigned bytes, duration elapsed) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    if(seconds <= 0 || !bytes)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    TransferStatistics& statistics = _endpoints[endpoint].statistics;
+    const double sample = bytes / seconds;
+    if(statistics.throughput <= 0)
+        statistics.throughput = sample;
+    else
+        statistics.throughput = 0.875 * statistics.throughput + 0.125 * sample;
+}
+
+void USBTransferPolicy::setDataRate(unsigned char endpoint, double bytesPerSecond) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _endpoints[endpoint].statistics.dataRate = std::max(bytesPerSecond, 0.0);
+}
+
+std::map<unsigned char, TransferStatistics> USBTransferPolicy::getStatistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::map<unsigned char, TransferStatistics> result;
+    for(const auto& endpoint: _endpoints)
+        result[endpoint.first] = endpoint.second.statistics;
+    return result;
+}
+
+void USBTransferPolicy::resetStatistics() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto& endpoint: _endpoints) {
+        TransferStatistics& statistics = endpoint.second.statistics;
+        statistics.bytes = statistics.transfers = statistics.retries = 0;
+        statistics.timeouts = statistics.errors = 0;
+        statistics.latency.fill(0);
+    }
+}
+
+}
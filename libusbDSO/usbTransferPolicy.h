@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  usbTransferPolicy.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace DSO {
+
+#define USB_COMM_LATENCY_BUCKETS 24 ///< Latency histogram buckets, bucket i counts transfers of 2^i..2^(i+1) µs
+#define USB_COMM_TIMEOUT_MIN     10 ///< Lower limit of adaptive timeouts in ms
+
+//////////////////////////////////////////////////////////////////////////////
+/// \struct TransferStatistics
+/// \brief Counters and estimates of the transfers of one usb endpoint.
+struct TransferStatistics {
+    unsigned long long bytes = 0;     ///< Transferred bytes
+    unsigned long long transfers = 0; ///< Completed transfers, including failed ones
+    unsigned long long retries = 0;   ///< Attempts that were repeated after a timeout
+    unsigned long long timeouts = 0;  ///< Transfers that timed out in every attempt
+    unsigned long long errors = 0;    ///< Transfers that failed for other reasons
+    std::array<unsigned long long, USB_COMM_LATENCY_BUCKETS> latency {}; ///< Histogram of successful transfers
+
+    double latency_in_s = 0;          ///< The estimated time a transfer takes without its data
+    double throughput = 0;            ///< The measured throughput in B/s, 0 if unknown
+    double dataRate = 0;              ///< The rate the device produces data in B/s, 0 if unknown
+};
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief Learns how long the transfers of each endpoint take and derives the
+/// timeouts from it.
+///
+/// A transfer is modelled as a fixed latency plus its length divided by the
+/// throughput. Latency and its variation are smoothed like the round trip time
+/// of TCP, the timeout allows for four times the variation. If the device produces
+/// the data at a known rate (like a streaming oscilloscope), a transfer can't
+/// complete faster than that rate. Until an endpoint has completed a transfer the
+/// default timeout is used. All methods can be called by any thread.
+class USBTransferPolicy {
+public:
+    typedef std::chrono::steady_clock::duration duration;
+
+    /// \param defaultTimeout The timeout in ms of unmeasured endpoints, also the upper limit
+    ///        of endpoints without a data rate.
+    explicit USBTransferPolicy(unsigned defaultTimeout);
+
+    /// \return The timeout in ms for an attempt to transfer length bytes. Every retry
+    ///         doubles the timeout of the previous attempt.
+    unsigned timeout(unsigned char endpoint, unsigned length, int attempt = 0) const;
+
+    /// \brief Account a finished transfer.
+    /// \param result The transferred bytes or a libusb error code.
+    /// \param retries The attempts that timed out before the last one.
+    /// \param elapsed The time of the last attempt.
+    void record(unsigned char endpoint, int result, int retries, duration elapsed);
+
+    /// \brief Measure the throughput of a transfer of several packets.
+    void recordThroughput(unsigned char endpoint, unsigned bytes, duration elapsed);
+
+    /// \brief Set the rate the device produces data for an endpoint, 0 if it is ready in advance.
+    void setDataRate(unsigned char endpoint, double bytesPerSecond);
+
+    /// \return The statistics of all endpoints that were used.
+    std::map<unsigned char, TransferStatistics> getStatistics() const;
+
+    /// \brief Forget the counters, the estimates are kept.
+    void resetStatistics();
+
+private:
+    struct Endpoint {
+        TransferStatistics statistics;
+        double latencyVariation = 0;
+        bool measured = false;
+    };
+
+    mutable std::mutex _mutex;
+    std::map<unsigned char, Endpoint> _endpoints;
+    const unsigned _defaultTimeout;
+};
+
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  decimator.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "decimator.h"
+
+namespace DSO {
+
+/// The number of frequencies the FIR filter is designed with
+#define DECIMATOR_DESIGN_POINTS 512
+
+/// \return The gain of the CIC filter at a frequency relative to its output samplerate.
+static double cicResponse(double frequency, unsigned factor) {
+    if(frequency <= 0.0 || factor <= 1)
+        return 1.0;
+    const double response = std::sin(M_PI * frequency) / (factor * std::sin(M_PI * frequency / factor));
+    return std::pow(std::fabs(response), DECIMATOR_CIC_ORDER);
+}
+
+void Decimator::configure(unsigned channels, unsigned factor) {
+    _channels = channels;
+    _factor = factor < 2 ? 1 : factor & ~1u;
+    _cicFactor = _factor / 2;
+    _cicScale = 1.0 / std::pow((double) _cicFactor, DECIMATOR_CIC_ORDER);
+
+    // Lowpass at the Nyquist frequency of the output, relative to the CIC output. The passband
+    // is the inverse of the CIC droop, the coefficients are windowed with a Blackman window.
+    const double cutoff = 0.25;
+    const int center = DECIMATOR_FIR_TAPS / 2;
+    _taps.assign(DECIMATOR_FIR_TAPS, 0.0);
+    double sum = 0.0;
+    for(int tap = 0; tap < DECIMATOR_FIR_TAPS; ++tap) {
+        double value = 0.0;
+        for(unsigned point = 0; point < DECIMATOR_DESIGN_POINTS; ++point) {
+            const double frequency = (point + 0.5) * cutoff / DECIMATOR_DESIGN_POINTS;
+            value += std::cos(2 * M_PI * frequency * (tap - center)) / cicResponse(frequency, _cicFactor);
+        }
+        const double window = 0.42 - 0.5 * std::cos(2 * M_PI * tap / (DECIMATOR_FIR_TAPS - 1))
+                                   + 0.08 * std::cos(4 * M_PI * tap / (DECIMATOR_FIR_TAPS - 1));
+        _taps[tap] = value * window;
+        sum += _taps[tap];
+    }
+    for(double& tap: _taps)
+        tap /= sum;
+
+    reset();
+}
+
+void Decimator::reset() {
+    Channel channel;
+    channel.integrators.fill(0);
+    channel.combs.fill(0);
+    channel.history.fill(0.0);
+    _state.assign(_channels, channel);
+
+    _cicPhase = 0;
+    _firPosition = 0;
+    _firPhase = false;
+    _settling = DECIMATOR_CIC_ORDER + DECIMATOR_FIR_TAPS;
+}
+
+void Decimator::process(const unsigned char* input, unsigned samples, std::vector<float>& output) {
+    if(_factor == 1) {
+        output.insert(output.end(), input, input + samples * _channels);
+        return;
+    }
+
+    for(unsigned sample = 0; sample < samples; ++sample, input += _channels) {
+        for(unsigned channel = 0; channel < _channels; ++channel) {
+            std::array<uint64_t, DECIMATOR_CIC_ORDER>& integrators = _state[channel].integrators;
+            uint64_t value = input[channel];
+            for(uint64_t& integrator: integrators)
+                value = integrator += value;
+        }
+        if(++_cicPhase < _cicFactor)
+            continue;
+        _cicPhase = 0;
+
+        for(Channel& state: _state) {
+            uint64_t value = state.integrators[DECIMATOR_CIC_ORDER - 1];
+            for(uint64_t& comb: state.combs) {
+                const uint64_t difference = value - comb;
+                comb = value;
+                value = difference;
+            }
+            const double decimated = (double) (int64_t) value * _cicScale;
+            state.history[_firPosition] = state.history[_firPosition + DECIMATOR_FIR_TAPS] = decimated;
+        }
+        _firPosition = (_firPosition + 1) % DECIMATOR_FIR_TAPS;
+
+        if(_settling)
+            --_settling;
+        _firPhase = !_firPhase;
+        if(_firPhase || _settling)
+            continue;
+
+        // The window starts with the oldest CIC output, the taps are symmetric
+        const unsigned center = DECIMATOR_FIR_TAPS / 2;
+        for(const Channel& state: _state) {
+            const double* window = state.history.data() + _firPosition;
+            double value = _taps[center] * window[center];
+            for(unsigned tap = 0; tap < center; ++tap)
+                value += _taps[tap] * (window[tap] + window[DECIMATOR_FIR_TAPS - 1 - tap]);
+            output.push_back((float) value);
+        }
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  decimator.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+namespace DSO {
+
+#define DECIMATOR_CIC_ORDER 4   ///< Integrator and comb stages of the CIC filter
+#define DECIMATOR_FIR_TAPS  63  ///< Taps of the compensating FIR filter, odd for a symmetric filter
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief Reduces the samplerate of a stream of interleaved 8 bit samples without
+/// aliasing.
+///
+/// A CIC filter decimates by factor/2 with integer arithmetic, a FIR filter
+/// compensates its droop and decimates by the remaining 2 with a cutoff at half the
+/// output samplerate. The output are ADC codes with fractional bits, averaging gives
+/// them more resolution than the input. The filter state persists between calls to
+/// process(), so a stream can be decimated packet by packet.
+class Decimator {
+public:
+    /// \brief Set up the filters for a new stream, the state is reset.
+    /// \param channels The number of interleaved channels.
+    /// \param factor The decimation factor, 1 or even.
+    void configure(unsigned channels, unsigned factor);
+
+    /// \return The decimation factor, 1 if the samples are passed through.
+    unsigned factor() const { return _factor; }
+
+    /// \brief Start a new stream with the same configuration.
+    void reset();
+
+    /// \brief Decimate interleaved samples. After a reset the first outputs are
+    /// dropped until the filters have settled.
+    /// \param input Interleaved samples of all channels.
+    /// \param samples The number of samples per channel.
+    /// \param output The decimated interleaved samples are appended.
+    void process(const unsigned char* input, unsigned samples, std::vector<float>& output);
+
+private:
+    /// The filter state of one channel
+    struct Channel {
+        std::array<uint64_t, DECIMATOR_CIC_ORDER> integrators; ///< Wrap around, only differences matter
+        std::array<uint64_t, DECIMATOR_CIC_ORDER> combs;       ///< The previous input of each comb
+        std::array<double, 2 * DECIMATOR_FIR_TAPS> history;    ///< CIC outputs, stored twice for a contiguous window
+    };
+
+    unsigned _channels = 0;
+    unsigned _factor = 1;
+    unsigned _cicFactor = 1;
+    double _cicScale = 1.0;    ///< Inverse of the CIC gain
+    std::vector<double> _taps;
+    std::vector<Channel> _state;
+
+    unsigned _cicPhase = 0;    ///< Input samples since the last CIC output
+    unsigned _firPosition = 0; ///< The history index of the next CIC output
+    bool _firPhase = false;    ///< Every second CIC output gives an output
+    unsigned _settling = 0;    ///< CIC outputs until the output is valid
+};
+
+}
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  executor.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <iostream>
+
+#include "utils/executor.h"
+
+namespace DSO {
+
+const Executor::time_point Executor::idle = Executor::time_point::max();
+const Executor::time_point Executor::finished = Executor::time_point::min();
+
+class Executor::Task {
+public:
+    explicit Task(Step step) : step(std::move(step)) {}
+    Step step;
+    time_point deadline = time_point();  ///< The time of the next step, protected by _mutex
+    bool running = false;                ///< A worker runs the step right now
+    bool woken = false;                  ///< Woken up while the step was running
+    bool active = true;                  ///< Neither finished nor cancelled
+    std::thread::id runner;              ///< The worker running the step
+};
+
+Executor::Executor(unsigned workers, ThreadRole role) : _role(role) {
+    for(unsigned index = 0; index < workers; ++index)
+        _workers.push_back(std::thread(&Executor::worker, this));
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for(std::thread& thread: _workers)
+        if(thread.joinable()) thread.join();
+}
+
+std::shared_ptr<Executor> Executor::shared(ThreadRole role) {
+    static std::mutex mutex;
+    static std::array<std::shared_ptr<Executor>, THREAD_ROLES> executors;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Executor>& executor = executors[(unsigned) role];
+    if(!executor) {
+        // Device steps are short, they don't need a worker per core
+        unsigned workers = std::thread::hardware_concurrency();
+        if(role == ThreadRole::DEVICE)
+            workers /= 2;
+        executor.reset(new Executor(std::max(2u, workers), role));
+    }
+    return executor;
+}
+
+Executor::TaskHandle Executor::schedule(Step step) {
+    TaskHandle task(new Task(std::move(step)));
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(task);
+    }
+    _condition.notify_all();
+    return task;
+}
+
+void Executor::wake(const TaskHandle& task) {
+    if(!task)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!task->active)
+            return;
+        if(task->running)
+            task->woken = true;
+        else
+            task->deadline = time_point();
+    }
+    _condition.notify_all();
+}
+
+void Executor::cancel(const TaskHandle& task) {
+    if(!task)
+        return;
+    std::unique_lock<std::mutex> lock(_mutex);
+    task->active = false;
+    _tasks.erase(std::remove(_tasks.begin(), _tasks.end(), task), _tasks.end());
+    if(task->runner != std::this_thread::get_id())
+        _condition.wait(lock, [&task]() { return !task->running; });
+}
+
+bool Executor::isActive(const TaskHandle& task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return task && task->active;
+}
+
+void Executor::worker() {
+    ThreadPolicies& policies = ThreadPolicies::instance();
+    unsigned policyGeneration = 0;
+    policies.applyIfChanged(_role, policyGeneration);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(!_stop) {
+        // The task that is due first
+        TaskHandle next;
+        for(const TaskHandle& task: _tasks)
+            if(!task->running && (!next || task->deadline < next->deadline))
+                next = task;
+
+        const time_point now = std::chrono::steady_clock::now();
+        if(!next || next->deadline == idle) {
+            _condition.wait(lock);
+            continue;
+        }
+        if(next->deadline > now) {
+            _condition.wait_until(lock, next->deadline);
+            continue;
+        }
+
+        next->running = true;
+        next->woken = false;
+        next->runner = std::this_thread::get_id();
+        lock.unlock();
+
+        policies.applyIfChanged(_role, policyGeneration);
+
+        // An exception must not terminate the worker and every other task with it
+        time_point deadline;
+        try {
+            deadline = next->step();
+        } catch(const std::exception& e) {
+            std::cerr << "Executor: task failed: " << e.what() << std::endl;
+            deadline = finished;
+        } catch(...) {
+            std::cerr << "Executor: task failed with an unknown exception" << std::endl;
+            deadline = finished;
+        }
+
+        lock.lock();
+        next->running = false;
+        next->runner = std::thread::id();
+        if(deadline == finished) {
+            next->active = false;
+            _tasks.erase(std::remove(_tasks.begin(), _tasks.end(), next), _tasks.end());
+        } else
+            next->deadline = next->woken ? time_point() : deadline;
+
+        // Cancel() may wait for this step, other workers may wait for this task
+        _condition.notify_all();
+    }
+}
+
+}
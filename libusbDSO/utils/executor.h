@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  executor.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include "utils/threadPolicy.h"
+
+namespace DSO {
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief A pool of worker threads that runs the state machines of all devices
+/// and analysers. A task is a step function that does the work that is due and
+/// returns when it wants to run next. Steps of one task never run concurrently,
+/// but consecutive steps may run on different workers.
+///
+/// There is an executor per ThreadRole, so that the workers of device tasks can get
+/// a realtime policy without giving it to the analysers. The workers apply the
+/// policy of their role before a step if it changed.
+///
+/// A step must not block for long. Waiting for a deadline or an event is done by
+/// returning the deadline, wake() runs the task again before the deadline.
+/// A step that throws an exception finishes its task, the error is printed.
+class Executor {
+public:
+    typedef std::chrono::steady_clock::time_point time_point;
+    /// A step of a task. Returns the time of the next step, idle or finished.
+    typedef std::function<time_point(void)> Step;
+
+    /// Returned by a step: Run again only if the task is woken up
+    static const time_point idle;
+    /// Returned by a step: The task is done and removed
+    static const time_point finished;
+
+    class Task;
+    typedef std::shared_ptr<Task> TaskHandle;
+
+    /// \param workers The number of worker threads.
+    /// \param role The thread policy of the workers.
+    Executor(unsigned workers, ThreadRole role);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /// \return The executor shared by all tasks of a role. Analysers get one worker per cpu
+    /// core, devices one per two cores, at least two.
+    static std::shared_ptr<Executor> shared(ThreadRole role);
+
+    /// \brief Add a task. Its first step runs as soon as a worker is free.
+    TaskHandle schedule(Step step);
+
+    /// \brief Run the next step of a task as soon as possible. If the step is running at the
+    /// moment, it is run again after it has finished. Can be called by any thread.
+    void wake(const TaskHandle& task);
+
+    /// \brief Remove a task. Blocks until a running step has finished, unless it is
+    /// called by the step itself. No step is started afterwards.
+    void cancel(const TaskHandle& task);
+
+    /// \return True if the task is neither finished nor cancelled.
+    bool isActive(const TaskHandle& task);
+
+private:
+    void worker();
+
+    std::mutex _mutex;
+    std::condition_variable _condition; ///< Signals new, woken and finished steps
+    std::vector<TaskHandle> _tasks;     ///< All active tasks
+    std::vector<std::thread> _workers;
+    bool _stop = false;
+    const ThreadRole _role;
+};
+
+}
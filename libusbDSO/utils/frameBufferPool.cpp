@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  frameBufferPool.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include "frameBufferPool.h"
+
+namespace DSO {
+
+FrameBufferPool& FrameBufferPool::instance() {
+    // Never destroyed, frames in static objects may be released after main()
+    static FrameBufferPool* pool = new FrameBufferPool();
+    return *pool;
+}
+
+std::size_t FrameBufferPool::roundSize(std::size_t bytes) {
+    const std::size_t granularity = bytes >= FRAME_BUFFER_HUGEPAGE ? FRAME_BUFFER_HUGEPAGE : FRAME_BUFFER_ALIGNMENT;
+    return (bytes + granularity - 1) / granularity * granularity;
+}
+
+void* FrameBufferPool::acquire(std::size_t bytes) {
+    const std::size_t size = roundSize(bytes ? bytes : 1);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto entry = _free.find(size);
+        if(entry != _free.end() && !entry->second.empty()) {
+            void* buffer = entry->second.back();
+            entry->second.pop_back();
+            _cachedBytes -= size;
+            ++_statistics.recycled;
+            return buffer;
+        }
+    }
+    return allocate(size);
+}
+
+void FrameBufferPool::release(void* buffer, std::size_t bytes) {
+    if(!buffer)
+        return;
+    const std::size_t size = roundSize(bytes ? bytes : 1);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<void*>& buffers = _free[size];
+        if(buffers.size() < FRAME_BUFFER_FREE_LIMIT && _cachedBytes + size <= FRAME_BUFFER_CACHE_LIMIT) {
+            // Reserved once per size, so that releasing never allocates
+            if(buffers.capacity() < FRAME_BUFFER_FREE_LIMIT)
+                buffers.reserve(FRAME_BUFFER_FREE_LIMIT);
+            buffers.push_back(buffer);
+            _cachedBytes += size;
+            return;
+        }
+    }
+    deallocate(buffer, size);
+}
+
+void FrameBufferPool::reserve(std::size_t bytes, unsigned count) {
+    const std::size_t size = roundSize(bytes ? bytes : 1);
+    count = std::min(count, (unsigned) FRAME_BUFFER_FREE_LIMIT);
+    for(;;) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(_free[size].size() >= count || _cachedBytes + size > FRAME_BUFFER_CACHE_LIMIT)
+                return;
+        }
+        release(allocate(size), size);
+    }
+}
+
+void FrameBufferPool::setHugePages(bool enabled) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hugePages = enabled;
+}
+
+bool FrameBufferPool::setLocked(bool locked) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_locked == locked)
+        return true;
+    _locked = locked;
+    bool success = true;
+    for(auto& entry: _free)
+        for(void* buffer: entry.second)
+            if(!lockBuffer(buffer, entry.first, locked)) {
+                ++_statistics.lockFailures;
+                success = false;
+            }
+    return success;
+}
+
+bool FrameBufferPool::lockBuffer(void* buffer, std::size_t size, bool locked) {
+#if defined(__linux__)
+    return (locked ? mlock(buffer, size) : munlock(buffer, size)) == 0;
+#else
+    (void) buffer;
+    (void) size;
+    return !locked;
+#endif
+}
+
+FrameBufferPool::Statistics FrameBufferPool::statistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+void* FrameBufferPool::allocate(std::size_t size) {
+    void* buffer = nullptr;
+#if defined(__linux__)
+    if(size >= FRAME_BUFFER_HUGEPAGE) {
+        bool hugePages;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            hugePages = _hugePages;
+        }
+#ifdef MAP_HUGETLB
+        if(hugePages) {
+            buffer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(buffer != MAP_FAILED) {
+                const bool locked = !_locked || lockBuffer(buffer, size, true);
+                std::lock_guard<std::mutex> lock(_mutex);
+                ++_statistics.allocations;
+                ++_statistics.hugePages;
+                if(!locked)
+                    ++_statistics.lockFailures;
+                return buffer;
+            }
+            // No hugepages reserved, don't try again for every buffer
+            std::lock_guard<std::mutex> lock(_mutex);
+            _hugePages = false;
+        }
+#else
+        (void) hugePages;
+#endif
+        buffer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(buffer == MAP_FAILED)
+            throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        madvise(buffer, size, MADV_HUGEPAGE);
+#endif
+    } else if(posix_memalign(&buffer, FRAME_BUFFER_ALIGNMENT, size))
+        buffer = nullptr;
+#elif defined(_WIN32)
+    buffer = _aligned_malloc(size, FRAME_BUFFER_ALIGNMENT);
+#else
+    if(posix_memalign(&buffer, FRAME_BUFFER_ALIGNMENT, size))
+        buffer = nullptr;
+#endif
+    if(!buffer)
+        throw std::bad_alloc();
+
+    const bool locked = !_locked || lockBuffer(buffer, size, true);
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_statistics.allocations;
+    if(!locked)
+        ++_statistics.lockFailures;
+    return buffer;
+}
+
+void FrameBufferPool::deallocate(void* buffer, std::size_t size) {
+    if(_locked)
+        lockBuffer(buffer, size, false);
+#if defined(__linux__)
+    if(size >= FRAME_BUFFER_HUGEPAGE) {
+        munmap(buffer, size);
+        return;
+    }
+    free(buffer);
+#elif defined(_WIN32)
+    (void) size;
+    _aligned_free(buffer);
+#else
+    (void) size;
+    free(buffer);
+#endif
+}
+
+}
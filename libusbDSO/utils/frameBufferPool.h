@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  frameBufferPool.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace DSO {
+
+#define FRAME_BUFFER_ALIGNMENT   64          ///< Alignment of all buffers, a cache line and enough for SIMD
+#define FRAME_BUFFER_HUGEPAGE    (2u << 20)  ///< Buffers of at least this size are mapped and may use hugepages
+#define FRAME_BUFFER_FREE_LIMIT  8           ///< Free buffers kept per size, the rest is returned to the system
+#define FRAME_BUFFER_CACHE_LIMIT (256u << 20) ///< Bytes kept in free buffers of all sizes
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief Recycles the sample buffers of all frames in the pipeline.
+///
+/// Devices, composite devices and the analyser resize their buffers to the same
+/// record length frame after frame. Released buffers are kept per size and handed
+/// out again, so the steady state does not allocate. Buffers of multiple MB are
+/// mapped with MAP_HUGETLB if hugepages are reserved, otherwise transparent
+/// hugepages are requested, which saves TLB misses when a record is walked.
+class FrameBufferPool {
+public:
+    /// \return The pool shared by all frames.
+    static FrameBufferPool& instance();
+
+    /// \brief Get a buffer of at least the given size, aligned to FRAME_BUFFER_ALIGNMENT.
+    /// \throw std::bad_alloc if the memory is exhausted.
+    void* acquire(std::size_t bytes);
+
+    /// \brief Return a buffer obtained by acquire() with the same size.
+    void release(void* buffer, std::size_t bytes);
+
+    /// \brief Allocate buffers in advance, e.g. when the record length changed.
+    /// \param bytes The size of one buffer.
+    /// \param count The number of buffers that should be available.
+    void reserve(std::size_t bytes, unsigned count);
+
+    /// \brief Use MAP_HUGETLB for large buffers. It is tried once and disabled
+    /// automatically if no hugepages are reserved by the system.
+    void setHugePages(bool enabled);
+
+    /// \brief Lock the buffers into RAM. Free buffers are locked at once, new buffers when
+    /// they are allocated, so it should be enabled before the pipeline starts.
+    /// \return False if a buffer could not be locked, RLIMIT_MEMLOCK is probably too small.
+    bool setLocked(bool locked);
+
+    /// Counters of the pool, to verify that the hot path does not allocate
+    struct Statistics {
+        unsigned long long allocations = 0; ///< Buffers obtained from the system
+        unsigned long long recycled = 0;    ///< Buffers handed out again
+        unsigned long long hugePages = 0;   ///< Allocations backed by reserved hugepages
+        unsigned long long lockFailures = 0; ///< Buffers that could not be locked into RAM
+    };
+    Statistics statistics() const;
+
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+private:
+    FrameBufferPool() = default;
+
+    /// \return The size that is really allocated for a request.
+    static std::size_t roundSize(std::size_t bytes);
+    void* allocate(std::size_t size);
+    void deallocate(void* buffer, std::size_t size);
+    /// \return False if the buffer could not be locked.
+    static bool lockBuffer(void* buffer, std::size_t size, bool locked);
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::size_t, std::vector<void*>> _free; ///< Free buffers by rounded size
+    std::size_t _cachedBytes = 0; ///< The size of all free buffers
+    bool _hugePages = true;
+    std::atomic<bool> _locked{false};
+    Statistics _statistics;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief A std allocator that takes its memory from the FrameBufferPool.
+template<class T>
+struct FrameAllocator {
+    typedef T value_type;
+
+    FrameAllocator() = default;
+    template<class U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(FrameBufferPool::instance().acquire(n * sizeof(T)));
+    }
+    void deallocate(T* buffer, std::size_t n) {
+        FrameBufferPool::instance().release(buffer, n * sizeof(T));
+    }
+};
+
+template<class T, class U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+template<class T, class U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+/// The samples of one channel, in V
+typedef std::vector<double, FrameAllocator<double>> SampleBuffer;
+
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  mpscQueue.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief An unbounded lock-free queue with many producers and a single consumer.
+/// Producers never block each other or the consumer: push() is one atomic
+/// exchange and one store. Only one thread at a time may call pop().
+/// The value type has to be default constructible and movable.
+template<class T>
+class MPSCQueue {
+public:
+    MPSCQueue() : _head(&_stub), _tail(&_stub) {}
+
+    ~MPSCQueue() {
+        clear();
+        if(_tail != &_stub)
+            delete _tail;
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    /// \brief Append a value. Can be called by any thread.
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+        // Until this store the consumer sees the queue as ending at previous
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// \brief Remove the oldest value. Must only be called by the consumer thread.
+    /// \return false if the queue is empty or a producer is in the middle of a push().
+    bool pop(T& value) {
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if(!next)
+            return false;
+
+        // The node of the popped value becomes the new stub
+        value = std::move(next->value);
+        next->value = T();
+        _tail = next;
+        if(tail != &_stub)
+            delete tail;
+        return true;
+    }
+
+    /// \brief Drop all values. Must only be called by the consumer thread.
+    void clear() {
+        T value;
+        while(pop(value));
+    }
+
+private:
+    struct Node {
+        Node() : next(nullptr) {}
+        explicit Node(T&& v) : next(nullptr), value(std::move(v)) {}
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    std::atomic<Node*> _head;   ///< Last pushed node, producer side
+    Node* _tail;                ///< Last consumed node, consumer side
+    Node _stub;                 ///< Initial empty node
+};
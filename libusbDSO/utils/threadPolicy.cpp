@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  threadPolicy.cpp
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "threadPolicy.h"
+#include "frameBufferPool.h"
+
+namespace DSO {
+
+ThreadPolicies& ThreadPolicies::instance() {
+    // Never destroyed, threads may apply their policy while the process exits
+    static ThreadPolicies* policies = new ThreadPolicies();
+    return *policies;
+}
+
+void ThreadPolicies::setPolicy(ThreadRole role, const ThreadPolicy& policy) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _policies[(unsigned) role] = policy;
+    }
+    ++_generation;
+}
+
+ThreadPolicy ThreadPolicies::policy(ThreadRole role) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _policies[(unsigned) role];
+}
+
+AppliedThreadPolicy ThreadPolicies::apply(ThreadRole role) {
+    const ThreadPolicy policy = this->policy(role);
+    AppliedThreadPolicy applied;
+
+#if defined(__linux__)
+    // What this thread had before a policy changed it, the default policy leaves it untouched
+    thread_local bool scheduled = false;
+    thread_local bool pinned = false;
+    thread_local cpu_set_t originalCpus;
+
+    // Scheduling, lowering to the default is always permitted
+    int result = 0;
+    if(policy.scheduling != ThreadScheduling::DEFAULT || scheduled) {
+        int schedulingPolicy = SCHED_OTHER;
+        if(policy.scheduling == ThreadScheduling::FIFO)
+            schedulingPolicy = SCHED_FIFO;
+        else if(policy.scheduling == ThreadScheduling::ROUND_ROBIN)
+            schedulingPolicy = SCHED_RR;
+
+        sched_param parameter;
+        memset(&parameter, 0, sizeof(parameter));
+        if(schedulingPolicy != SCHED_OTHER)
+            parameter.sched_priority = std::min(std::max(policy.priority, sched_get_priority_min(schedulingPolicy)),
+                                                sched_get_priority_max(schedulingPolicy));
+        result = pthread_setschedparam(pthread_self(), schedulingPolicy, &parameter);
+        if(!result)
+            scheduled = schedulingPolicy != SCHED_OTHER;
+    }
+    applied.scheduling = result == 0;
+    if(result == EPERM)
+        applied.message += "Realtime scheduling is not permitted (CAP_SYS_NICE or RLIMIT_RTPRIO needed). ";
+    else if(result)
+        applied.message += std::string("Scheduling failed: ") + strerror(result) + ". ";
+
+    // Affinity, the kernel drops cpus that don't exist or are not allowed
+    result = 0;
+    if(!policy.cpus.empty()) {
+        if(!pinned)
+            result = pthread_getaffinity_np(pthread_self(), sizeof(originalCpus), &originalCpus);
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for(unsigned cpu: policy.cpus)
+            if(cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &cpus);
+        if(!result)
+            result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if(!result)
+            pinned = true;
+    } else if(pinned) {
+        result = pthread_setaffinity_np(pthread_self(), sizeof(originalCpus), &originalCpus);
+        if(!result)
+            pinned = false;
+    }
+    applied.affinity = result == 0;
+    if(result)
+        applied.message += std::string("Affinity failed: ") + strerror(result) + ". ";
+#else
+    if(policy.scheduling != ThreadScheduling::DEFAULT || !policy.cpus.empty())
+        applied.message = "Thread policies are not supported on this system. ";
+#endif
+
+    if(!applied.message.empty())
+        applied.message.pop_back(); // The separator
+    _policyApplied(role, applied);
+    return applied;
+}
+
+void ThreadPolicies::applyIfChanged(ThreadRole role, unsigned& generation) {
+    const unsigned current = _generation;
+    if(generation == current)
+        return;
+    generation = current;
+    apply(role);
+}
+
+bool ThreadPolicies::lockMemory(std::string& message) {
+    message.clear();
+#if defined(__linux__)
+    // With MCL_FUTURE every allocation fails once the limit is reached, so only lock
+    // all memory if the limit can't be reached
+    rlimit limit;
+    const bool unlimited = getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur == RLIM_INFINITY;
+    if(unlimited && mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+        return FrameBufferPool::instance().setLocked(true);
+    message = unlimited ? std::string("Locking all memory failed: ") + strerror(errno) + "."
+                        : "RLIMIT_MEMLOCK is limited, only the frame buffers are locked.";
+    if(FrameBufferPool::instance().setLocked(true))
+        return true;
+    message += " The frame buffers exceed RLIMIT_MEMLOCK.";
+    return false;
+#else
+    message = "Memory locking is not supported on this system.";
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  OpenHantek
+//  threadPolicy.h
+//
+//  Copyright (C) 2026  The OpenHantek contributors
+//
+//  This program is free software: you can redistribute it and/or modify it
+//  under the terms of the GNU General Public License as published by the Free
+//  Software Foundation, either version 3 of the License, or (at your option)
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful, but WITHOUT
+//  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//  more details.
+//
+//  You should have received a copy of the GNU General Public License along with
+//  this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace DSO {
+
+//////////////////////////////////////////////////////////////////////////////
+/// \enum ThreadRole
+/// \brief The groups of threads that get their own scheduling policy.
+enum class ThreadRole {
+    DEVICE,   ///< Device tasks, the usb reader and the libusb event thread
+    ANALYSER, ///< Analyser tasks
+    RENDER    ///< The render thread of the user interface
+};
+#define THREAD_ROLES 3
+
+//////////////////////////////////////////////////////////////////////////////
+/// \enum ThreadScheduling
+/// \brief The scheduling policies of a thread.
+enum class ThreadScheduling {
+    DEFAULT,    ///< The time sharing scheduler of the system
+    FIFO,       ///< Realtime, runs until it blocks (SCHED_FIFO)
+    ROUND_ROBIN ///< Realtime, time sliced between threads of the same priority (SCHED_RR)
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// \struct ThreadPolicy
+/// \brief The scheduling of the threads of a role.
+struct ThreadPolicy {
+    ThreadScheduling scheduling = ThreadScheduling::DEFAULT;
+    int priority = 0;           ///< The realtime priority, limited to the range of the system (usually 1-99)
+    std::vector<unsigned> cpus; ///< The cpus the threads may run on, all if empty
+};
+
+//////////////////////////////////////////////////////////////////////////////
+/// \struct AppliedThreadPolicy
+/// \brief What could really be applied to a thread.
+struct AppliedThreadPolicy {
+    bool scheduling = false; ///< The scheduling policy and priority are in effect
+    bool affinity = false;   ///< The cpu affinity is in effect
+    std::string message;     ///< The reasons for what was not applied, empty if all was applied
+};
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief The thread policies of the process.
+///
+/// Threads apply the policy of their role when they start and again after it
+/// was changed. Realtime scheduling needs CAP_SYS_NICE or a RLIMIT_RTPRIO, an
+/// unprivileged process keeps the default scheduling and reports why. Only
+/// Linux is supported, other systems keep their defaults.
+class ThreadPolicies {
+public:
+    /// \return The policies shared by all threads.
+    static ThreadPolicies& instance();
+
+    /// \brief Change the policy of a role. Running threads apply it before their next step.
+    void setPolicy(ThreadRole role, const ThreadPolicy& policy);
+    ThreadPolicy policy(ThreadRole role) const;
+
+    /// \brief Apply the policy of a role to the calling thread.
+    /// The default policy leaves the scheduling and affinity of the thread untouched,
+    /// unless an earlier policy changed them, then they are restored.
+    /// The result is also reported to _policyApplied.
+    AppliedThreadPolicy apply(ThreadRole role);
+
+    /// \brief Apply the policy of a role if it changed since the calling thread applied it.
+    /// Cheap enough to be called before every step of a thread.
+    /// \param generation The policies the thread applied last, initially 0. It is updated.
+    void applyIfChanged(ThreadRole role, unsigned& generation);
+
+    /// \brief Keep the memory of the process in RAM, so that the acquisition never waits
+    /// for a page fault. All memory is locked if RLIMIT_MEMLOCK allows it, otherwise
+    /// only the buffers of the FrameBufferPool. Call it before devices are connected.
+    /// \param message The reasons for what was not locked, empty if all memory is locked.
+    /// \return False if nothing could be locked.
+    bool lockMemory(std::string& message);
+
+    /// Called by every thread that applied a policy. Set it before threads are started.
+    std::function<void(ThreadRole, const AppliedThreadPolicy&)> _policyApplied =
+            [](ThreadRole, const AppliedThreadPolicy&){};
+
+    ThreadPolicies(const ThreadPolicies&) = delete;
+    ThreadPolicies& operator=(const ThreadPolicies&) = delete;
+
+private:
+    ThreadPolicies() = default;
+
+    mutable std::mutex _mutex;
+    std::array<ThreadPolicy, THREAD_ROLES> _policies;
+    std::atomic<unsigned> _generation{1}; ///< Incremented by every setPolicy()
+};
+
+}
@@ -1,17 +1,10 @@
 #include "utils/transferBuffer.h"
 
-/// \brief Initializes the data array.
+/// \brief Initializes the buffer with the array of the derived class.
+/// \param storage The zero initialized array.
 /// \param size Size of the data array.
-USBTransferBuffer::USBTransferBuffer(unsigned int size, unsigned char extra) : extra(extra) {
-        this->array = new unsigned char[size];
-        for(unsigned int index = 0; index < size; ++index)
-                this->array[index] = 0;
-        this->_size = size;
-}
-
-/// \brief Deletes the allocated data array.
-USBTransferBuffer::~USBTransferBuffer() {
-        delete[] this->array;
+USBTransferBuffer::USBTransferBuffer(unsigned char *storage, unsigned int size, unsigned char extra)
+    : extra(extra), array(storage), _size(size) {
 }
 
 /// \brief Returns a pointer to the array data.
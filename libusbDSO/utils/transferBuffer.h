@@ -1,15 +1,21 @@
 #pragma once
 
+#include <array>
+#include <stdint.h>
+
 class BulkUSB {};
 class ControlUSB {};
 
 //////////////////////////////////////////////////////////////////////////////
 ///
-/// \brief A simple array with a fixed size allocated on the heap
+/// \brief The bytes of a usb command. The storage is provided by the derived
+/// FixedTransferBuffer, so commands of different sizes can be queued and sent
+/// through this common base.
 class USBTransferBuffer {
 public:
-    USBTransferBuffer(unsigned int size, unsigned char extra = 0);
-    ~USBTransferBuffer();
+    /// The buffers are owned by their device, copies would share the array
+    USBTransferBuffer(const USBTransferBuffer&) = delete;
+    USBTransferBuffer& operator=(const USBTransferBuffer&) = delete;
 
     unsigned char *data();
     const unsigned char *data() const;
@@ -20,6 +26,98 @@ public:
     unsigned char extra;
 
 protected:
+    /// \param storage The array of the derived class, it lives as long as this object.
+    USBTransferBuffer(unsigned char *storage, unsigned int size, unsigned char extra = 0);
+
     unsigned char *array; ///< Pointer to the array holding the data
     unsigned int _size; ///< Size of the array (Number of variables of type T)
 };
+
+//////////////////////////////////////////////////////////////////////////////
+/// \struct BitField
+/// \brief Describes Width bits of a byte, starting at bit Shift (0 is the LSB).
+template<unsigned Shift, unsigned Width>
+struct BitField {
+    static_assert(Width > 0 && Shift + Width <= 8, "A bit field has to fit into one byte");
+    static constexpr unsigned shift = Shift;
+    static constexpr uint8_t mask = (uint8_t) (((1u << Width) - 1) << Shift);
+};
+
+/// The storage of a FixedTransferBuffer. It is a base class of its own, so that it is
+/// constructed before the USBTransferBuffer that points to it.
+template<unsigned Size>
+struct FixedTransferStorage {
+    std::array<unsigned char, Size> storage {};
+};
+
+//////////////////////////////////////////////////////////////////////////////
+///
+/// \brief A usb command of Size bytes, stored inside the object.
+/// The field accessors check at compile time that a field lies inside the command.
+template<unsigned Size>
+class FixedTransferBuffer : private FixedTransferStorage<Size>, public USBTransferBuffer {
+public:
+    /// The size of the command in bytes
+    static constexpr unsigned SIZE = Size;
+
+    explicit FixedTransferBuffer(unsigned char extra = 0)
+        : USBTransferBuffer(this->storage.data(), Size, extra) {}
+
+protected:
+    /// \return The byte at the given offset.
+    template<unsigned Offset>
+    uint8_t& byte() {
+        static_assert(Offset < Size, "Byte outside of the command");
+        return this->storage[Offset];
+    }
+    template<unsigned Offset>
+    uint8_t byte() const {
+        static_assert(Offset < Size, "Byte outside of the command");
+        return this->storage[Offset];
+    }
+
+    /// \return The bit field of the byte at the given offset.
+    template<unsigned Offset, class Field>
+    uint8_t bits() const {
+        return (byte<Offset>() & Field::mask) >> Field::shift;
+    }
+    /// \brief Set the bit field of the byte at the given offset, other bits are kept.
+    template<unsigned Offset, class Field>
+    void setBits(unsigned value) {
+        byte<Offset>() = (byte<Offset>() & ~Field::mask) | ((value << Field::shift) & Field::mask);
+    }
+
+    /// \return The little endian value of Bytes bytes at the given offset.
+    template<unsigned Offset, unsigned Bytes>
+    uint32_t littleEndian() const {
+        static_assert(Bytes > 0 && Bytes <= 4 && Offset + Bytes <= Size, "Value outside of the command");
+        uint32_t value = 0;
+        for(unsigned index = Bytes; index > 0; --index)
+            value = (value << 8) | this->storage[Offset + index - 1];
+        return value;
+    }
+    /// \brief Set the little endian value of Bytes bytes at the given offset.
+    template<unsigned Offset, unsigned Bytes>
+    void setLittleEndian(uint32_t value) {
+        static_assert(Bytes > 0 && Bytes <= 4 && Offset + Bytes <= Size, "Value outside of the command");
+        for(unsigned index = 0; index < Bytes; ++index, value >>= 8)
+            this->storage[Offset + index] = (uint8_t) value;
+    }
+
+    /// \return The big endian value of Bytes bytes at the given offset.
+    template<unsigned Offset, unsigned Bytes>
+    uint32_t bigEndian() const {
+        static_assert(Bytes > 0 && Bytes <= 4 && Offset + Bytes <= Size, "Value outside of the command");
+        uint32_t value = 0;
+        for(unsigned index = 0; index < Bytes; ++index)
+            value = (value << 8) | this->storage[Offset + index];
+        return value;
+    }
+    /// \brief Set the big endian value of Bytes bytes at the given offset.
+    template<unsigned Offset, unsigned Bytes>
+    void setBigEndian(uint32_t value) {
+        static_assert(Bytes > 0 && Bytes <= 4 && Offset + Bytes <= Size, "Value outside of the command");
+        for(unsigned index = Bytes; index > 0; --index, value >>= 8)
+            this->storage[Offset + index - 1] = (uint8_t) value;
+    }
+};
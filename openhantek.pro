@@ -6,4 +6,5 @@ SUBDIRS = \
     libOpenHantek2xxx-5xxx \
     libPostprocessingDSO \
     libusbDSO \
+    benchmark \
     openhantek2
@@ -41,7 +41,7 @@ SOURCES += \
 
 
 LIBS += -L../libDemoDevice -L../libOpenHantek2xxx-5xxx -L../libOpenHantek60xx -L../libPostprocessingDSO -L../libusbDSO \
-        -lDemoDevice -lOpenHantek2xxx-5xxx -lOpenHantek60xx -lPostprocessingDSO -lusbDSO -lusb-1.0 -lfftw3
+        -lDemoDevice -lOpenHantek2xxx-5xxx -lOpenHantek60xx -lPostprocessingDSO -lusbDSO -lusb-1.0 -lfftw3f -lfftw3
 RESOURCES += ui/qml.qrc
 
 INCLUDEPATH += . .. ../libusbDSO ../libPostprocessingDSO
@@ -43,9 +43,8 @@ void QPCurve::setColor(const QColor &arg)
 
 void QPCurve::setData(const QVector<float> &data)
 {
-    m_data.clear();
-
     if (data.isEmpty()) {
+        m_data.clear();
         return;
     }
 
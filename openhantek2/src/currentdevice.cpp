@@ -1,12 +1,14 @@
 #include "currentdevice.h"
 #include "deviceList.h"
 #include "dataAnalyzer.h"
+#include "compositeDevice.h"
 
 #include "libDemoDevice/sineWaveDevice.h"
 #include "plot/qpscrollingcurve.h"
 #include "plot/qpcurve.h"
 #include "plot/qpfixedscaleengine.h"
 #include <iostream>
+#include <algorithm>
 
 #include <QCoreApplication>
 
@@ -49,6 +51,7 @@ void CurrentDevice::setDevice(std::shared_ptr<DSO::DeviceBase> deviceBase)
         }
 
         m_device->setChannelUsed(0, true);
+        m_device->startSampling();
         emit curvesChanged();
     };
     m_device->connectDevice();
@@ -66,6 +69,14 @@ void CurrentDevice::setDemoDevice()
     setDevice(std::shared_ptr<DSO::DeviceBase>(new DemoDevices::SineWaveDevice()));
 }
 
+void CurrentDevice::setCompositeDemoDevice(unsigned count)
+{
+    std::vector<std::shared_ptr<DSO::DeviceBase>> devices;
+    for (unsigned index = 0; index < count; ++index)
+        devices.push_back(std::shared_ptr<DSO::DeviceBase>(new DemoDevices::SineWaveDevice()));
+    setDevice(std::shared_ptr<DSO::DeviceBase>(new DSO::CompositeDevice(devices)));
+}
+
 void CurrentDevice::resetDevice()
 {
     emit channelsChanged(0);
@@ -92,6 +103,7 @@ void CurrentDevice::updateCurves()
 {
     if (!m_analyser) return;
     using namespace std;
+    std::lock_guard<std::mutex> lock(m_analyser->mutex());
     // Check if the sample count has changed
     unsigned int sampleCount = m_analyser->sampleCount();
 /*    if (m_xScaleEngine->max() != sampleCount/2) {
@@ -118,7 +130,7 @@ void CurrentDevice::updateCurves()
         // What's the horizontal distance between sampling points?
         double horizontalFactor = sampleValues.interval / m_scopeViewSettings.timebase;
 
-        std::vector<double>::const_iterator dataIterator = sampleValues.sample.begin();
+        DSO::SampleBuffer::const_iterator dataIterator = sampleValues.sample.begin();
         //        const double gain = m_analyserSettings.voltage[channel].gain;
         //        const double offset = m_analyserSettings.voltage[channel].offset;
 
@@ -131,13 +143,14 @@ void CurrentDevice::updateCurves()
             //            *(dataIterator) = *(dataIterator++) / gain + offset;             //Y
             //            std::for_each (dataIterator.begin(),dataIterator.end(), [](double& d) { d=d/gain + offset;});
         }
-        std::vector<float> fsamples(sampleValues.sample.begin(),sampleValues.sample.end());
-        QVector<float> qsamples = QVector<float>::fromStdVector(fsamples);
+        // Convert in place, the buffer keeps its capacity from frame to frame
+        m_curveSamples.resize(sampleValues.sample.size());
+        std::copy(sampleValues.sample.begin(), sampleValues.sample.end(), m_curveSamples.begin());
 
         //        curve->setData(sampleValues.sample);
-        curve->setData(qsamples);
+        curve->setData(m_curveSamples);
     }
-    m_analyser->mutex().unlock();
+    m_analyser->releaseData();
 }
 
 QQmlListProperty<QPCurve> CurrentDevice::curves()
@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QQmlListProperty>
 #include <QList>
+#include <QVector>
 #include <QTimer>
 
 #include <memory>
@@ -61,6 +62,8 @@ public slots:
     void setDevice(unsigned uid);
     // Set a demo device as current device
     void setDemoDevice();
+    // Set several demo devices, merged into one scope, as current device
+    void setCompositeDemoDevice(unsigned count);
     void resetDevice();
 
 private:
@@ -72,6 +75,8 @@ private:
     DSO::DeviceList* m_deviceList;
     // A list of the plot curves
     QList<QPCurve*> m_curves;
+    // Conversion buffer for the curves, reused for every frame
+    QVector<float> m_curveSamples;
     // The scale engines
     std::unique_ptr<QPScaleEngine> m_yScaleEngine;
     std::unique_ptr<QPScaleEngine> m_xScaleEngine;
@@ -2,17 +2,22 @@
 #include "deviceBase.h"
 #include "deviceList.h"
 
-#include <QTimer>
 #include <QDebug>
+#include <algorithm>
 using namespace DSO;
 
-DeviceModel::DeviceModel(const DSO::DeviceList* deviceList) : m_deviceList(deviceList)
+DeviceModel::DeviceModel(DSO::DeviceList* deviceList) : m_deviceList(deviceList)
 {
-    QTimer* hotplugTimer = new QTimer(this);
-    hotplugTimer->setInterval(2000);
-    hotplugTimer->setSingleShot(false);
-    connect(hotplugTimer, &QTimer::timeout, [deviceList]() {deviceList->checkForDevices();});
-    hotplugTimer->start();
+    connect(this, &DeviceModel::uploadProgressFromDevice, this, &DeviceModel::updateUploadProgress, Qt::QueuedConnection);
+}
+
+DeviceModel::~DeviceModel()
+{
+    if (!m_uploadDevice)
+        return;
+    // Stops the device task that uploads the firmware, it calls this object
+    m_uploadDevice->disconnectDevice();
+    m_uploadDevice->_uploadProgress = [](int){return true;};
 }
 
 int DeviceModel::rowCount(const QModelIndex & parent) const {
@@ -42,15 +47,47 @@ const QStringList DeviceModel::supportedDevices() const
 
 int DeviceModel::uploadFirmware(unsigned uid)
 {
-    DSO::DeviceBase* device = const_cast<DSO::DeviceList*>(m_deviceList)->getDeviceByUID(uid).get();
-    if (device)
-        return (int)device->uploadFirmware();
+    std::shared_ptr<DSO::DeviceBase> device = m_deviceList->getDeviceByUID(uid);
+    if (!device || m_uploadDevice)
+        return (int)ErrorCode::ERROR_UNSUPPORTED;
 
-    return (int)ErrorCode::ERROR_UNSUPPORTED;
+    // Called by the device task
+    device->_uploadProgress = [this](int progress) {
+        emit uploadProgressFromDevice(progress);
+        return true;
+    };
+    ErrorCode errorCode = device->uploadFirmware();
+    if (errorCode == ErrorCode::ERROR_NONE && device->needFirmware()) {
+        m_uploadDevice = device;
+        m_uploadProgress = 0;
+        emit uploadProgressChanged();
+    }
+    return (int)errorCode;
+}
+
+void DeviceModel::updateUploadProgress(int progress)
+{
+    if (!m_uploadDevice)
+        return;
+    // The device reenumerates after a successful upload and is replaced in the list
+    if (progress < 0 || progress >= 100)
+        m_uploadDevice.reset();
+    else
+        m_uploadProgress = progress;
+    emit uploadProgressChanged();
+    if (progress < 0)
+        emit uploadFailed(progress);
 }
 
 void DeviceModel::update()
 {
+    m_deviceList->releaseRemovedDevices();
+    // A device that has been unplugged or has reenumerated does not report anymore
+    const std::vector<std::shared_ptr<DSO::DeviceBase>> devices = m_deviceList->getList();
+    if (m_uploadDevice && std::find(devices.begin(), devices.end(), m_uploadDevice) == devices.end()) {
+        m_uploadDevice.reset();
+        emit uploadProgressChanged();
+    }
     beginResetModel();
     endResetModel();
     emit countChanged();
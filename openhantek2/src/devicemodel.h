@@ -13,13 +13,17 @@ class DeviceModel : public QAbstractListModel
     Q_OBJECT
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
     Q_PROPERTY(QStringList supportedDevices READ supportedDevices NOTIFY supportedDevicesChanged)
+    Q_PROPERTY(bool uploading READ uploading NOTIFY uploadProgressChanged)
+    Q_PROPERTY(int uploadProgress READ uploadProgress NOTIFY uploadProgressChanged)
 public:
     enum DeviceRoles {
         NameRole = Qt::UserRole + 1,
         NeedFirmware,
         UIDRole
     };
-    DeviceModel(const DSO::DeviceList* deviceList);
+    DeviceModel(DSO::DeviceList* deviceList);
+    /// Aborts a running firmware upload.
+    ~DeviceModel();
 
     /// Part of the model. Return the size of the model.
     int rowCount(const QModelIndex & parent = QModelIndex()) const override;
@@ -32,13 +36,24 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     /// This is called by {@see DSO::DeviceList} if devices have been plugin in or out.
-    void update();
+    /// The device list calls it from its event thread, it has to be queued to the gui thread.
+    /// Removed devices are destroyed here, on the gui thread.
+    Q_INVOKABLE void update();
 
     /// Return a list of all supported device models.
     const QStringList supportedDevices() const;
 
+    /// Start the firmware upload of a device. The progress is reported by uploadProgress,
+    /// a failure by uploadFailed(). Only one upload runs at a time.
+    /// \return An ErrorCode if the upload could not be started.
     Q_INVOKABLE int uploadFirmware(unsigned uid);
 
+    /// Return true while a firmware upload is running.
+    bool uploading() const { return m_uploadDevice != nullptr; }
+
+    /// Return the progress of the running firmware upload in percent.
+    int uploadProgress() const { return m_uploadProgress; }
+
     /// This is called by {@see DSO::DeviceList} if more device models have been registered
     /// to it or models have been removed and supportedDevices() would return another
     /// result now.
@@ -46,7 +61,18 @@ public:
 signals:
     void countChanged();
     void supportedDevicesChanged();
+    void uploadProgressChanged();
+    /// The firmware upload failed with the ErrorCode errorCode.
+    void uploadFailed(int errorCode);
+    /// Emitted by the device task, queued to updateUploadProgress().
+    void uploadProgressFromDevice(int progress);
+
+private slots:
+    void updateUploadProgress(int progress);
 
 private:
-    const DSO::DeviceList* m_deviceList;
+    DSO::DeviceList* m_deviceList;
+    // The device with a running firmware upload
+    std::shared_ptr<DSO::DeviceBase> m_uploadDevice;
+    int m_uploadProgress = 0;
 };
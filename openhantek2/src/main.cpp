@@ -21,13 +21,56 @@
 #include <QQuickItem>
 #include <QQmlContext>
 #include <QDebug>
+#include <QSettings>
+#include "utils/threadPolicy.h"
 #define VERSION "0.0"
 
+/// Read the thread policies from the settings, group "threads" with a subgroup per role:
+/// scheduling ("default", "fifo" or "rr"), priority and cpus (a list of cpu numbers).
+/// lockMemory keeps the process in RAM. What could not be applied is logged.
+static void readThreadPolicies()
+{
+    static const char* const roleNames[THREAD_ROLES] = {"device", "analyser", "render"};
+    DSO::ThreadPolicies& policies = DSO::ThreadPolicies::instance();
+    policies._policyApplied = [](DSO::ThreadRole role, const DSO::AppliedThreadPolicy& applied) {
+        if (!applied.message.empty())
+            qWarning() << "Thread policy" << roleNames[(unsigned) role] << ":" << applied.message.c_str();
+    };
+
+    QSettings s;
+    s.beginGroup("threads");
+    for (unsigned role = 0; role < THREAD_ROLES; ++role) {
+        s.beginGroup(roleNames[role]);
+        DSO::ThreadPolicy policy;
+        const QString scheduling = s.value("scheduling", "default").toString();
+        if (scheduling == "fifo")
+            policy.scheduling = DSO::ThreadScheduling::FIFO;
+        else if (scheduling == "rr")
+            policy.scheduling = DSO::ThreadScheduling::ROUND_ROBIN;
+        policy.priority = s.value("priority", 0).toInt();
+        for (const QString& cpu: s.value("cpus").toStringList())
+            policy.cpus.push_back(cpu.toUInt());
+        policies.setPolicy((DSO::ThreadRole) role, policy);
+        s.endGroup();
+    }
+
+    if (s.value("lockMemory", false).toBool()) {
+        std::string message;
+        policies.lockMemory(message);
+        if (!message.empty())
+            qWarning() << "Memory locking:" << message.c_str();
+    }
+    s.endGroup();
+}
+
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
     app.setApplicationVersion(VERSION);
 
+    // Before any device or analyser thread is started
+    readThreadPolicies();
+
     // Create engine
     QQmlApplicationEngine* engine = new QQmlApplicationEngine;
     engine->addImportPath(":/QuickPlot");
@@ -64,8 +107,9 @@ int main(int argc, char *argv[])
 
     // Connect deviceList with model, register all known usb identifiers
 
+    // Called by the libusb event thread of the device list
     deviceList._listChanged = [&deviceModel]() {
-        deviceModel.update();
+        QMetaObject::invokeMethod(&deviceModel, "update", Qt::QueuedConnection);
     };
     deviceList._modelsChanged = [&deviceModel]() {
         deviceModel.updateSupportedDevices();
@@ -82,7 +126,18 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // Emitted by the render thread, it applies its policy before the first and after every change
+    QQuickWindow* window = qobject_cast<QQuickWindow*>(engine->rootObjects().first());
+    if (window)
+        QObject::connect(window, &QQuickWindow::beforeRendering, []() {
+            static unsigned policyGeneration = 0;
+            DSO::ThreadPolicies::instance().applyIfChanged(DSO::ThreadRole::RENDER, policyGeneration);
+        }, Qt::DirectConnection);
+
     int r = app.exec();
+    // No list changes after the model is gone. The event thread keeps running until the
+    // devices are destroyed, it completes their cancelled transfers.
+    deviceList.setAutoUpdate(false);
     delete engine;
     return r;
 }
@@ -114,6 +114,15 @@ struct AnalyserSettings : public DSOAnalyser::AnalyserSettings {
         spectrumWindow = d.spectrumWindow;
         spectrumReference = d.spectrumReference;
         spectrumLimit = d.spectrumLimit;
+        spectrumPrecision = d.spectrumPrecision;
+        spectrumZeroPadding = d.spectrumZeroPadding;
+        spectrumGateEnabled = d.spectrumGateEnabled;
+        spectrumGateStart = d.spectrumGateStart;
+        spectrumGateEnd = d.spectrumGateEnd;
+        phaseEnabled = d.phaseEnabled;
+        phaseReference = d.phaseReference;
+        harmonicsEnabled = d.harmonicsEnabled;
+        harmonicsCount = d.harmonicsCount;
     }
     //Q_ENUMS(DSOAnalyser::MathMode)
     //Q_ENUMS(DSOAnalyser::WindowFunction)
@@ -123,6 +132,15 @@ struct AnalyserSettings : public DSOAnalyser::AnalyserSettings {
     Q_PROPERTY(DSOAnalyser::WindowFunction spectrumWindow MEMBER spectrumWindow)
     Q_PROPERTY(double spectrumReference MEMBER spectrumReference)
     Q_PROPERTY(double spectrumLimit MEMBER spectrumLimit)
+    Q_PROPERTY(DSOAnalyser::SpectrumPrecision spectrumPrecision MEMBER spectrumPrecision)
+    Q_PROPERTY(unsigned spectrumZeroPadding MEMBER spectrumZeroPadding)
+    Q_PROPERTY(bool spectrumGateEnabled MEMBER spectrumGateEnabled)
+    Q_PROPERTY(double spectrumGateStart MEMBER spectrumGateStart)
+    Q_PROPERTY(double spectrumGateEnd MEMBER spectrumGateEnd)
+    Q_PROPERTY(bool phaseEnabled MEMBER phaseEnabled)
+    Q_PROPERTY(unsigned phaseReference MEMBER phaseReference)
+    Q_PROPERTY(bool harmonicsEnabled MEMBER harmonicsEnabled)
+    Q_PROPERTY(unsigned harmonicsCount MEMBER harmonicsCount)
 };
 
 #include <QString>
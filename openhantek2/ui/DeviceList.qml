@@ -39,7 +39,7 @@ Item {
             id: devices
             anchors.margins: 5
             anchors.top: connected_devices.bottom
-            anchors.bottom: parent.bottom
+            anchors.bottom: deviceModel.uploading ? uploadProgressBar.top : parent.bottom
             anchors.left: parent.left
             anchors.right: parent.right
             model: deviceModel
@@ -59,6 +59,7 @@ Item {
                     width: devices.width
                     text: model.name
                     Layout.fillWidth: true
+                    enabled: !deviceModel.uploading
                     onClicked: {
                         // Either upload firmware
                         if (model.needFirmware)
@@ -92,6 +93,19 @@ Item {
                 } // end button
             } // end delegate
         }
+
+        // The progress of a running firmware upload
+        ProgressBar {
+            id: uploadProgressBar
+            visible: deviceModel.uploading
+            anchors.margins: 5
+            anchors.bottom: parent.bottom
+            anchors.left: parent.left
+            anchors.right: parent.right
+            minimumValue: 0
+            maximumValue: 100
+            value: deviceModel.uploadProgress
+        }
     }
 
     // No device found. Contains a label and a listview with supported models.
@@ -192,6 +206,11 @@ Item {
         }
     }
 
+    Connections {
+        target: deviceModel
+        onUploadFailed: uploadFirmwareFailedDialog.show(errorCode)
+    }
+
     ErrorStrings {
         id: errorStrings
     }